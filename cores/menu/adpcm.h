@@ -0,0 +1,35 @@
+/*
+ * adpcm.h - MS ADPCM and IMA ADPCM block decoding into an audio_ring
+ *
+ * Shared by the music player (WAV, raw .adp) and the video player (AVI
+ * audio). A block is decoded in one pass with the predictor state of each
+ * channel held in locals, two nibbles per input byte, and written as
+ * interleaved stereo frames straight into the ring's write span (mono is
+ * duplicated to both sides).
+ *
+ * Both encodings reset their predictor at every block, so there is no state
+ * to carry between calls or to clear on seek.
+ */
+
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stdint.h>
+#include "audio_ring.h"
+
+#define ADPCM_MS  0     /* WAVE_FORMAT_ADPCM (0x0002) */
+#define ADPCM_IMA 1     /* WAVE_FORMAT_IMA_ADPCM (0x0011) */
+
+/* Encoding for a WAVE format tag, -1 if it isn't ADPCM */
+int adpcm_kind_from_tag(int format_tag);
+
+/* Frames in a full block, for when the fmt chunk doesn't say */
+int adpcm_block_frames(int kind, int block_align, int channels);
+
+/* Decode one block of size bytes (1 or 2 channels) into ring. The ring
+ * should have room for the whole block; frames that don't fit are dropped.
+ * Returns the frames written. */
+uint32_t adpcm_decode_block(int kind, const uint8_t *src, int size, int channels,
+                            audio_ring_t *ring);
+
+#endif /* ADPCM_H */
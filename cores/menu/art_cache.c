@@ -0,0 +1,114 @@
+/*
+ * art_cache.c - Decoded artwork for recently shown games
+ *
+ * See art_cache.h.
+ */
+
+#include "art_cache.h"
+#include <string.h>
+
+#define ART_CACHE_MAX_SLOTS 32
+#define ART_CACHE_MAX_PATH  512
+
+typedef struct {
+    uint32_t hash;
+    int kind;               /* -1 = free */
+    int width;
+    int height;
+    uint32_t last_used;
+    char path[ART_CACHE_MAX_PATH];
+} art_slot_t;
+
+static uint16_t art_arena[ART_CACHE_BYTES / sizeof(uint16_t)];
+static art_slot_t art_slots[ART_CACHE_MAX_SLOTS];
+static int art_slot_count = 0;
+static uint32_t art_slot_pixels = 0;
+static uint32_t art_clock = 0;
+static int art_shown = -1;  /* slot on screen, never evicted */
+
+/* FNV-1a */
+static uint32_t art_hash(int kind, const char *path) {
+    uint32_t h = 2166136261u ^ (uint32_t)kind;
+    while (*path) {
+        h ^= (uint8_t)*path++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int art_find(int kind, const char *path) {
+    uint32_t hash = art_hash(kind, path);
+    for (int i = 0; i < art_slot_count; i++) {
+        if (art_slots[i].kind == kind && art_slots[i].hash == hash &&
+            strcmp(art_slots[i].path, path) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void art_cache_clear(void) {
+    for (int i = 0; i < ART_CACHE_MAX_SLOTS; i++) art_slots[i].kind = -1;
+    art_shown = -1;
+}
+
+void art_cache_drop(int kind, const char *path) {
+    int i = art_find(kind, path);
+    if (i < 0) return;
+    art_slots[i].kind = -1;
+    if (i == art_shown) art_shown = -1;
+}
+
+int art_cache_set_slot_pixels(uint32_t pixels) {
+    if (pixels == art_slot_pixels) return 0;
+
+    art_slot_pixels = pixels;
+    art_slot_count = pixels ? (int)(sizeof(art_arena) / sizeof(uint16_t) / pixels) : 0;
+    if (art_slot_count > ART_CACHE_MAX_SLOTS) art_slot_count = ART_CACHE_MAX_SLOTS;
+    art_cache_clear();
+    return 1;
+}
+
+int art_cache_get(int kind, const char *path, uint16_t **data, int *width, int *height) {
+    int i = art_find(kind, path);
+    if (i < 0) return 0;
+
+    art_slots[i].last_used = ++art_clock;
+    art_shown = i;
+    *data = art_arena + (uint32_t)i * art_slot_pixels;
+    *width = art_slots[i].width;
+    *height = art_slots[i].height;
+    return 1;
+}
+
+int art_cache_has(int kind, const char *path) {
+    return art_find(kind, path) >= 0;
+}
+
+uint16_t *art_cache_put(int kind, const char *path, int width, int height) {
+    if (width <= 0 || height <= 0 || (uint32_t)(width * height) > art_slot_pixels) return NULL;
+    if (strlen(path) >= ART_CACHE_MAX_PATH) return NULL;
+
+    /* Same key again, a free slot, or the least recently used one */
+    int slot = art_find(kind, path);
+    for (int i = 0; slot < 0 && i < art_slot_count; i++) {
+        if (art_slots[i].kind < 0) slot = i;
+    }
+    if (slot < 0) {
+        for (int i = 0; i < art_slot_count; i++) {
+            if (i == art_shown) continue;
+            if (slot < 0 || art_slots[i].last_used < art_slots[slot].last_used) slot = i;
+        }
+    }
+    if (slot < 0) return NULL;
+    if (slot == art_shown) art_shown = -1;
+
+    art_slot_t *s = &art_slots[slot];
+    s->kind = kind;
+    s->hash = art_hash(kind, path);
+    s->width = width;
+    s->height = height;
+    s->last_used = ++art_clock;
+    strcpy(s->path, path);
+    return art_arena + (uint32_t)slot * art_slot_pixels;
+}
@@ -0,0 +1,46 @@
+/*
+ * art_cache.h - Decoded artwork for recently shown games
+ *
+ * Thumbnails and screenshots are kept decoded and already scaled to their
+ * on-screen size, so scrolling back to a game shows its artwork without
+ * decoding the PNG/JPEG/WebP again, and artwork for the rows around the
+ * selection can be decoded ahead of time.
+ *
+ * Memory is one fixed arena of ART_CACHE_BYTES split into equal slots,
+ * each big enough for the largest image of the kind on screen (see
+ * art_cache_set_slot_pixels). Slots are reused least recently used first,
+ * except the one art_cache_get() last returned, which is on screen.
+ */
+
+#ifndef ART_CACHE_H
+#define ART_CACHE_H
+
+#include <stdint.h>
+
+#define ART_CACHE_BYTES (1536 * 1024)
+
+#define ART_THUMBNAIL  0
+#define ART_SCREENSHOT 1
+
+/* Size every slot for images of up to pixels. If that changes the slot
+ * size, everything cached is dropped and 1 is returned. */
+int art_cache_set_slot_pixels(uint32_t pixels);
+
+/* Image cached for kind and path. On a hit it becomes the most recently
+ * used and is kept until the next get, and 1 is returned. */
+int art_cache_get(int kind, const char *path, uint16_t **data, int *width, int *height);
+
+/* 1 if kind and path are cached (without touching the LRU order) */
+int art_cache_has(int kind, const char *path);
+
+/* Slot for a width x height image of kind and path, to be filled before the
+ * next call. NULL if the image doesn't fit in a slot. */
+uint16_t *art_cache_put(int kind, const char *path, int width, int height);
+
+/* Drop the image of kind and path, e.g. a slot that couldn't be filled */
+void art_cache_drop(int kind, const char *path);
+
+/* Drop everything (the files may have changed) */
+void art_cache_clear(void);
+
+#endif /* ART_CACHE_H */
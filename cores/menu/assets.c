@@ -0,0 +1,161 @@
+/*
+ * assets.c - Where a game's thumbnail and screenshot are
+ *
+ * See assets.h.
+ */
+
+#include "assets.h"
+#include "name_index.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef SF2000
+#include "../../stockfw.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+#define ASSET_DIRS     4
+#define ASSET_MAX_PATH 512
+
+/* Extensions in the order they used to be tried; the index is the rank */
+static const char *const res_thumb_exts[] = { ".rgb565", ".png", ".jpg", ".webp", ".bmp", ".gif", NULL };
+static const char *const rom_thumb_exts[] = { ".webp", ".png", ".jpg", ".bmp", ".gif", NULL };
+static const char *const shot_exts[] = { ".png", ".jpg", ".jpeg", ".bmp", ".gif", ".webp", NULL };
+
+typedef struct {
+    char dir[ASSET_MAX_PATH];   /* "" = free slot */
+    name_index_t res_thumbs;    /* images in dir/.res/ */
+    name_index_t rom_thumbs;    /* images in dir usable as thumbnails */
+    name_index_t shots;         /* images in dir usable as screenshots */
+    uint32_t last_used;
+} asset_dir_t;
+
+static asset_dir_t asset_dirs[ASSET_DIRS];
+static uint32_t asset_clock = 0;
+
+asset_format_t asset_format_of(const char *file_name) {
+    const char *ext = strrchr(file_name, '.');
+    if (!ext) return ASSET_NONE;
+    if (strcasecmp(ext, ".rgb565") == 0) return ASSET_RGB565;
+    if (strcasecmp(ext, ".png") == 0) return ASSET_PNG;
+    if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) return ASSET_JPEG;
+    if (strcasecmp(ext, ".webp") == 0) return ASSET_WEBP;
+    if (strcasecmp(ext, ".bmp") == 0) return ASSET_BMP;
+    if (strcasecmp(ext, ".gif") == 0) return ASSET_GIF;
+    return ASSET_NONE;
+}
+
+/* Position of name's extension in exts, or -1 */
+static int ext_rank(const char *name, const char *const *exts) {
+    const char *ext = strrchr(name, '.');
+    if (!ext) return -1;
+    for (int i = 0; exts[i]; i++) {
+        if (strcasecmp(ext, exts[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static void asset_list(const char *dir, name_index_t *ni, const char *const *exts,
+                       name_index_t *ni2, const char *const *exts2) {
+    DIR *d = opendir(dir);
+    if (!d) return;
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        int rank = ext_rank(ent->d_name, exts);
+        if (rank >= 0) name_index_add_ranked(ni, ent->d_name, rank);
+        if (ni2) {
+            rank = ext_rank(ent->d_name, exts2);
+            if (rank >= 0) name_index_add_ranked(ni2, ent->d_name, rank);
+        }
+    }
+    closedir(d);
+}
+
+/* The remembered listing of dir, listing it now if needed */
+static asset_dir_t *asset_dir(const char *dir) {
+    asset_dir_t *slot = &asset_dirs[0];
+
+    for (int i = 0; i < ASSET_DIRS; i++) {
+        asset_dir_t *a = &asset_dirs[i];
+        if (a->dir[0] && strcmp(a->dir, dir) == 0) {
+            a->last_used = ++asset_clock;
+            return a;
+        }
+        /* Otherwise reuse a free slot, or the least recently used one */
+        if (slot->dir[0] && (!a->dir[0] || a->last_used < slot->last_used)) slot = a;
+    }
+
+    name_index_clear(&slot->res_thumbs);
+    name_index_clear(&slot->rom_thumbs);
+    name_index_clear(&slot->shots);
+    strncpy(slot->dir, dir, sizeof(slot->dir) - 1);
+    slot->dir[sizeof(slot->dir) - 1] = '\0';
+    slot->last_used = ++asset_clock;
+
+    char res[ASSET_MAX_PATH];
+    snprintf(res, sizeof(res), "%s/.res", dir);
+    asset_list(res, &slot->res_thumbs, res_thumb_exts, NULL, NULL);
+    asset_list(dir, &slot->rom_thumbs, rom_thumb_exts, &slot->shots, shot_exts);
+    return slot;
+}
+
+/* Folder and file name of game_path. Returns NULL if it has no folder. */
+static asset_dir_t *asset_dir_of(const char *game_path, const char **file_name) {
+    char dir[ASSET_MAX_PATH];
+
+    if (!game_path) return NULL;
+    const char *slash = strrchr(game_path, '/');
+    if (!slash || slash == game_path || slash[1] == '\0') return NULL;
+    size_t len = slash - game_path;
+    if (len >= sizeof(dir)) return NULL;
+
+    memcpy(dir, game_path, len);
+    dir[len] = '\0';
+    *file_name = slash + 1;
+    return asset_dir(dir);
+}
+
+asset_format_t asset_find_thumbnail(const char *game_path, char *out, int out_size) {
+    const char *file_name;
+    asset_dir_t *a = asset_dir_of(game_path, &file_name);
+    if (!a) return ASSET_NONE;
+
+    const char *found = name_index_find(&a->res_thumbs, file_name);
+    if (found) {
+        snprintf(out, out_size, "%s/.res/%s", a->dir, found);
+        return asset_format_of(found);
+    }
+    found = name_index_find(&a->rom_thumbs, file_name);
+    if (found) {
+        snprintf(out, out_size, "%s/%s", a->dir, found);
+        return asset_format_of(found);
+    }
+    return ASSET_NONE;
+}
+
+asset_format_t asset_find_screenshot(const char *game_path, char *out, int out_size) {
+    const char *file_name;
+    asset_dir_t *a = asset_dir_of(game_path, &file_name);
+    if (!a) return ASSET_NONE;
+
+    const char *found = name_index_find(&a->shots, file_name);
+    if (found) {
+        snprintf(out, out_size, "%s/%s", a->dir, found);
+        return asset_format_of(found);
+    }
+    return ASSET_NONE;
+}
+
+void asset_forget(void) {
+    for (int i = 0; i < ASSET_DIRS; i++) {
+        name_index_free(&asset_dirs[i].res_thumbs);
+        name_index_free(&asset_dirs[i].rom_thumbs);
+        name_index_free(&asset_dirs[i].shots);
+        asset_dirs[i].dir[0] = '\0';
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * assets.h - Where a game's thumbnail and screenshot are
+ *
+ * Finding artwork by trying candidate paths costs one failed fopen per
+ * miss, and on FAT over SD a thumbnail could take up to eleven of them
+ * (.rgb565 and five image formats in .res/, then five beside the ROM).
+ * The resolver instead lists a folder and its .res/ once, remembers which
+ * images exist, and answers with the exact path and format, so loading
+ * artwork is at most one real open.
+ *
+ * The last few folders asked about are kept. asset_forget() drops them,
+ * for when the files may have changed.
+ */
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+typedef enum {
+    ASSET_NONE = 0,
+    ASSET_RGB565,
+    ASSET_PNG,
+    ASSET_JPEG,
+    ASSET_WEBP,
+    ASSET_BMP,
+    ASSET_GIF
+} asset_format_t;
+
+/* Format from a file name's extension, ASSET_NONE if not an image */
+asset_format_t asset_format_of(const char *file_name);
+
+/* Thumbnail of the game at game_path, same order as always: .res/ first
+ * (.rgb565, .png, .jpg, .webp, .bmp, .gif), then beside the ROM (.webp,
+ * .png, .jpg, .bmp, .gif). Writes the path to out and returns its format,
+ * or ASSET_NONE. */
+asset_format_t asset_find_thumbnail(const char *game_path, char *out, int out_size);
+
+/* Screenshot beside the ROM (.png, .jpg, .jpeg, .bmp, .gif, .webp) */
+asset_format_t asset_find_screenshot(const char *game_path, char *out, int out_size);
+
+/* Drop all remembered folders */
+void asset_forget(void);
+
+#endif /* ASSETS_H */
@@ -0,0 +1,213 @@
+/*
+ * audio_resample.c - Fixed-point sample rate conversion out of an audio_ring
+ *
+ * See audio_resample.h.
+ */
+
+#include "audio_resample.h"
+
+#define AUDIO_RESAMPLE_ONE 0x10000u
+#define AUDIO_RESAMPLE_MAX_RUN 0x8000u  /* frames, so run positions fit 16.16 */
+
+/* Frame i of a read span */
+static inline const int16_t *audio_resample_frame(const audio_ring_span_t *s, uint32_t i) {
+    return (i < s->n[0]) ? s->p[0] + i * 2 : s->p[1] + (i - s->n[0]) * 2;
+}
+
+void audio_resample_init(audio_resample_t *rs, int src_rate, int dst_rate, int mode) {
+    rs->mode = mode;
+    audio_resample_set_rate(rs, src_rate, dst_rate);
+    audio_resample_reset(rs);
+}
+
+void audio_resample_set_rate(audio_resample_t *rs, int src_rate, int dst_rate) {
+    if (src_rate <= 0 || dst_rate <= 0) {
+        rs->step = AUDIO_RESAMPLE_ONE;
+        return;
+    }
+    rs->step = (uint32_t)(((uint64_t)src_rate << 16) / (uint32_t)dst_rate);
+    if (rs->step == 0) rs->step = 1;
+}
+
+void audio_resample_reset(audio_resample_t *rs) {
+    rs->frac = AUDIO_RESAMPLE_ONE;  /* first frame is loaded before any output */
+    rs->prev[0] = 0;
+    rs->prev[1] = 0;
+}
+
+/* 2:1 - one output per pair of source frames */
+static int audio_resample_half(audio_resample_t *rs, audio_ring_t *ring,
+                               int16_t *out, int max_frames) {
+    audio_ring_span_t s;
+    uint32_t n = audio_ring_read_span(ring, &s, (uint32_t)max_frames * 2) / 2;
+    if (n == 0) return 0;
+
+    const int16_t *b = s.p[0];
+    for (uint32_t i = 0; i < n; i++) {
+        const int16_t *a = audio_resample_frame(&s, i * 2);
+        b = audio_resample_frame(&s, i * 2 + 1);
+        if (rs->mode == AUDIO_RESAMPLE_LINEAR) {
+            out[0] = (int16_t)(((int32_t)a[0] + b[0]) >> 1);
+            out[1] = (int16_t)(((int32_t)a[1] + b[1]) >> 1);
+        } else {
+            out[0] = a[0];
+            out[1] = a[1];
+        }
+        out += 2;
+    }
+    rs->prev[0] = b[0];
+    rs->prev[1] = b[1];
+    audio_ring_commit_read(ring, n * 2);
+    return n;
+}
+
+/* General ratio over one contiguous run of len frames (at most
+ * AUDIO_RESAMPLE_MAX_RUN): writes up to max output frames, then consumes the
+ * frames the position has moved past. Inlined with a constant mode, so each
+ * mode gets its own loop.
+ *
+ * frac counts from prev, so run frame i sits at (i + 1) << 16 and an output
+ * at frac lies between frame (frac >> 16) - 1 and frame frac >> 16. The
+ * outputs whose right-hand frame is in the run are counted up front; the
+ * loops then just step frac, with no bounds or consume checks per frame. */
+static inline __attribute__((always_inline))
+int audio_resample_segment(const int16_t *f, uint32_t len, uint32_t *used,
+                           uint32_t step, uint32_t *frac_io, int32_t *p0_io, int32_t *p1_io,
+                           int16_t *out, int max, int mode) {
+    uint32_t frac = *frac_io;
+    int32_t p0 = *p0_io, p1 = *p1_io;
+    uint32_t end = len << 16;
+    int n = 0;
+
+    if (frac < end && max > 0) {
+        uint32_t count = (end - 1 - frac) / step + 1;
+        if (count > (uint32_t)max) count = (uint32_t)max;
+        n = (int)count;
+
+        /* Between prev and the run's first frame */
+        for (; count > 0 && frac < AUDIO_RESAMPLE_ONE; count--) {
+            if (mode == AUDIO_RESAMPLE_LINEAR) {
+                int32_t t = (int32_t)(frac >> 1);  /* 15 bits keeps the product in range */
+                out[0] = (int16_t)(p0 + (((f[0] - p0) * t) >> 15));
+                out[1] = (int16_t)(p1 + (((f[1] - p1) * t) >> 15));
+            } else if (frac < AUDIO_RESAMPLE_ONE / 2) {
+                out[0] = (int16_t)p0;
+                out[1] = (int16_t)p1;
+            } else {
+                out[0] = f[0];
+                out[1] = f[1];
+            }
+            out += 2;
+            frac += step;
+        }
+
+        /* Between two frames of the run */
+        const int16_t *base = f - 2;
+        if (mode == AUDIO_RESAMPLE_LINEAR && step < AUDIO_RESAMPLE_ONE) {
+            /* Upsampling: several outputs per frame pair, so take the
+             * differences once per pair */
+            while (count > 0) {
+                const int16_t *a = base + (frac >> 16) * 2;
+                int32_t a0 = a[0], a1 = a[1];
+                int32_t d0 = a[2] - a0, d1 = a[3] - a1;
+                uint32_t next = (frac | 0xFFFF) + 1;
+                do {
+                    int32_t t = (int32_t)((frac & 0xFFFF) >> 1);
+                    out[0] = (int16_t)(a0 + ((d0 * t) >> 15));
+                    out[1] = (int16_t)(a1 + ((d1 * t) >> 15));
+                    out += 2;
+                    frac += step;
+                } while (--count > 0 && frac < next);
+            }
+        } else if (mode == AUDIO_RESAMPLE_LINEAR) {
+            for (; count > 0; count--) {
+                const int16_t *a = base + (frac >> 16) * 2;
+                int32_t t = (int32_t)((frac & 0xFFFF) >> 1);
+                int32_t a0 = a[0], a1 = a[1];
+                out[0] = (int16_t)(a0 + (((a[2] - a0) * t) >> 15));
+                out[1] = (int16_t)(a1 + (((a[3] - a1) * t) >> 15));
+                out += 2;
+                frac += step;
+            }
+        } else {
+            /* Rounded to the nearer frame */
+            for (; count > 0; count--) {
+                const int16_t *a = base + ((frac + AUDIO_RESAMPLE_ONE / 2) >> 16) * 2;
+                out[0] = a[0];
+                out[1] = a[1];
+                out += 2;
+                frac += step;
+            }
+        }
+    }
+
+    /* Consume the frames passed; only the last of them is needed, as prev */
+    uint32_t pos = frac >> 16;
+    if (pos > len) pos = len;
+    if (pos > 0) {
+        p0 = f[pos * 2 - 2];
+        p1 = f[pos * 2 - 1];
+        frac -= pos << 16;
+    }
+
+    *used = pos;
+    *frac_io = frac;
+    *p0_io = p0;
+    *p1_io = p1;
+    return n;
+}
+
+int audio_resample_run(audio_resample_t *rs, audio_ring_t *ring, int16_t *out, int max_frames) {
+    if (max_frames <= 0) return 0;
+
+    /* Fast paths, while the position is on a source frame */
+    if (rs->frac == AUDIO_RESAMPLE_ONE) {
+        if (rs->step == AUDIO_RESAMPLE_ONE) {
+            int n = audio_ring_read(ring, out, max_frames);
+            if (n > 0) {
+                rs->prev[0] = out[n * 2 - 2];
+                rs->prev[1] = out[n * 2 - 1];
+            }
+            return n;
+        }
+        if (rs->step == 2 * AUDIO_RESAMPLE_ONE) {
+            return audio_resample_half(rs, ring, out, max_frames);
+        }
+    }
+
+    /* Each of the ring's two spans is one contiguous run. A frame straddling
+     * the wrap needs nothing special: prev is carried in p0/p1. */
+    audio_ring_span_t s;
+    audio_ring_read_span(ring, &s, 0xFFFFFFFF);
+    uint32_t frac = rs->frac;
+    int32_t p0 = rs->prev[0], p1 = rs->prev[1];
+    uint32_t consumed = 0;
+    int n = 0;
+
+    for (int i = 0; i < 2; i++) {
+        const int16_t *f = s.p[i];
+        uint32_t left = s.n[i];
+        uint32_t used = 0, len = 0;
+        while (left > 0) {
+            len = (left < AUDIO_RESAMPLE_MAX_RUN) ? left : AUDIO_RESAMPLE_MAX_RUN;
+            if (rs->mode == AUDIO_RESAMPLE_LINEAR) {
+                n += audio_resample_segment(f, len, &used, rs->step, &frac, &p0, &p1,
+                                            out + n * 2, max_frames - n, AUDIO_RESAMPLE_LINEAR);
+            } else {
+                n += audio_resample_segment(f, len, &used, rs->step, &frac, &p0, &p1,
+                                            out + n * 2, max_frames - n, AUDIO_RESAMPLE_NEAREST);
+            }
+            consumed += used;
+            if (used < len) break;  /* stopped before the end of this run */
+            f += used * 2;
+            left -= used;
+        }
+        if (used < len) break;
+    }
+
+    rs->frac = frac;
+    rs->prev[0] = (int16_t)p0;
+    rs->prev[1] = (int16_t)p1;
+    audio_ring_commit_read(ring, consumed);
+    return n;
+}
@@ -0,0 +1,45 @@
+/*
+ * audio_resample.h - Fixed-point sample rate conversion out of an audio_ring
+ *
+ * Converts the stereo frames buffered in an audio_ring_t to the core output
+ * rate in blocks, working directly on the ring's read spans. The position is
+ * kept as a 16.16 fraction between the last consumed frame and the next one,
+ * so output is continuous across calls, seeks aside (audio_resample_reset).
+ *
+ * Two qualities: nearest (pick a frame) and linear (interpolate between the
+ * two neighbouring frames). Exact 1:1 becomes a plain copy, and exact 2:1
+ * (44.1 kHz -> 22.05 kHz) decimates frame pairs, averaging them in linear
+ * mode.
+ */
+
+#ifndef AUDIO_RESAMPLE_H
+#define AUDIO_RESAMPLE_H
+
+#include <stdint.h>
+#include "audio_ring.h"
+
+#define AUDIO_RESAMPLE_NEAREST 0
+#define AUDIO_RESAMPLE_LINEAR  1
+
+typedef struct {
+    uint32_t step;      /* source frames per output frame, 16.16 */
+    uint32_t frac;      /* position past prev, 16.16; >= 1.0 means prev is stale */
+    int mode;
+    int16_t prev[2];    /* last consumed frame */
+} audio_resample_t;
+
+/* Set up for src_rate -> dst_rate and drop any history */
+void audio_resample_init(audio_resample_t *rs, int src_rate, int dst_rate, int mode);
+
+/* Change the rates mid-stream (e.g. once the real MP3 rate is known)
+ * without dropping the current position */
+void audio_resample_set_rate(audio_resample_t *rs, int src_rate, int dst_rate);
+
+/* Forget the history, e.g. after the ring was reset on seek */
+void audio_resample_reset(audio_resample_t *rs);
+
+/* Produce up to max_frames stereo frames into out, consuming from ring.
+ * Returns the number of frames produced (fewer if the ring runs dry). */
+int audio_resample_run(audio_resample_t *rs, audio_ring_t *ring, int16_t *out, int max_frames);
+
+#endif /* AUDIO_RESAMPLE_H */
@@ -0,0 +1,105 @@
+/*
+ * audio_ring.c - Single-producer/single-consumer ring of stereo audio frames
+ *
+ * See audio_ring.h.
+ */
+
+#include "audio_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Order buffer accesses against the head/tail update the other side sees */
+#define AUDIO_RING_BARRIER() __sync_synchronize()
+
+int audio_ring_init(audio_ring_t *r, uint32_t frames) {
+    memset(r, 0, sizeof(*r));
+    if (frames == 0 || (frames & (frames - 1)) != 0) return 0;
+
+    r->buf = (int16_t *)malloc((size_t)frames * 2 * sizeof(int16_t));
+    if (!r->buf) return 0;
+    memset(r->buf, 0, (size_t)frames * 2 * sizeof(int16_t));
+    r->size = frames;
+    r->mask = frames - 1;
+    return 1;
+}
+
+void audio_ring_free(audio_ring_t *r) {
+    if (r->buf) free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+void audio_ring_reset(audio_ring_t *r) {
+    r->head = 0;
+    r->tail = 0;
+}
+
+/* Split n frames starting at position pos into at most two pieces */
+static uint32_t audio_ring_split(const audio_ring_t *r, audio_ring_span_t *s,
+                                 uint32_t pos, uint32_t n) {
+    uint32_t at = pos & r->mask;
+    uint32_t first = r->size - at;
+    if (first > n) first = n;
+
+    s->p[0] = r->buf + at * 2;
+    s->n[0] = first;
+    s->p[1] = r->buf;
+    s->n[1] = n - first;
+    return n;
+}
+
+uint32_t audio_ring_write_span(audio_ring_t *r, audio_ring_span_t *s, uint32_t max) {
+    uint32_t n = audio_ring_space(r);
+    if (n > max) n = max;
+    return audio_ring_split(r, s, r->head, n);
+}
+
+void audio_ring_commit_write(audio_ring_t *r, uint32_t frames) {
+    AUDIO_RING_BARRIER();   /* frames are in the buffer before head says so */
+    r->head += frames;
+}
+
+uint32_t audio_ring_read_span(audio_ring_t *r, audio_ring_span_t *s, uint32_t max) {
+    uint32_t n = audio_ring_count(r);
+    if (n > max) n = max;
+    AUDIO_RING_BARRIER();   /* don't read frames before seeing head */
+    return audio_ring_split(r, s, r->tail, n);
+}
+
+void audio_ring_commit_read(audio_ring_t *r, uint32_t frames) {
+    AUDIO_RING_BARRIER();   /* done reading before the producer may reuse them */
+    r->tail += frames;
+}
+
+uint32_t audio_ring_write(audio_ring_t *r, const int16_t *stereo, uint32_t frames) {
+    audio_ring_span_t s;
+    uint32_t n = audio_ring_write_span(r, &s, frames);
+    memcpy(s.p[0], stereo, s.n[0] * 2 * sizeof(int16_t));
+    if (s.n[1]) memcpy(s.p[1], stereo + s.n[0] * 2, s.n[1] * 2 * sizeof(int16_t));
+    audio_ring_commit_write(r, n);
+    return n;
+}
+
+uint32_t audio_ring_write_mono(audio_ring_t *r, const int16_t *mono, uint32_t frames) {
+    audio_ring_span_t s;
+    uint32_t n = audio_ring_write_span(r, &s, frames);
+    for (int k = 0; k < 2; k++) {
+        int16_t *dst = s.p[k];
+        for (uint32_t i = 0; i < s.n[k]; i++) {
+            int16_t v = *mono++;
+            dst[0] = v;
+            dst[1] = v;
+            dst += 2;
+        }
+    }
+    audio_ring_commit_write(r, n);
+    return n;
+}
+
+uint32_t audio_ring_read(audio_ring_t *r, int16_t *stereo, uint32_t frames) {
+    audio_ring_span_t s;
+    uint32_t n = audio_ring_read_span(r, &s, frames);
+    memcpy(stereo, s.p[0], s.n[0] * 2 * sizeof(int16_t));
+    if (s.n[1]) memcpy(stereo + s.n[0] * 2, s.p[1], s.n[1] * 2 * sizeof(int16_t));
+    audio_ring_commit_read(r, n);
+    return n;
+}
@@ -0,0 +1,69 @@
+/*
+ * audio_ring.h - Single-producer/single-consumer ring of stereo audio frames
+ *
+ * Shared by the music and video players. Frames are stored as int16_t[2]
+ * (left, right) in a power-of-two buffer, so positions wrap with a mask
+ * instead of a modulo and the output stage reads samples directly instead
+ * of rebuilding them from bytes.
+ *
+ * head and tail are free-running frame counters: head is only advanced by
+ * the producer (decoder), tail only by the consumer (audio output), so one
+ * thread can fill the ring while another drains it without a lock.
+ * Everything else (init, free, reset) must only be called while neither
+ * side is running, e.g. on seek from the thread that owns both.
+ *
+ * Writers and readers can work in place through spans: the free (or
+ * filled) region as at most two contiguous pieces, split where the buffer
+ * wraps.
+ */
+
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <stdint.h>
+
+typedef struct {
+    int16_t *buf;               /* size frames of left, right */
+    uint32_t size;              /* frames, power of two */
+    uint32_t mask;
+    volatile uint32_t head;     /* frames ever written (producer) */
+    volatile uint32_t tail;     /* frames ever read (consumer) */
+} audio_ring_t;
+
+/* Contiguous pieces of the ring: n[0] frames at p[0], then n[1] at p[1] */
+typedef struct {
+    int16_t *p[2];
+    uint32_t n[2];
+} audio_ring_span_t;
+
+/* Allocate a ring of frames frames (must be a power of two).
+ * Returns 1 on success, 0 if out of memory. */
+int audio_ring_init(audio_ring_t *r, uint32_t frames);
+
+void audio_ring_free(audio_ring_t *r);
+
+/* Drop all buffered audio (not thread safe - see above) */
+void audio_ring_reset(audio_ring_t *r);
+
+static inline uint32_t audio_ring_count(const audio_ring_t *r) {
+    return r->head - r->tail;
+}
+
+static inline uint32_t audio_ring_space(const audio_ring_t *r) {
+    return r->size - (r->head - r->tail);
+}
+
+/* Producer: free region (up to max frames). Fill it, then commit. */
+uint32_t audio_ring_write_span(audio_ring_t *r, audio_ring_span_t *s, uint32_t max);
+void audio_ring_commit_write(audio_ring_t *r, uint32_t frames);
+
+/* Consumer: filled region (up to max frames). Use it, then commit. */
+uint32_t audio_ring_read_span(audio_ring_t *r, audio_ring_span_t *s, uint32_t max);
+void audio_ring_commit_read(audio_ring_t *r, uint32_t frames);
+
+/* Copying helpers on top of the spans; all return frames transferred */
+uint32_t audio_ring_write(audio_ring_t *r, const int16_t *stereo, uint32_t frames);
+uint32_t audio_ring_write_mono(audio_ring_t *r, const int16_t *mono, uint32_t frames);
+uint32_t audio_ring_read(audio_ring_t *r, int16_t *stereo, uint32_t frames);
+
+#endif /* AUDIO_RING_H */
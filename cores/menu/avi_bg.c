@@ -8,6 +8,8 @@
 #include "avi_bg.h"
 #include "xvid/xvid.h"
 #include "xvid/image/image.h"
+#include "yuv2rgb.h"
+#include "avi_cache.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,6 +32,7 @@ static uint32_t frame_offsets[MAX_FRAMES];
 static uint32_t frame_sizes[MAX_FRAMES];
 static int total_frames = 0;
 static int current_frame = 0;
+static int index_scanned = 0;  /* index came from scan_movi (no idx1) - worth caching */
 static int video_width = 0;
 static int video_height = 0;
 
@@ -40,11 +43,10 @@ static int xvid_global_initialized = 0;  /* v22: Never reset - tracks global XVI
 
 /* Frame buffers */
 static uint8_t *frame_buffer = NULL;
-static uint8_t *yuv_buffer = NULL;
-static uint8_t *yuv_y = NULL;
-static uint8_t *yuv_u = NULL;
-static uint8_t *yuv_v = NULL;
-static uint16_t *rgb_buffer = NULL;
+static uint16_t *rgb_buffer = NULL;  /* XVID converts into this (XVID_CSP_FROGUI) */
+
+/* YUV->RGB565 converter - DITHER2, TV range, no gamma (like pmp123) */
+static yuv2rgb_t bg_conv;
 
 /* MPEG-4 extradata (VOL header) */
 #define MAX_EXTRADATA_SIZE 256
@@ -68,26 +70,10 @@ static int repeat_counter = 0;  /* current counter */
 static int dbg_advance_calls = 0;      /* avi_bg_advance_frame() calls */
 static int dbg_decode_calls = 0;       /* decode_frame() calls */
 static int dbg_decode_success = 0;     /* decode with xstats.type > 0 */
-static int dbg_yuv_convert = 0;        /* yuv_to_rgb565() calls */
+static int dbg_yuv_convert = 0;        /* pictures converted into rgb_buffer */
 static int dbg_last_frame = -1;        /* last decoded frame index */
 static int dbg_last_xstats_type = 0;   /* last xstats.type value */
 
-/* 4x4 Bayer dithering matrix - COPIED EXACTLY FROM pmp123 */
-static const int8_t bayer4x4[4][4] = {
-    { -8,  0, -6,  2 },
-    {  4, -4,  6, -2 },
-    { -5,  3, -7,  1 },
-    {  7, -1,  5, -3 }
-};
-
-/* YUV->RGB lookup tables - EXACTLY like pmp123 */
-static int16_t yuv_y_table[256];
-static int16_t yuv_rv_table[256];
-static int16_t yuv_gu_table[256];
-static int16_t yuv_gv_table[256];
-static int16_t yuv_bu_table[256];
-static int yuv_tables_initialized = 0;
-
 /* Helper functions */
 static inline uint32_t read_u32_le(const uint8_t *buf) {
     return buf[0] | (buf[1] << 8) | (buf[2] << 16) | (buf[3] << 24);
@@ -111,31 +97,6 @@ static int read32(FILE *fp, uint32_t *val) {
     return 0;
 }
 
-/* Initialize YUV->RGB tables - COPIED FROM pmp123 (TV range expansion) */
-static void init_yuv_tables(void) {
-    if (yuv_tables_initialized) return;
-
-    for (int i = 0; i < 256; i++) {
-        /* TV/Limited range (16-235 -> 0-255) - XVID outputs TV range!
-         * Formula: Y' = (Y - 16) * 255 / 219 = (Y - 16) * 298 / 256 */
-        int y_limited = ((i - 16) * 298) >> 8;
-        if (y_limited < 0) y_limited = 0;
-        if (y_limited > 255) y_limited = 255;
-        yuv_y_table[i] = y_limited;
-
-        /* U/V contributions - BT.601 coefficients
-         * R = Y' + 1.402 * (V-128)
-         * G = Y' - 0.344 * (U-128) - 0.714 * (V-128)
-         * B = Y' + 1.772 * (U-128) */
-        int uv = i - 128;
-        yuv_rv_table[i] = (1436 * uv) >> 10;   /* 1.402 * 1024 = 1436 */
-        yuv_gu_table[i] = (-352 * uv) >> 10;   /* -0.344 * 1024 = -352 */
-        yuv_gv_table[i] = (-731 * uv) >> 10;   /* -0.714 * 1024 = -731 */
-        yuv_bu_table[i] = (1815 * uv) >> 10;   /* 1.772 * 1024 = 1815 */
-    }
-    yuv_tables_initialized = 1;
-}
-
 /* v16: COPIED FROM pmp123 - Check if data at offset is a valid AVI chunk header */
 static int check_chunk_header(long offset) {
     if (offset < 0) return 0;
@@ -271,6 +232,75 @@ static void scan_movi(long movi_start, long movi_end) {
     }
 }
 
+/* Index cache - backgrounds without idx1 are scanned once, then loaded from
+ * AVI_CACHE_DIR on every later boot / theme switch */
+#define BG_CACHE_VERSION 1
+
+typedef struct {
+    uint32_t us_per_frame;
+    uint32_t clip_fps;
+    int32_t video_width;
+    int32_t video_height;
+    int32_t total_frames;
+    int32_t extradata_size;
+    uint8_t extradata[MAX_EXTRADATA_SIZE];
+} bg_cache_header_t;
+
+static void save_cache(const char *path) {
+    bg_cache_header_t h;
+    avi_cache_section_t sec[3];
+
+    memset(&h, 0, sizeof(h));
+    h.us_per_frame = us_per_frame;
+    h.clip_fps = clip_fps;
+    h.video_width = video_width;
+    h.video_height = video_height;
+    h.total_frames = total_frames;
+    h.extradata_size = mpeg4_extradata_size;
+    memcpy(h.extradata, mpeg4_extradata, mpeg4_extradata_size);
+
+    sec[0].data = &h;
+    sec[0].size = sizeof(h);
+    sec[1].data = frame_offsets;
+    sec[1].size = total_frames * sizeof(uint32_t);
+    sec[2].data = frame_sizes;
+    sec[2].size = total_frames * sizeof(uint32_t);
+    avi_cache_save(path, AVI_CACHE_KIND_BG, BG_CACHE_VERSION, sec, 3);
+}
+
+static int load_cache(const char *path) {
+    bg_cache_header_t h;
+    avi_cache_section_t sec[3];
+
+    void *buf = avi_cache_load(path, AVI_CACHE_KIND_BG, BG_CACHE_VERSION, sec, 3);
+    if (!buf) return 0;
+
+    int ok = 0;
+    if (sec[0].size == sizeof(h)) {
+        memcpy(&h, sec[0].data, sizeof(h));
+        ok = h.total_frames > 0 && h.total_frames <= MAX_FRAMES &&
+             h.extradata_size >= 0 && h.extradata_size <= MAX_EXTRADATA_SIZE &&
+             sec[1].size == h.total_frames * sizeof(uint32_t) &&
+             sec[2].size == h.total_frames * sizeof(uint32_t);
+    }
+    if (ok) {
+        us_per_frame = h.us_per_frame;
+        clip_fps = h.clip_fps;
+        video_width = h.video_width;
+        video_height = h.video_height;
+        total_frames = h.total_frames;
+        mpeg4_extradata_size = h.extradata_size;
+        memcpy(mpeg4_extradata, h.extradata, h.extradata_size);
+        memcpy(frame_offsets, sec[1].data, sec[1].size);
+        memcpy(frame_sizes, sec[2].data, sec[2].size);
+        mpeg4_extradata_sent = 0;
+        repeat_count = 1;
+        repeat_counter = 0;
+    }
+    free(buf);
+    return ok;
+}
+
 /* Parse AVI file structure */
 static int parse_avi(void) {
     uint32_t chunk_size, hsize;
@@ -281,6 +311,7 @@ static int parse_avi(void) {
     int found_idx1 = 0;
 
     total_frames = 0;
+    index_scanned = 0;
     video_width = 320;
     video_height = 240;
     mpeg4_extradata_size = 0;
@@ -393,6 +424,7 @@ static int parse_avi(void) {
                 found_idx1 = parse_idx1(movi_start);  /* FIX: pass movi_start directly */
                 if (!found_idx1) {
                     scan_movi(movi_start, movi_end);
+                    index_scanned = 1;
                 }
                 break;
             }
@@ -434,24 +466,6 @@ static int init_xvid(void) {
     if (ret < 0) return 0;
 
     xvid_handle = xcreate.handle;
-
-    int w = video_width > 0 ? video_width : 320;
-    int h = video_height > 0 ? video_height : 240;
-    int y_size = w * h;
-    int uv_size = (w / 2) * (h / 2);
-
-    yuv_buffer = (uint8_t *)malloc(y_size + 2 * uv_size);
-    if (!yuv_buffer) {
-        xvid_decore(xvid_handle, XVID_DEC_DESTROY, NULL, NULL);
-        xvid_handle = NULL;
-        return 0;
-    }
-
-    memset(yuv_buffer, 0, y_size + 2 * uv_size);
-    yuv_y = yuv_buffer;
-    yuv_u = yuv_buffer + y_size;
-    yuv_v = yuv_buffer + y_size + uv_size;
-
     xvid_initialized = 1;
     return 1;
 }
@@ -461,13 +475,7 @@ static void close_xvid(void) {
         xvid_decore(xvid_handle, XVID_DEC_DESTROY, NULL, NULL);
         xvid_handle = NULL;
     }
-    if (yuv_buffer) {
-        free(yuv_buffer);
-        yuv_buffer = NULL;
-        yuv_y = NULL;
-        yuv_u = NULL;
-        yuv_v = NULL;
-    }
+    yuv2rgb_forget(&bg_conv);  /* remembered picture lived inside the decoder */
     xvid_initialized = 0;
 }
 
@@ -503,9 +511,6 @@ static int decode_frame(int idx) {
         mpeg4_extradata_sent = 1;
     }
 
-    int w = video_width > 0 ? video_width : 320;
-    int h = video_height > 0 ? video_height : 240;
-
     uint8_t *bitstream = frame_buffer;
     int remaining = size;
     int ret = 0;
@@ -521,13 +526,11 @@ static int decode_frame(int idx) {
         xstats.version = XVID_VERSION;
         xframe.bitstream = bitstream;
         xframe.length = remaining;
-        xframe.output.csp = XVID_CSP_PLANAR;
-        xframe.output.plane[0] = yuv_y;
-        xframe.output.plane[1] = yuv_u;
-        xframe.output.plane[2] = yuv_v;
-        xframe.output.stride[0] = w;
-        xframe.output.stride[1] = w / 2;
-        xframe.output.stride[2] = w / 2;
+        /* Convert straight into rgb_buffer from the decoder's own image */
+        xframe.output.csp = XVID_CSP_FROGUI;
+        xframe.output.plane[0] = rgb_buffer;
+        xframe.output.plane[1] = &bg_conv;
+        xframe.output.stride[0] = AVI_SCREEN_WIDTH * sizeof(uint16_t);
 
         ret = xvid_decore(xvid_handle, XVID_DEC_DECODE, &xframe, &xstats);
 
@@ -535,11 +538,9 @@ static int decode_frame(int idx) {
         if (xstats.type == XVID_TYPE_VOL) {
             if (xstats.data.vol.width > 0) {
                 video_width = xstats.data.vol.width;
-                w = video_width;
             }
             if (xstats.data.vol.height > 0) {
                 video_height = xstats.data.vol.height;
-                h = video_height;
             }
         }
 
@@ -556,110 +557,21 @@ static int decode_frame(int idx) {
     dbg_last_xstats_type = xstats.type;  /* v14: track last xstats.type */
 
     if (xstats.type <= 0) {
-        /* No frame decoded yet (maybe needs more data) */
+        /* No frame decoded yet (maybe needs more data) - rgb_buffer keeps the previous one */
         return 1;  /* Return success to avoid breaking playback */
     }
 
+    dbg_yuv_convert++;     /* v14: count yuv conversions */
     dbg_decode_success++;  /* v14: count successful decodes (type > 0) */
     return 1;
 }
 
-/* YUV420P to RGB565 with DITHER2 - COPIED EXACTLY FROM pmp123
- * Applies Bayer 4x4 dithering on 8-bit values BEFORE converting to RGB565
- * This improves quality on low-color displays by reducing banding */
-static void yuv_to_rgb565(void) {
-    if (!yuv_tables_initialized) init_yuv_tables();
-
-    int w = video_width > 0 ? video_width : 320;
-    int h = video_height > 0 ? video_height : 240;
-
-    /* For 320x240 video on 320x240 screen - direct 1:1 copy, no scaling */
-    if (w == 320 && h == 240) {
-        uint16_t *dst = rgb_buffer;
-
-        for (int j = 0; j < 240; j++) {
-            uint8_t *y_row = yuv_y + j * 320;
-            uint8_t *u_row = yuv_u + (j >> 1) * 160;
-            uint8_t *v_row = yuv_v + (j >> 1) * 160;
-
-            for (int i = 0; i < 320; i++) {
-                int y = yuv_y_table[y_row[i]];
-                int u_idx = u_row[i >> 1];
-                int v_idx = v_row[i >> 1];
-
-                int r = y + yuv_rv_table[v_idx];
-                int g = y + yuv_gu_table[u_idx] + yuv_gv_table[v_idx];
-                int b = y + yuv_bu_table[u_idx];
-
-                /* Clamp to 0-255 */
-                if (r < 0) r = 0; else if (r > 255) r = 255;
-                if (g < 0) g = 0; else if (g > 255) g = 255;
-                if (b < 0) b = 0; else if (b > 255) b = 255;
-
-                /* DITHER2 - Apply Bayer dithering to ALL pixels including black
-                 * COPIED EXACTLY FROM pmp123 yuv420p_to_rgb565() */
-                int dither = bayer4x4[j & 3][i & 3];
-                r = r + dither;
-                g = g + dither;
-                b = b + dither;
-                if (r < 0) r = 0; else if (r > 255) r = 255;
-                if (g < 0) g = 0; else if (g > 255) g = 255;
-                if (b < 0) b = 0; else if (b > 255) b = 255;
-
-                /* Convert to RGB565 */
-                *dst++ = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-            }
-        }
-    }
-    else {
-        /* Fallback for non-320x240 video */
-        int off_x = (320 - w) / 2;
-        int off_y = (240 - h) / 2;
-        if (off_x < 0) off_x = 0;
-        if (off_y < 0) off_y = 0;
-
-        memset(rgb_buffer, 0, 320 * 240 * sizeof(uint16_t));
-
-        for (int j = 0; j < h && (off_y + j) < 240; j++) {
-            uint8_t *y_row = yuv_y + j * w;
-            uint8_t *u_row = yuv_u + (j >> 1) * (w / 2);
-            uint8_t *v_row = yuv_v + (j >> 1) * (w / 2);
-            uint16_t *dst = rgb_buffer + (off_y + j) * 320 + off_x;
-
-            for (int i = 0; i < w && (off_x + i) < 320; i++) {
-                int y = yuv_y_table[y_row[i]];
-                int u_idx = u_row[i >> 1];
-                int v_idx = v_row[i >> 1];
-
-                int r = y + yuv_rv_table[v_idx];
-                int g = y + yuv_gu_table[u_idx] + yuv_gv_table[v_idx];
-                int b = y + yuv_bu_table[u_idx];
-
-                if (r < 0) r = 0; else if (r > 255) r = 255;
-                if (g < 0) g = 0; else if (g > 255) g = 255;
-                if (b < 0) b = 0; else if (b > 255) b = 255;
-
-                /* DITHER2 - Apply Bayer dithering to ALL pixels */
-                int dither = bayer4x4[j & 3][i & 3];
-                r = r + dither;
-                g = g + dither;
-                b = b + dither;
-                if (r < 0) r = 0; else if (r > 255) r = 255;
-                if (g < 0) g = 0; else if (g > 255) g = 255;
-                if (b < 0) b = 0; else if (b > 255) b = 255;
-
-                *dst++ = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-            }
-        }
-    }
-
-    /* v19: Debug overlay removed for production */
-}
-
 /* Public API */
 
 void avi_bg_init(void) {
-    init_yuv_tables();
+    if (!bg_conv.ready) {
+        yuv2rgb_setup(&bg_conv, NULL, NULL, NULL, 1, YUV2RGB_RANGE_TV);
+    }
 
     if (!frame_buffer) {
         frame_buffer = (uint8_t *)malloc(MAX_FRAME_SIZE);
@@ -691,12 +603,18 @@ int avi_bg_load(const char *path) {
     avi_file = fopen(path, "rb");
     if (!avi_file) return 0;
 
-    if (!parse_avi()) {
-        fclose(avi_file);
-        avi_file = NULL;
-        return 0;
+    if (!load_cache(path)) {
+        if (!parse_avi()) {
+            fclose(avi_file);
+            avi_file = NULL;
+            return 0;
+        }
+        if (index_scanned) save_cache(path);
     }
 
+    /* Black until the first picture is decoded */
+    memset(rgb_buffer, 0, AVI_SCREEN_WIDTH * AVI_SCREEN_HEIGHT * sizeof(uint16_t));
+
     current_frame = 0;
     if (!decode_frame(0)) {
         fclose(avi_file);
@@ -705,8 +623,6 @@ int avi_bg_load(const char *path) {
         return 0;
     }
 
-    yuv_to_rgb565();
-
     is_active = true;
     is_paused = false;
     return 1;
@@ -754,8 +670,6 @@ int avi_bg_advance_frame(void) {
         if (!decode_frame(current_frame)) {
             return 0;
         }
-        dbg_yuv_convert++;  /* v14: count yuv conversions */
-        yuv_to_rgb565();
     }
     /* else: same frame displayed again (repeat), rgb_buffer already has it */
 
@@ -779,7 +693,6 @@ void avi_bg_reset(void) {
     repeat_counter = 0;  /* Reset frame timing */
     mpeg4_extradata_sent = 0;  /* Reset for proper restart */
     decode_frame(0);
-    yuv_to_rgb565();
 }
 
 void avi_bg_pause(void) {
@@ -0,0 +1,138 @@
+/*
+ * avi_cache.c - Sidecar index cache for AVI files
+ *
+ * See avi_cache.h.
+ */
+
+#include "avi_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define AVI_CACHE_MAGIC 0x58494146   /* "FAIX" */
+#define AVI_CACHE_PARENT "/mnt/sda1/frogui"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t kind;
+    uint32_t version;
+    uint32_t path_hash;
+    uint64_t file_size;
+    uint32_t file_mtime;
+    uint32_t count;                           /* sections */
+    uint32_t size[AVI_CACHE_MAX_SECTIONS];    /* bytes of each section */
+} avi_cache_header_t;
+
+/* FNV-1a of the full path, so files with the same name in different
+ * folders get different cache files */
+static uint32_t avi_cache_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void avi_cache_file(const char *avi_path, uint32_t kind, char *out, int out_size) {
+    snprintf(out, out_size, "%s/%08x.%u.idx", AVI_CACHE_DIR,
+             (unsigned)avi_cache_hash(avi_path), (unsigned)kind);
+}
+
+/* Identity of the AVI the cache belongs to */
+static int avi_cache_stamp(const char *avi_path, uint32_t kind, uint32_t version,
+                           avi_cache_header_t *h) {
+    struct stat st;
+    if (stat(avi_path, &st) != 0) return 0;
+
+    memset(h, 0, sizeof(*h));
+    h->magic = AVI_CACHE_MAGIC;
+    h->kind = kind;
+    h->version = version;
+    h->path_hash = avi_cache_hash(avi_path);
+    h->file_size = (uint64_t)st.st_size;
+    h->file_mtime = (uint32_t)st.st_mtime;
+    return 1;
+}
+
+int avi_cache_save(const char *avi_path, uint32_t kind, uint32_t version,
+                   const avi_cache_section_t *sec, int count) {
+    avi_cache_header_t h;
+    char path[512];
+
+    if (count < 0 || count > AVI_CACHE_MAX_SECTIONS) return 0;
+    if (!avi_cache_stamp(avi_path, kind, version, &h)) return 0;
+    h.count = count;
+    for (int i = 0; i < count; i++) h.size[i] = sec[i].size;
+
+    mkdir(AVI_CACHE_PARENT, 0755);
+    mkdir(AVI_CACHE_DIR, 0755);
+
+    avi_cache_file(avi_path, kind, path, sizeof(path));
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return 0;
+
+    int ok = (fwrite(&h, sizeof(h), 1, fp) == 1);
+    for (int i = 0; ok && i < count; i++) {
+        if (sec[i].size > 0 && fwrite(sec[i].data, 1, sec[i].size, fp) != sec[i].size) ok = 0;
+    }
+    if (fclose(fp) != 0) ok = 0;
+
+    /* A short file would fail the size check on load anyway, but don't leave junk */
+    if (!ok) remove(path);
+    return ok;
+}
+
+void *avi_cache_load(const char *avi_path, uint32_t kind, uint32_t version,
+                     avi_cache_section_t *sec, int count) {
+    avi_cache_header_t want;
+    char path[512];
+
+    if (count < 0 || count > AVI_CACHE_MAX_SECTIONS) return NULL;
+    if (!avi_cache_stamp(avi_path, kind, version, &want)) return NULL;
+
+    avi_cache_file(avi_path, kind, path, sizeof(path));
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    /* Whole file in one read */
+    uint8_t *buf = NULL;
+    long len = 0;
+    if (fseek(fp, 0, SEEK_END) == 0) len = ftell(fp);
+    if (len >= (long)sizeof(avi_cache_header_t)) {
+        buf = (uint8_t *)malloc(len);
+        fseek(fp, 0, SEEK_SET);
+        if (buf && fread(buf, 1, len, fp) != (size_t)len) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(fp);
+    if (!buf) return NULL;
+
+    avi_cache_header_t h;
+    memcpy(&h, buf, sizeof(h));
+    if (h.magic != want.magic || h.kind != want.kind || h.version != want.version ||
+        h.path_hash != want.path_hash || h.file_size != want.file_size ||
+        h.file_mtime != want.file_mtime || h.count != (uint32_t)count) {
+        free(buf);
+        return NULL;
+    }
+
+    uint32_t pos = sizeof(h);
+    for (int i = 0; i < count; i++) {
+        if (h.size[i] > (uint32_t)len - pos) {
+            free(buf);
+            return NULL;
+        }
+        sec[i].data = buf + pos;
+        sec[i].size = h.size[i];
+        pos += h.size[i];
+    }
+    if (pos != (uint32_t)len) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
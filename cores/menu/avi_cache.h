@@ -0,0 +1,44 @@
+/*
+ * avi_cache.h - Sidecar index cache for AVI files
+ *
+ * AVIs without an idx1 have to be indexed by walking every chunk header of
+ * the movi list, which takes seconds on large files. The result of that scan
+ * is stored as a small binary file under AVI_CACHE_DIR and read back in one
+ * go the next time the same file is opened.
+ *
+ * A cache file is a header followed by a list of raw sections (whatever the
+ * caller passed to avi_cache_save, e.g. parsed stream headers and index
+ * arrays). It is tied to its AVI by path hash, file size and mtime, so an
+ * edited or replaced file is simply scanned again.
+ */
+
+#ifndef AVI_CACHE_H
+#define AVI_CACHE_H
+
+#include <stdint.h>
+
+#define AVI_CACHE_DIR          "/mnt/sda1/frogui/cache"
+#define AVI_CACHE_MAX_SECTIONS 8
+
+/* Who wrote the cache - each user has its own section layout */
+#define AVI_CACHE_KIND_PLAYER  1   /* FrogPMP video player */
+#define AVI_CACHE_KIND_BG      2   /* animated theme background */
+
+typedef struct {
+    const void *data;
+    uint32_t size;
+} avi_cache_section_t;
+
+/* Write the cache for avi_path. Returns 1 on success, 0 on failure
+ * (missing AVI, cache directory not writable, ...). */
+int avi_cache_save(const char *avi_path, uint32_t kind, uint32_t version,
+                   const avi_cache_section_t *sec, int count);
+
+/* Read the cache for avi_path if it is still valid for the file and has
+ * exactly count sections. On success fills sec[] with pointers into the
+ * returned buffer (free() it when done); returns NULL if there is no
+ * usable cache. */
+void *avi_cache_load(const char *avi_path, uint32_t kind, uint32_t version,
+                     avi_cache_section_t *sec, int count);
+
+#endif /* AVI_CACHE_H */
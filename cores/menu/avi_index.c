@@ -0,0 +1,417 @@
+/*
+ * avi_index.c - Compact chunk index for AVI playback
+ *
+ * See avi_index.h for the layout.
+ */
+
+#include "avi_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AVI_INDEX_MASK        (AVI_INDEX_BLOCK - 1)
+#define AVI_INDEX_FIRST_CAP   1024   /* entries */
+#define AVI_INDEX_FIRST_BLOCKS 16
+#define AVI_INDEX_FIRST_ESCS  64
+#define AVI_INDEX_FIRST_SEEDS 16
+
+void avi_index_init(avi_index_t *ix, int paged) {
+    memset(ix, 0, sizeof(*ix));
+    ix->paged = paged;
+    for (int i = 0; i < AVI_INDEX_PAGE_SLOTS; i++) {
+        ix->pages[i].block = -1;
+    }
+}
+
+void avi_index_free(avi_index_t *ix) {
+    if (ix->sizes) free(ix->sizes);
+    if (ix->gaps) free(ix->gaps);
+    if (ix->blocks) free(ix->blocks);
+    if (ix->escs) free(ix->escs);
+    if (ix->seeds) free(ix->seeds);
+    avi_index_init(ix, 0);
+}
+
+void avi_index_set_pager(avi_index_t *ix, avi_index_pager_t pager, void *ctx) {
+    ix->pager = pager;
+    ix->pager_ctx = ctx;
+}
+
+/* Grow a dynamic array to hold at least need elements (doubling) */
+static int avi_index_grow(void **arr, int *cap, int need, int first, size_t elem) {
+    if (need <= *cap) return 1;
+    int new_cap = *cap ? *cap : first;
+    while (new_cap < need) new_cap *= 2;
+    void *p = realloc(*arr, (size_t)new_cap * elem);
+    if (!p) return 0;
+    *arr = p;
+    *cap = new_cap;
+    return 1;
+}
+
+static int avi_index_escape(avi_index_t *ix, uint32_t key, uint32_t value) {
+    int cap = (int)ix->esc_cap;
+    if (!avi_index_grow((void **)&ix->escs, &cap, (int)ix->esc_count + 1,
+                        AVI_INDEX_FIRST_ESCS, sizeof(avi_index_escape_t))) {
+        return 0;
+    }
+    ix->esc_cap = (uint32_t)cap;
+    ix->escs[ix->esc_count].key = key;
+    ix->escs[ix->esc_count].value = value;
+    ix->esc_count++;
+    return 1;
+}
+
+int avi_index_add(avi_index_t *ix, uint64_t offset, uint32_t size, uint32_t src) {
+    int i = ix->count;
+
+    if ((i & AVI_INDEX_MASK) == 0) {
+        int b = i >> AVI_INDEX_BLOCK_SHIFT;
+        if (!avi_index_grow((void **)&ix->blocks, &ix->block_cap, b + 1,
+                            AVI_INDEX_FIRST_BLOCKS, sizeof(avi_index_block_t))) {
+            return 0;
+        }
+        ix->blocks[b].anchor = offset;
+        ix->blocks[b].before = ix->total;
+        ix->blocks[b].esc = ix->esc_count;
+        ix->blocks[b].src = src;
+        if (ix->known_blocks == b) ix->known_blocks = b + 1;
+    }
+
+    if (!ix->paged) {
+        int cap = ix->cap;
+        if (!avi_index_grow((void **)&ix->sizes, &cap, i + 1, AVI_INDEX_FIRST_CAP, sizeof(uint16_t))) return 0;
+        cap = ix->cap;
+        if (!avi_index_grow((void **)&ix->gaps, &cap, i + 1, AVI_INDEX_FIRST_CAP, sizeof(uint16_t))) return 0;
+        ix->cap = cap;
+
+        /* Gap from the previous entry's end (the block anchor covers entry 0) */
+        uint16_t gap16 = 0;
+        if ((i & AVI_INDEX_MASK) != 0) {
+            int64_t gap = (int64_t)(offset - ix->last_end);
+            if (gap >= 0 && gap < AVI_INDEX_ESCAPE) {
+                gap16 = (uint16_t)gap;
+            } else {
+                if (!avi_index_escape(ix, (uint32_t)i << 1, (uint32_t)(int32_t)gap)) return 0;
+                gap16 = AVI_INDEX_ESCAPE;
+            }
+        }
+        ix->gaps[i] = gap16;
+
+        if (size < AVI_INDEX_ESCAPE) {
+            ix->sizes[i] = (uint16_t)size;
+        } else {
+            if (!avi_index_escape(ix, ((uint32_t)i << 1) | 1, size)) return 0;
+            ix->sizes[i] = AVI_INDEX_ESCAPE;
+        }
+    }
+
+    ix->last_end = offset + size;
+    ix->total += size;
+    ix->count++;
+    return 1;
+}
+
+int avi_index_add_paged(avi_index_t *ix, int n, uint32_t src) {
+    if (!ix->paged || n <= 0) return n == 0;
+
+    int first = ix->count;
+    int last_block = (first + n - 1) >> AVI_INDEX_BLOCK_SHIFT;
+    if (!avi_index_grow((void **)&ix->blocks, &ix->block_cap, last_block + 1,
+                        AVI_INDEX_FIRST_BLOCKS, sizeof(avi_index_block_t))) {
+        return 0;
+    }
+
+    /* Blocks that start inside the new range */
+    int b = (first + AVI_INDEX_MASK) >> AVI_INDEX_BLOCK_SHIFT;
+    for (; b <= last_block; b++) {
+        ix->blocks[b].anchor = 0;
+        ix->blocks[b].before = 0;
+        ix->blocks[b].esc = 0;
+        ix->blocks[b].src = src + (uint32_t)((b << AVI_INDEX_BLOCK_SHIFT) - first);
+    }
+
+    ix->count += n;
+    return 1;
+}
+
+int avi_index_seed(avi_index_t *ix, int entry, uint64_t before) {
+    if (!avi_index_grow((void **)&ix->seeds, &ix->seed_cap, ix->seed_count + 1,
+                        AVI_INDEX_FIRST_SEEDS, sizeof(avi_index_seed_t))) {
+        return 0;
+    }
+    ix->seeds[ix->seed_count].entry = entry;
+    ix->seeds[ix->seed_count].before = before;
+    ix->seed_count++;
+    return 1;
+}
+
+void avi_index_finish(avi_index_t *ix) {
+    void *p;
+    if (ix->count == 0) return;
+
+    if (!ix->paged && ix->cap > ix->count) {
+        if ((p = realloc(ix->sizes, ix->count * sizeof(uint16_t))) != NULL) ix->sizes = p;
+        if ((p = realloc(ix->gaps, ix->count * sizeof(uint16_t))) != NULL) ix->gaps = p;
+        ix->cap = ix->count;
+    }
+
+    int blocks = (ix->count + AVI_INDEX_MASK) >> AVI_INDEX_BLOCK_SHIFT;
+    if (ix->block_cap > blocks) {
+        if ((p = realloc(ix->blocks, blocks * sizeof(avi_index_block_t))) != NULL) {
+            ix->blocks = p;
+            ix->block_cap = blocks;
+        }
+    }
+
+    if (ix->esc_count > 0 && ix->esc_cap > ix->esc_count) {
+        if ((p = realloc(ix->escs, ix->esc_count * sizeof(avi_index_escape_t))) != NULL) {
+            ix->escs = p;
+            ix->esc_cap = ix->esc_count;
+        }
+    }
+}
+
+/* Escaped value for key, scanning forward from *e (keys only grow within a block) */
+static uint32_t avi_index_escaped(const avi_index_t *ix, uint32_t *e, uint32_t key) {
+    while (*e < ix->esc_count && ix->escs[*e].key < key) (*e)++;
+    return (*e < ix->esc_count) ? ix->escs[*e].value : 0;
+}
+
+/* Decoded entries of a paged block, reading it through the pager if needed */
+static avi_index_page_t *avi_index_page(avi_index_t *ix, int b) {
+    avi_index_page_t *lru = &ix->pages[0];
+    for (int i = 0; i < AVI_INDEX_PAGE_SLOTS; i++) {
+        avi_index_page_t *pg = &ix->pages[i];
+        if (pg->block == b) {
+            pg->used = ++ix->page_stamp;
+            return pg;
+        }
+        if (pg->used < lru->used) lru = pg;
+    }
+
+    if (!ix->pager) return NULL;
+    int first = b << AVI_INDEX_BLOCK_SHIFT;
+    int n = ix->count - first;
+    if (n > AVI_INDEX_BLOCK) n = AVI_INDEX_BLOCK;
+
+    lru->block = -1;
+    if (ix->pager(ix->pager_ctx, ix->blocks[b].src, n, lru->offset, lru->size) < n) return NULL;
+    lru->block = b;
+    lru->used = ++ix->page_stamp;
+    return lru;
+}
+
+int avi_index_get(avi_index_t *ix, int i, uint64_t *offset, uint32_t *size) {
+    if (i < 0 || i >= ix->count) return 0;
+
+    int b = i >> AVI_INDEX_BLOCK_SHIFT;
+
+    if (ix->paged) {
+        avi_index_page_t *pg = avi_index_page(ix, b);
+        if (!pg) return 0;
+        *offset = pg->offset[i & AVI_INDEX_MASK];
+        *size = pg->size[i & AVI_INDEX_MASK];
+        return 1;
+    }
+
+    /* Walk from the block anchor: offset of j+1 = end of j + gap of j+1 */
+    int j = b << AVI_INDEX_BLOCK_SHIFT;
+    uint32_t e = ix->blocks[b].esc;
+    uint64_t off = ix->blocks[b].anchor;
+    for (;;) {
+        uint32_t sz = ix->sizes[j];
+        if (sz == AVI_INDEX_ESCAPE) sz = avi_index_escaped(ix, &e, ((uint32_t)j << 1) | 1);
+        if (j == i) {
+            *offset = off;
+            *size = sz;
+            return 1;
+        }
+        j++;
+        off += sz;
+        uint32_t gap = ix->gaps[j];
+        if (gap == AVI_INDEX_ESCAPE) {
+            off += (int64_t)(int32_t)avi_index_escaped(ix, &e, (uint32_t)j << 1);
+        } else {
+            off += gap;
+        }
+    }
+}
+
+/* Sizes of the entries of block b; returns how many (0 if paging failed) */
+static int avi_index_block_sizes(avi_index_t *ix, int b, uint32_t *size) {
+    int first = b << AVI_INDEX_BLOCK_SHIFT;
+    int n = ix->count - first;
+    if (n > AVI_INDEX_BLOCK) n = AVI_INDEX_BLOCK;
+
+    if (ix->paged) {
+        avi_index_page_t *pg = avi_index_page(ix, b);
+        if (!pg) return 0;
+        memcpy(size, pg->size, n * sizeof(uint32_t));
+        return n;
+    }
+
+    uint32_t e = ix->blocks[b].esc;
+    for (int k = 0; k < n; k++) {
+        uint32_t sz = ix->sizes[first + k];
+        if (sz == AVI_INDEX_ESCAPE) sz = avi_index_escaped(ix, &e, ((uint32_t)(first + k) << 1) | 1);
+        size[k] = sz;
+    }
+    return n;
+}
+
+/* avi_index_find_byte() from the last seed at or before pos, paging only
+ * the entries between it and the next seed. Returns -2 if no seed lies past
+ * the totalled blocks or the seeds don't agree with the entries. */
+static int avi_index_find_seeded(avi_index_t *ix, uint64_t pos, uint64_t *start) {
+    uint32_t size[AVI_INDEX_BLOCK];
+
+    int lo = 0, hi = ix->seed_count - 1;
+    if (hi < 0 || ix->seeds[0].before > pos) return -2;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (ix->seeds[mid].before <= pos) lo = mid; else hi = mid - 1;
+    }
+
+    const avi_index_seed_t *seed = &ix->seeds[lo];
+    if (seed->entry >= ix->count) return -1;    /* past the end */
+    if ((seed->entry >> AVI_INDEX_BLOCK_SHIFT) < ix->known_blocks) return -2;
+    int end = (lo + 1 < ix->seed_count) ? ix->seeds[lo + 1].entry : ix->count;
+    if (end > ix->count) end = ix->count;
+
+    uint64_t at = seed->before;
+    int i = seed->entry;
+    while (i < end) {
+        int n = avi_index_block_sizes(ix, i >> AVI_INDEX_BLOCK_SHIFT, size);
+        if (n == 0) return -2;
+        for (int k = i & AVI_INDEX_MASK; k < n && i < end; k++, i++) {
+            if (pos < at + size[k]) {
+                *start = at;
+                return i;
+            }
+            at += size[k];
+        }
+    }
+    return -2;
+}
+
+int avi_index_find_byte(avi_index_t *ix, uint64_t pos, uint64_t *start) {
+    uint32_t size[AVI_INDEX_BLOCK];
+    int blocks = (ix->count + AVI_INDEX_MASK) >> AVI_INDEX_BLOCK_SHIFT;
+    if (blocks == 0) return -1;
+
+    if (ix->known_blocks < blocks && ix->seed_count > 0) {
+        int found = avi_index_find_seeded(ix, pos, start);
+        if (found != -2) return found;
+    }
+
+    /* Pager-only blocks: total them up in order until one starts past pos */
+    if (ix->known_blocks == 0) {
+        ix->blocks[0].before = 0;
+        ix->known_blocks = 1;
+    }
+    while (ix->known_blocks < blocks && ix->blocks[ix->known_blocks - 1].before <= pos) {
+        int b = ix->known_blocks - 1;
+        int n = avi_index_block_sizes(ix, b, size);
+        if (n == 0) return -1;
+        uint64_t sum = 0;
+        for (int k = 0; k < n; k++) sum += size[k];
+        ix->blocks[b + 1].before = ix->blocks[b].before + sum;
+        ix->known_blocks++;
+    }
+
+    /* Last block starting at or before pos */
+    int lo = 0, hi = ix->known_blocks - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (ix->blocks[mid].before <= pos) lo = mid; else hi = mid - 1;
+    }
+
+    int n = avi_index_block_sizes(ix, lo, size);
+    uint64_t at = ix->blocks[lo].before;
+    for (int k = 0; k < n; k++) {
+        if (pos < at + size[k]) {
+            *start = at;
+            return (lo << AVI_INDEX_BLOCK_SHIFT) + k;
+        }
+        at += size[k];
+    }
+    return -1;
+}
+
+void avi_index_parts(const avi_index_t *ix, const void *data[AVI_INDEX_PARTS],
+                     uint32_t size[AVI_INDEX_PARTS]) {
+    int resident = !ix->paged && ix->count > 0;
+    int blocks = (ix->count + AVI_INDEX_MASK) >> AVI_INDEX_BLOCK_SHIFT;
+
+    data[0] = ix->sizes;
+    size[0] = resident ? ix->count * sizeof(uint16_t) : 0;
+    data[1] = ix->gaps;
+    size[1] = size[0];
+    data[2] = ix->blocks;
+    size[2] = resident ? blocks * sizeof(avi_index_block_t) : 0;
+    data[3] = ix->escs;
+    size[3] = resident ? ix->esc_count * sizeof(avi_index_escape_t) : 0;
+}
+
+/* Heap copy of n bytes (NULL for n == 0 is fine) */
+static void *avi_index_dup(const void *src, uint32_t n) {
+    if (n == 0) return NULL;
+    void *p = malloc(n);
+    if (p) memcpy(p, src, n);
+    return p;
+}
+
+int avi_index_from_parts(avi_index_t *ix, const void *const data[AVI_INDEX_PARTS],
+                         const uint32_t size[AVI_INDEX_PARTS]) {
+    avi_index_init(ix, 0);
+
+    if (size[0] != size[1] || (size[0] % sizeof(uint16_t)) != 0 ||
+        (size[2] % sizeof(avi_index_block_t)) != 0 ||
+        (size[3] % sizeof(avi_index_escape_t)) != 0) {
+        return 0;
+    }
+    int count = size[0] / sizeof(uint16_t);
+    int blocks = (count + AVI_INDEX_MASK) >> AVI_INDEX_BLOCK_SHIFT;
+    if (size[2] != blocks * sizeof(avi_index_block_t)) return 0;
+    if (count == 0) return 1;
+
+    ix->sizes = avi_index_dup(data[0], size[0]);
+    ix->gaps = avi_index_dup(data[1], size[1]);
+    ix->blocks = avi_index_dup(data[2], size[2]);
+    ix->escs = avi_index_dup(data[3], size[3]);
+    if (!ix->sizes || !ix->gaps || !ix->blocks || (size[3] > 0 && !ix->escs)) {
+        avi_index_free(ix);
+        return 0;
+    }
+
+    ix->count = count;
+    ix->cap = count;
+    ix->block_cap = blocks;
+    ix->known_blocks = blocks;
+    ix->esc_count = size[3] / sizeof(avi_index_escape_t);
+    ix->esc_cap = ix->esc_count;
+
+    /* Escape references must stay inside the list */
+    for (int b = 0; b < blocks; b++) {
+        if (ix->blocks[b].esc > ix->esc_count) {
+            avi_index_free(ix);
+            return 0;
+        }
+    }
+
+    uint32_t size_last[AVI_INDEX_BLOCK];
+    int n = avi_index_block_sizes(ix, blocks - 1, size_last);
+    ix->total = ix->blocks[blocks - 1].before;
+    for (int k = 0; k < n; k++) ix->total += size_last[k];
+
+    uint64_t offset;
+    uint32_t sz;
+    if (avi_index_get(ix, count - 1, &offset, &sz)) ix->last_end = offset + sz;
+    return 1;
+}
+
+uint32_t avi_index_memory(const avi_index_t *ix) {
+    return (uint32_t)ix->cap * 2 * sizeof(uint16_t) +
+           (uint32_t)ix->block_cap * sizeof(avi_index_block_t) +
+           ix->esc_cap * sizeof(avi_index_escape_t);
+}
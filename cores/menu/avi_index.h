@@ -0,0 +1,144 @@
+/*
+ * avi_index.h - Compact chunk index for AVI playback
+ *
+ * Holds the file offset and size of every chunk of one stream (video or
+ * audio). Entries are grouped in fixed blocks of AVI_INDEX_BLOCK; each block
+ * keeps one absolute 64-bit anchor offset and every entry only stores two
+ * 16-bit values:
+ *   size - chunk size
+ *   gap  - bytes between the end of the previous entry and this one
+ *          (other streams' chunks and headers in between)
+ * Values that don't fit (0xFFFF and up, or a backwards gap) go to a sparse
+ * escape list (escaped gaps are signed 32-bit). That is 4 bytes per chunk
+ * instead of 8, allocated as the index grows instead of for the worst case.
+ *
+ * Every block also records the stream bytes of all entries before it, so a
+ * byte position (audio seek) is found with a binary search over the blocks
+ * and a walk of at most one block.
+ *
+ * Very long files can use a paged index instead: only the block anchors are
+ * kept and a block's entries are read back from the on-disk index (idx1 or
+ * OpenDML ix##) through a pager callback when playback or a seek needs them.
+ * A paged block's byte total is only known once it has been read, so the
+ * caller can seed known byte positions (e.g. from OpenDML super index
+ * durations) and a byte search then pages from the nearest seed instead of
+ * from the start.
+ */
+
+#ifndef AVI_INDEX_H
+#define AVI_INDEX_H
+
+#include <stdint.h>
+
+#define AVI_INDEX_BLOCK_SHIFT 6
+#define AVI_INDEX_BLOCK       (1 << AVI_INDEX_BLOCK_SHIFT)
+#define AVI_INDEX_ESCAPE      0xFFFF
+
+/* Paged blocks kept decoded at once (sequential playback + one seek target) */
+#define AVI_INDEX_PAGE_SLOTS  2
+
+typedef struct {
+    uint64_t anchor;   /* file offset of the block's first entry (0 if only the pager knows) */
+    uint64_t before;   /* sum of the sizes of all earlier entries (see known_blocks) */
+    uint32_t esc;      /* resident: first escape record of the block */
+    uint32_t src;      /* paged: pager position of the block's first entry */
+} avi_index_block_t;
+
+typedef struct {
+    uint32_t key;      /* entry << 1 | 1 for size, | 0 for gap */
+    uint32_t value;
+} avi_index_escape_t;
+
+typedef struct {
+    int entry;         /* first entry of the stretch, count for the end */
+    uint64_t before;   /* stream bytes before it */
+} avi_index_seed_t;
+
+typedef struct {
+    int block;         /* -1 = empty */
+    uint32_t used;
+    uint64_t offset[AVI_INDEX_BLOCK];
+    uint32_t size[AVI_INDEX_BLOCK];
+} avi_index_page_t;
+
+/* Fill n entries of a paged block starting at pager position src.
+ * Returns number of entries read. */
+typedef int (*avi_index_pager_t)(void *ctx, uint32_t src, int n,
+                                 uint64_t *offset, uint32_t *size);
+
+typedef struct {
+    int count;
+    int cap;
+    uint16_t *sizes;
+    uint16_t *gaps;
+    avi_index_block_t *blocks;
+    int block_cap;
+    avi_index_escape_t *escs;
+    uint32_t esc_count;
+    uint32_t esc_cap;
+    uint64_t last_end;          /* offset + size of the last entry added */
+    uint64_t total;             /* sum of the sizes added with avi_index_add */
+    int known_blocks;           /* leading blocks with a valid 'before' (pager-only
+                                 * blocks get theirs when a byte search reaches them) */
+    /* Paged mode */
+    int paged;
+    avi_index_pager_t pager;
+    void *pager_ctx;
+    avi_index_page_t pages[AVI_INDEX_PAGE_SLOTS];
+    uint32_t page_stamp;
+    avi_index_seed_t *seeds;    /* known byte positions, in entry order */
+    int seed_count;
+    int seed_cap;
+} avi_index_t;
+
+/* Start an empty index. paged: keep only block anchors, read entries
+ * through the pager (see avi_index_set_pager) */
+void avi_index_init(avi_index_t *ix, int paged);
+
+/* Free everything and return to an empty resident index */
+void avi_index_free(avi_index_t *ix);
+
+/* Pager for a paged index; ctx is passed back to it */
+void avi_index_set_pager(avi_index_t *ix, avi_index_pager_t pager, void *ctx);
+
+/* Append an entry. src is the pager position of this entry (paged mode only).
+ * Returns 1 on success, 0 if out of memory. */
+int avi_index_add(avi_index_t *ix, uint64_t offset, uint32_t size, uint32_t src);
+
+/* Append n entries of a paged index that are only known to the pager,
+ * at pager positions src, src + 1, ... (e.g. OpenDML ix## entries).
+ * Returns 1 on success, 0 if out of memory. */
+int avi_index_add_paged(avi_index_t *ix, int n, uint32_t src);
+
+/* Record that entry starts at stream byte position before (entry == count:
+ * the stream is before bytes long). Seeds must be added in entry order.
+ * Returns 1 on success, 0 if out of memory. */
+int avi_index_seed(avi_index_t *ix, int entry, uint64_t before);
+
+/* Release unused capacity once the index is complete */
+void avi_index_finish(avi_index_t *ix);
+
+/* Look up entry i. Returns 1 on success, 0 if out of range or paging failed. */
+int avi_index_get(avi_index_t *ix, int i, uint64_t *offset, uint32_t *size);
+
+/* Entry holding byte pos of the stream's chunk data laid end to end, e.g.
+ * an audio byte position. *start is set to the stream byte position where
+ * that entry begins. Returns -1 if pos is past the end or paging failed. */
+int avi_index_find_byte(avi_index_t *ix, uint64_t pos, uint64_t *start);
+
+/* Raw arrays of a finished resident index (sizes, gaps, blocks, escapes),
+ * e.g. to store it in a cache file. Pointers stay owned by the index. */
+#define AVI_INDEX_PARTS 4
+void avi_index_parts(const avi_index_t *ix, const void *data[AVI_INDEX_PARTS],
+                     uint32_t size[AVI_INDEX_PARTS]);
+
+/* Rebuild a resident index from copies of the arrays returned by
+ * avi_index_parts(). Returns 1 on success, 0 if the sizes don't describe a
+ * valid index or out of memory (ix is left empty). */
+int avi_index_from_parts(avi_index_t *ix, const void *const data[AVI_INDEX_PARTS],
+                         const uint32_t size[AVI_INDEX_PARTS]);
+
+/* Bytes of heap used by the index */
+uint32_t avi_index_memory(const avi_index_t *ix);
+
+#endif /* AVI_INDEX_H */
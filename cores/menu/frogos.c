@@ -45,6 +45,13 @@ static loader_func_t direct_loader = (loader_func_t)LOADER_ADDR;
 #include "image_viewer.h"
 #include "calculator.h"
 #include "filemanager.h"
+#include "jobs.h"
+#include "list_cache.h"
+#include "name_index.h"
+#include "assets.h"
+#include "art_cache.h"
+#include "thumb_gen.h"
+#include "thumb_pak.h"
 
 // Console to core name mapping (from buildcoresworking.sh)
 typedef struct {
@@ -171,6 +178,8 @@ const char* get_core_name_for_console(const char* console_name) {
 #define HISTORY_FILE "/mnt/sda1/game_history.txt"
 #define MAX_RECENT_GAMES 10
 #define INITIAL_ENTRIES_CAPACITY 64
+// Per-frame time for background jobs; rendering takes most of a 30 fps frame
+#define MENU_JOBS_BUDGET_MS 8
 
 // Empty folders cache - avoid rescanning on every navigation
 #define EMPTY_DIRS_CACHE_FILE "/mnt/sda1/configs/frogui_empty_dirs.cache"
@@ -188,7 +197,8 @@ static int header_logo_loaded = 0;
 
 // Forward declarations
 static void rebuild_empty_dirs_cache(void);
-static void show_cache_rebuild_screen(void);
+static void rescan_root_after_cache_rebuild(void);
+static int list_refresh_job(void *ctx);
 
 // v30: Decode header logo from embedded PNG
 static void decode_header_logo(void) {
@@ -301,15 +311,21 @@ static int is_in_empty_cache(const char *folder_name) {
 }
 
 // Rebuild and save empty directories cache by scanning ROMS folder
-static void rebuild_empty_dirs_cache(void) {
-    show_cache_rebuild_screen();
-    empty_dirs_count = 0;
+// Runs as a background job: one platform folder is checked per step, and the
+// root list is refreshed when it finishes
+static DIR *empty_rebuild_dir = NULL;
+
+static int empty_dirs_rebuild_job(void *ctx) {
+    (void)ctx;
 
-    DIR *dir = opendir(ROMS_PATH);
-    if (!dir) return;
+    if (!empty_rebuild_dir) {
+        empty_dirs_count = 0;
+        empty_rebuild_dir = opendir(ROMS_PATH);
+        return empty_rebuild_dir ? JOB_MORE : JOB_DONE;
+    }
 
     struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL && empty_dirs_count < MAX_EMPTY_DIRS) {
+    while ((ent = readdir(empty_rebuild_dir)) != NULL && empty_dirs_count < MAX_EMPTY_DIRS) {
         if (ent->d_name[0] == '.') continue;
         if (strcasecmp(ent->d_name, "frogui") == 0 ||
             strcasecmp(ent->d_name, "saves") == 0 ||
@@ -345,8 +361,10 @@ static void rebuild_empty_dirs_cache(void) {
                 empty_dirs_count++;
             }
         }
+        return JOB_MORE;
     }
-    closedir(dir);
+    closedir(empty_rebuild_dir);
+    empty_rebuild_dir = NULL;
 
     // Save to file
     FILE *fp = fopen(EMPTY_DIRS_CACHE_FILE, "w");
@@ -357,19 +375,30 @@ static void rebuild_empty_dirs_cache(void) {
         fclose(fp);
     }
     xlog("Empty dirs cache: rebuilt with %d entries\n", empty_dirs_count);
+
+    rescan_root_after_cache_rebuild();
+    return JOB_DONE;
+}
+
+static void rebuild_empty_dirs_cache(void) {
+    // Restart if a rebuild is already under way
+    if (empty_rebuild_dir) {
+        closedir(empty_rebuild_dir);
+        empty_rebuild_dir = NULL;
+    }
+    jobs_add(empty_dirs_rebuild_job, NULL);
 }
 
 // Layout constants are now in render.h
 
 // Thumbnail cache
 static Thumbnail current_thumbnail;
-static char cached_thumbnail_path[MAX_PATH_LEN];
 static int thumbnail_cache_valid = 0;
 static int last_selected_index = -1;
+static int art_selected_index = -1;  // Selection the loaded thumbnail/screenshot belong to
 
 // v32: Screenshot cache (game_name.png in same folder as game)
 static Thumbnail current_screenshot;
-static char cached_screenshot_path[MAX_PATH_LEN];
 static int screenshot_cache_valid = 0;
 
 // Text scrolling state
@@ -378,23 +407,39 @@ static int text_scroll_offset = 0;
 static int text_scroll_direction = 1;
 
 // Menu state
+// Entries are small fixed records; their strings live in one pool per
+// listing. Entries of a scanned folder don't store a path at all - it is
+// built from the folder and the name when asked for.
+#define ENTRY_IN_DIR      0xFFFFFFFFu  // path: entry_dir + "/" + name
+#define ENTRY_THUMB_RES   0x01         // thumb is a file name in entry_dir/.res/ (else a full path)
+
 typedef struct {
-    char path[MAX_PATH_LEN];
-    char name[256];
-    int is_dir;
+    uint32_t name;          // Pool offsets
+    uint32_t path;          // ...or ENTRY_IN_DIR
+    uint32_t thumb;
+    uint32_t screenshot;    // File name in entry_dir
+    uint8_t is_dir;
+    uint8_t flags;
     // v44: Cached thumbnail path (avoids repeated filesystem lookups)
     // thumb_checked: 0=not checked, 1=checked and found, -1=checked but not found
-    int thumb_checked;
-    char thumb_path[MAX_PATH_LEN];
+    int8_t thumb_checked;
     // v52: Cached screenshot path (built during directory scan)
     // screenshot_checked: 0=not checked, 1=found, -1=not found
-    int screenshot_checked;
-    char screenshot_path[MAX_PATH_LEN];
+    int8_t screenshot_checked;
 } MenuEntry;
 
+// NUL-terminated strings back to back; offset 0 is always ""
+typedef struct {
+    char *buf;
+    uint32_t used;
+    uint32_t size;
+} StringPool;
+
 static MenuEntry *entries = NULL;
 static int entry_count = 0;
 static int entries_capacity = 0;
+static StringPool entry_pool;
+static uint32_t entry_dir = 0;  // Folder of ENTRY_IN_DIR entries
 static int selected_index = 0;
 static int scroll_offset = 0;
 static char current_path[MAX_PATH_LEN];
@@ -619,15 +664,84 @@ static void ensure_entries_capacity(int required_capacity) {
         return;
     }
 
-    // v44: Zero-initialize new entries (important for thumb_checked cache)
-    if (new_capacity > entries_capacity) {
-        memset(&new_entries[entries_capacity], 0, (new_capacity - entries_capacity) * sizeof(MenuEntry));
-    }
-
     entries = new_entries;
     entries_capacity = new_capacity;
 }
 
+// Add a string to a pool and return its offset (0, the empty string, if out of memory)
+static uint32_t pool_add(StringPool *pool, const char *s) {
+    uint32_t len = strlen(s) + 1;
+    uint32_t need = (pool->used ? pool->used : 1) + len;
+
+    if (need > pool->size) {
+        uint32_t size = pool->size ? pool->size : 4096;
+        while (size < need) size *= 2;
+        char *buf = (char *)realloc(pool->buf, size);
+        if (!buf) return 0;
+        pool->buf = buf;
+        pool->size = size;
+    }
+    if (pool->used == 0) {
+        pool->buf[0] = '\0';
+        pool->used = 1;
+    }
+
+    uint32_t offset = pool->used;
+    memcpy(pool->buf + offset, s, len);
+    pool->used += len;
+    return offset;
+}
+
+static const char *pool_str(const StringPool *pool, uint32_t offset) {
+    return pool->buf ? pool->buf + offset : "";
+}
+
+// Drop all entries and their strings (memory is kept for the next list)
+static void entries_clear(void) {
+    entry_count = 0;
+    entry_pool.used = 0;
+    entry_dir = 0;
+}
+
+// Append an entry with an explicit path
+static void entries_add(const char *name, const char *path, int is_dir) {
+    ensure_entries_capacity(entry_count + 1);
+    if (entry_count >= entries_capacity) return;
+
+    MenuEntry *e = &entries[entry_count++];
+    memset(e, 0, sizeof(*e));
+    e->name = pool_add(&entry_pool, name);
+    e->path = pool_add(&entry_pool, path);
+    e->is_dir = is_dir;
+}
+
+static const char *entry_name(const MenuEntry *e) {
+    return pool_str(&entry_pool, e->name);
+}
+
+// Full path of an entry. Folder entries are built into a buffer that is
+// only valid until the next call.
+static const char *entry_path(const MenuEntry *e) {
+    static char path[MAX_PATH_LEN];
+    if (e->path != ENTRY_IN_DIR) return pool_str(&entry_pool, e->path);
+    snprintf(path, sizeof(path), "%s/%s", pool_str(&entry_pool, entry_dir), entry_name(e));
+    return path;
+}
+
+static void entry_thumb_path(const MenuEntry *e, char *out, size_t size) {
+    if (e->flags & ENTRY_THUMB_RES) {
+        snprintf(out, size, "%s/.res/%s", pool_str(&entry_pool, entry_dir),
+                 pool_str(&entry_pool, e->thumb));
+    } else {
+        snprintf(out, size, "%s", pool_str(&entry_pool, e->thumb));
+    }
+}
+
+static void entry_screenshot_path(const MenuEntry *e, char *out, size_t size) {
+    snprintf(out, size, "%s/%s", pool_str(&entry_pool, entry_dir),
+             pool_str(&entry_pool, e->screenshot));
+}
+
 // Reset navigation state when entering new folder
 static void reset_navigation_state(void) {
     selected_index = 0;
@@ -648,24 +762,6 @@ static retro_input_state_t input_state_cb = NULL;
 static int prev_input[16] = {0};
 static bool game_queued = false;  // Flag to indicate game is queued
 
-// Show a loading screen during cache rebuild
-static void show_cache_rebuild_screen(void) {
-    if (!framebuffer || !video_cb) return;
-
-    // Fill background
-    render_fill_rect(framebuffer, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, theme_bg());
-
-    // Draw centered message
-    const char* msg = "Rebuilding folder cache...";
-    int text_width = font_measure_text(msg);
-    int x = (SCREEN_WIDTH - text_width) / 2;
-    int y = (SCREEN_HEIGHT - FONT_CHAR_HEIGHT) / 2;
-    render_text_pillbox(framebuffer, x, y, msg, theme_header(), theme_bg(), 6);
-
-    // Push frame to display
-    video_cb(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * sizeof(uint16_t));
-}
-
 // Get the base name from a path
 static const char *get_basename(const char *path) {
     const char *base = strrchr(path, '/');
@@ -769,387 +865,272 @@ static void get_scrolling_text(const char *full_name, int is_selected, char *dis
     display_name[copy_len] = '\0';
 }
 
-// Load thumbnail for currently selected item
-static void load_current_thumbnail() {
-    if (selected_index < 0 || selected_index >= entry_count || entry_count == 0) {
-        thumbnail_cache_valid = 0;
-        return;
-    }
-
-    // Only load thumbnails for files, not directories
-    if (entries[selected_index].is_dir) {
-        thumbnail_cache_valid = 0;
-        return;
-    }
+// ============== ARTWORK ==============
+// Thumbnails and screenshots are decoded into the art cache (art_cache.c),
+// already scaled to the size they're drawn at. The selected entry's artwork
+// is shown from there, and art_prefetch_job decodes the rows around it.
 
-    char thumb_path[MAX_PATH_LEN];
-    int use_entry_cache = 0;  // v44: Can we use entry-level path cache?
-
-    // Check if we're in Recent games mode
-    if (strcmp(current_path, "RECENT_GAMES") == 0) {
-        // For recent games, we need to use the full_path from the RecentGame structure
-        const RecentGame* recent_list = recent_games_get_list();
-        int recent_count = recent_games_get_count();
-
-        if (selected_index < recent_count) {
-            const RecentGame *recent_game = &recent_list[selected_index];
-
-            if (recent_game->full_path[0] != '\0') {
-                get_thumbnail_path(recent_game->full_path, thumb_path, sizeof(thumb_path));
-            } else {
-                // No full path available, skip thumbnail
-                thumbnail_cache_valid = 0;
-                return;
-            }
-        } else {
-            // This is the ".." entry, no thumbnail
-            thumbnail_cache_valid = 0;
-            return;
-        }
-    } else if (strcmp(current_path, "FAVORITES") == 0) {
-        // For favorites, we need to use the full_path from the FavoriteGame structure
-        const FavoriteGame* favorites_list = favorites_get_list();
-        int favorites_count = favorites_get_count();
+#define ART_PREFETCH_ROWS 3  // Rows above and below the selection decoded ahead
+#define ART_PREFETCH_SETTLE 8  // Frames the selection holds still before prefetching
 
-        if (selected_index < favorites_count) {
-            const FavoriteGame *favorite_game = &favorites_list[selected_index];
+// v61: Theme screenshot area (start=0 allowed for full-screen). Returns 0 if not configured.
+static int get_screenshot_area(int *x_start, int *y_start, int *width, int *height) {
+    int x0 = gfx_theme_get_screenshot_x_start();
+    int x1 = gfx_theme_get_screenshot_x_end();
+    int y0 = gfx_theme_get_screenshot_y_start();
+    int y1 = gfx_theme_get_screenshot_y_end();
 
-            if (favorite_game->full_path[0] != '\0') {
-                get_thumbnail_path(favorite_game->full_path, thumb_path, sizeof(thumb_path));
-            } else {
-                // No full path available, skip thumbnail
-                thumbnail_cache_valid = 0;
-                return;
-            }
-        } else {
-            // This is the ".." entry, no thumbnail
-            thumbnail_cache_valid = 0;
-            return;
-        }
-    } else {
-        // Regular file browser mode - can use entry-level path cache
-        use_entry_cache = 1;
-
-        // v44: Check entry-level thumbnail path cache first
-        if (entries[selected_index].thumb_checked == -1) {
-            // Already checked and no thumbnail found - skip loading
-            thumbnail_cache_valid = 0;
-            return;
-        }
-
-        if (entries[selected_index].thumb_checked == 1) {
-            // Already discovered - use cached path
-            strncpy(thumb_path, entries[selected_index].thumb_path, sizeof(thumb_path) - 1);
-            thumb_path[sizeof(thumb_path) - 1] = '\0';
-        } else {
-            // Not checked yet - build path for discovery
-            get_thumbnail_path(entries[selected_index].path, thumb_path, sizeof(thumb_path));
-        }
+    if (x0 < 0 || x1 <= 0 || x1 <= x0 ||
+        y0 < 0 || y1 <= 0 || y1 <= y0) {
+        return 0;
     }
+    *x_start = x0;
+    *y_start = y0;
+    *width = x1 - x0;
+    *height = y1 - y0;
+    return 1;
+}
 
-    // Check if we already have this thumbnail loaded in memory
-    if (thumbnail_cache_valid && strcmp(cached_thumbnail_path, thumb_path) == 0) {
-        return; // Already loaded
-    }
+// v42: The theme shows screenshots if it places them, thumbnails otherwise.
+// Sizes the art cache slots for that kind; if this drops the cache, the
+// artwork on screen is gone too.
+static int art_kind(void) {
+    int x, y, w, h;
+    int kind = get_screenshot_area(&x, &y, &w, &h) ? ART_SCREENSHOT : ART_THUMBNAIL;
+    uint32_t pixels = (kind == ART_SCREENSHOT) ? (uint32_t)(w * h) :
+                      THUMBNAIL_MAX_WIDTH * THUMBNAIL_MAX_HEIGHT;
 
-    // Free previous thumbnail
-    if (thumbnail_cache_valid) {
-        free_thumbnail(&current_thumbnail);
+    if (art_cache_set_slot_pixels(pixels)) {
         thumbnail_cache_valid = 0;
+        screenshot_cache_valid = 0;
     }
+    return kind;
+}
 
-    // Try to load new thumbnail
-    if (load_thumbnail(thumb_path, &current_thumbnail)) {
-        strncpy(cached_thumbnail_path, thumb_path, sizeof(cached_thumbnail_path) - 1);
-        cached_thumbnail_path[sizeof(cached_thumbnail_path) - 1] = '\0';
-        thumbnail_cache_valid = 1;
-
-        // v44: Cache the discovered path in entry
-        if (use_entry_cache && entries[selected_index].thumb_checked == 0) {
-            entries[selected_index].thumb_checked = 1;
-            strncpy(entries[selected_index].thumb_path, thumb_path, sizeof(entries[selected_index].thumb_path) - 1);
-            entries[selected_index].thumb_path[sizeof(entries[selected_index].thumb_path) - 1] = '\0';
-        }
-    } else {
-        // v44: Mark as "no thumbnail found" in entry cache
-        if (use_entry_cache && entries[selected_index].thumb_checked == 0) {
-            entries[selected_index].thumb_checked = -1;
-        }
-    }
-}
-
-// v32/v38: Get screenshot base path (without extension)
-static void get_screenshot_base_path(const char *game_path, char *base_path, size_t size) {
-    // Copy the game path
-    strncpy(base_path, game_path, size - 1);
-    base_path[size - 1] = '\0';
-
-    // Find the last dot to remove extension
-    char *dot = strrchr(base_path, '.');
-    if (dot != NULL) {
-        *dot = '\0';  // Remove extension
-    }
-}
-
-// v52: Helper to load screenshot from known path
-static int load_screenshot_from_path(const char *path) {
-    if (!path || path[0] == '\0') return 0;
-
-    uint16_t *img_data = NULL;
-    int img_w = 0, img_h = 0;
-    int loaded = 0;
-
-    // Determine format from extension
-    const char *ext = strrchr(path, '.');
-    if (!ext) return 0;
-
-    if (strcasecmp(ext, ".png") == 0) {
-        loaded = load_png_rgb565(path, &img_data, &img_w, &img_h);
-    } else if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) {
-        loaded = load_jpeg_rgb565(path, &img_data, &img_w, &img_h);
-    } else if (strcasecmp(ext, ".bmp") == 0) {
-        loaded = load_bmp_rgb565(path, &img_data, &img_w, &img_h);
-    } else if (strcasecmp(ext, ".gif") == 0) {
-        loaded = load_gif_rgb565(path, &img_data, &img_w, &img_h);
-    } else if (strcasecmp(ext, ".webp") == 0) {
-        loaded = load_webp_rgb565(path, &img_data, &img_w, &img_h);
-    } else if (strcasecmp(ext, ".rgb565") == 0) {
-        // v68: Support for old .rgb565 format screenshots
-        Thumbnail temp_thumb = {0};
-        if (load_raw_rgb565(path, &temp_thumb)) {
-            // Allocate copy since load_raw_rgb565 uses shared buffer
-            img_data = (uint16_t*)malloc(temp_thumb.width * temp_thumb.height * sizeof(uint16_t));
-            if (img_data) {
-                memcpy(img_data, temp_thumb.data, temp_thumb.width * temp_thumb.height * sizeof(uint16_t));
-                img_w = temp_thumb.width;
-                img_h = temp_thumb.height;
-                loaded = 1;
-            }
-        }
+// Full path of a Recent games / Favorites entry, or NULL
+static const char *art_list_game_path(int index) {
+    if (strcmp(current_path, "RECENT_GAMES") == 0) {
+        if (index < recent_games_get_count()) return recent_games_get_list()[index].full_path;
+    } else if (strcmp(current_path, "FAVORITES") == 0) {
+        if (index < favorites_get_count()) return favorites_get_list()[index].full_path;
     }
+    return NULL;  // ".." entry
+}
 
-    if (loaded) {
-        current_screenshot.data = img_data;
-        current_screenshot.width = img_w;
-        current_screenshot.height = img_h;
-        strncpy(cached_screenshot_path, path, sizeof(cached_screenshot_path) - 1);
-        cached_screenshot_path[sizeof(cached_screenshot_path) - 1] = '\0';
-        screenshot_cache_valid = 1;
-        return 1;
-    }
-    return 0;
+static int art_in_game_list(void) {
+    return strcmp(current_path, "RECENT_GAMES") == 0 || strcmp(current_path, "FAVORITES") == 0;
 }
 
-// v32/v52: Load screenshot for currently selected game
-static void load_current_screenshot() {
-    // Check if screenshot feature is enabled in theme
-    int x_start = gfx_theme_get_screenshot_x_start();
-    int x_end = gfx_theme_get_screenshot_x_end();
-    int y_start = gfx_theme_get_screenshot_y_start();
-    int y_end = gfx_theme_get_screenshot_y_end();
-
-    // If screenshot area not configured, skip loading
-    // v61: Allow start=0 for full-screen, check end > 0 instead
-    if (x_start < 0 || x_end <= 0 || x_end <= x_start ||
-        y_start < 0 || y_end <= 0 || y_end <= y_start) {
-        screenshot_cache_valid = 0;
-        return;
+// Path and format of an entry's thumbnail, ASSET_NONE if it has none
+static asset_format_t art_thumbnail_source(int index, char *path, size_t size) {
+    if (index < 0 || index >= entry_count || entries[index].is_dir) return ASSET_NONE;
+
+    if (art_in_game_list()) {
+        // Recent games and Favorites use the full_path of the stored game
+        const char *game_path = art_list_game_path(index);
+        if (!game_path || game_path[0] == '\0') return ASSET_NONE;
+        return asset_find_thumbnail(game_path, path, size);
     }
 
-    if (selected_index < 0 || selected_index >= entry_count || entry_count == 0) {
-        screenshot_cache_valid = 0;
-        return;
+    // v44: Regular file browser mode - entry-level path cache
+    MenuEntry *e = &entries[index];
+    if (e->thumb_checked == -1) {
+        // Already checked and no thumbnail found
+        return ASSET_NONE;
+    }
+    if (e->thumb_checked == 1) {
+        // Already discovered - use cached path
+        entry_thumb_path(e, path, size);
+        return asset_format_of(path);
     }
 
-    // Only load screenshots for files, not directories
-    if (entries[selected_index].is_dir) {
-        screenshot_cache_valid = 0;
-        return;
+    // Not checked yet - ask the resolver and remember the answer
+    asset_format_t format = asset_find_thumbnail(entry_path(e), path, size);
+    if (format == ASSET_NONE) {
+        e->thumb_checked = -1;
+        return ASSET_NONE;
     }
+    e->thumb = pool_add(&entry_pool, path);
+    e->flags &= ~ENTRY_THUMB_RES;
+    e->thumb_checked = 1;
+    return format;
+}
 
-    // v52: For regular file browser mode - use entry-level cache (FAST!)
-    if (strcmp(current_path, "RECENT_GAMES") != 0 &&
-        strcmp(current_path, "FAVORITES") != 0) {
+// v32/v52: Path and format of an entry's screenshot, ASSET_NONE if it has none
+static asset_format_t art_screenshot_source(int index, char *path, size_t size) {
+    if (index < 0 || index >= entry_count || entries[index].is_dir) return ASSET_NONE;
 
-        // Check entry-level cache first
-        if (entries[selected_index].screenshot_checked == -1) {
-            // Already checked during scan - no screenshot exists
-            screenshot_cache_valid = 0;
-            return;
-        }
+    if (art_in_game_list()) {
+        const char *game_path = art_list_game_path(index);
+        if (!game_path || game_path[0] == '\0') return ASSET_NONE;
+        return asset_find_screenshot(game_path, path, size);
+    }
 
-        if (entries[selected_index].screenshot_checked == 1) {
-            // Screenshot exists - check if already loaded
-            if (screenshot_cache_valid &&
-                strcmp(cached_screenshot_path, entries[selected_index].screenshot_path) == 0) {
-                return; // Already loaded
-            }
+    // v52: Matched while the folder was listed (-1 = no screenshot)
+    if (entries[index].screenshot_checked != 1) return ASSET_NONE;
+    entry_screenshot_path(&entries[index], path, size);
+    return asset_format_of(path);
+}
 
-            // Free previous screenshot
-            if (screenshot_cache_valid && current_screenshot.data) {
-                free(current_screenshot.data);
-                current_screenshot.data = NULL;
-                screenshot_cache_valid = 0;
-            }
+static asset_format_t art_source(int kind, int index, char *path, size_t size) {
+    return (kind == ART_SCREENSHOT) ? art_screenshot_source(index, path, size) :
+                                      art_thumbnail_source(index, path, size);
+}
 
-            // Load from cached path (single file open - FAST!)
-            load_screenshot_from_path(entries[selected_index].screenshot_path);
-            return;
-        }
+// v52/v68: Decode a screenshot. *pixels is *owned (to be freed) or the shared buffer.
+static int decode_screenshot(const char *path, asset_format_t format,
+                             uint16_t **pixels, uint16_t **owned, int *w, int *h) {
+    Thumbnail raw = {0};
 
-        // screenshot_checked == 0 means not yet scanned (shouldn't happen after scan_directory)
-        screenshot_cache_valid = 0;
-        return;
+    *owned = NULL;
+    switch (format) {
+        case ASSET_PNG:  load_png_rgb565(path, owned, w, h); break;
+        case ASSET_JPEG: load_jpeg_rgb565(path, owned, w, h); break;
+        case ASSET_BMP:  load_bmp_rgb565(path, owned, w, h); break;
+        case ASSET_GIF:  load_gif_rgb565(path, owned, w, h); break;
+        case ASSET_WEBP: load_webp_rgb565(path, owned, w, h); break;
+        case ASSET_RGB565:
+            // v68: Support for old .rgb565 format screenshots
+            if (!load_raw_rgb565(path, &raw)) return 0;
+            *pixels = raw.data;
+            *w = raw.width;
+            *h = raw.height;
+            return 1;
+        default: break;
+    }
+    *pixels = *owned;
+    return *owned != NULL;
+}
+
+// Decode artwork into the art cache, scaled to the size it's drawn at
+static int art_decode(int kind, const char *path, asset_format_t format) {
+    if (kind == ART_THUMBNAIL) {
+        Thumbnail full;
+        int w, h;
+        // Packed in .res/thumbs.pak: one seek and one read straight into the
+        // slot. Only .rgb565 files are packed
+        if (format == ASSET_RGB565 && thumb_pak_find(path, &w, &h)) {
+            uint16_t *dst = art_cache_put(ART_THUMBNAIL, path, w, h);
+            if (dst && thumb_pak_read(dst)) return 1;
+            art_cache_drop(ART_THUMBNAIL, path);  // Not left keyed to unread pixels
+        }
+        if (!load_thumbnail(path, format, &full)) return 0;
+        render_thumbnail_fit(full.width, full.height, &w, &h);
+        uint16_t *dst = art_cache_put(ART_THUMBNAIL, path, w, h);
+        if (!dst) return 0;
+        render_scale_thumbnail(&full, dst, w, h);
+        return 1;
     }
 
-    // For Recent/Favorites - use old method (they don't have entry-level cache)
-    char screenshot_path[MAX_PATH_LEN];
+    int x_start, y_start, area_width, area_height;
+    uint16_t *img, *owned;
+    int img_width = 0, img_height = 0;
+    if (!get_screenshot_area(&x_start, &y_start, &area_width, &area_height)) return 0;
+    if (!decode_screenshot(path, format, &img, &owned, &img_width, &img_height)) return 0;
+    if (img_width <= 0 || img_height <= 0) {
+        free(owned);
+        return 0;
+    }
 
-    if (strcmp(current_path, "RECENT_GAMES") == 0) {
-        const RecentGame* recent_list = recent_games_get_list();
-        int recent_count = recent_games_get_count();
+    // Calculate scaling to fit in the area while maintaining aspect ratio
+    int scale_w = (area_width * 100) / img_width;
+    int scale_h = (area_height * 100) / img_height;
+    int scale = (scale_w < scale_h) ? scale_w : scale_h;
 
-        if (selected_index < recent_count) {
-            const RecentGame *recent_game = &recent_list[selected_index];
-            if (recent_game->full_path[0] != '\0') {
-                get_screenshot_base_path(recent_game->full_path, screenshot_path, sizeof(screenshot_path));
-            } else {
-                screenshot_cache_valid = 0;
-                return;
-            }
-        } else {
-            screenshot_cache_valid = 0;
-            return;
-        }
-    } else if (strcmp(current_path, "FAVORITES") == 0) {
-        const FavoriteGame* favorites_list = favorites_get_list();
-        int favorites_count = favorites_get_count();
+    // Calculate displayed size
+    int disp_width = (img_width * scale) / 100;
+    int disp_height = (img_height * scale) / 100;
 
-        if (selected_index < favorites_count) {
-            const FavoriteGame *favorite_game = &favorites_list[selected_index];
-            if (favorite_game->full_path[0] != '\0') {
-                get_screenshot_base_path(favorite_game->full_path, screenshot_path, sizeof(screenshot_path));
-            } else {
-                screenshot_cache_valid = 0;
-                return;
-            }
-        } else {
-            screenshot_cache_valid = 0;
-            return;
-        }
-    } else {
-        screenshot_cache_valid = 0;
-        return;
+    uint16_t *dst = art_cache_put(ART_SCREENSHOT, path, disp_width, disp_height);
+    if (!dst) {
+        free(owned);
+        return 0;
     }
 
-    // Check if we already have this screenshot cached
-    if (screenshot_cache_valid && strcmp(cached_screenshot_path, screenshot_path) == 0) {
-        return; // Already cached
-    }
+    // Simple nearest-neighbor scaling
+    for (int dy = 0; dy < disp_height; dy++) {
+        int src_y = (dy * img_height) / disp_height;
+        if (src_y >= img_height) src_y = img_height - 1;
 
-    // Free previous screenshot
-    if (screenshot_cache_valid) {
-        if (current_screenshot.data) {
-            free(current_screenshot.data);
-            current_screenshot.data = NULL;
+        for (int dx = 0; dx < disp_width; dx++) {
+            int src_x = (dx * img_width) / disp_width;
+            if (src_x >= img_width) src_x = img_width - 1;
+            *dst++ = img[src_y * img_width + src_x];
         }
-        screenshot_cache_valid = 0;
     }
+    free(owned);
+    return 1;
+}
+
+// The selected entry's artwork of kind, from the art cache. With decode
+// set, a miss is decoded now.
+static int art_show(int kind, Thumbnail *art, int decode) {
+    char path[MAX_PATH_LEN];
+    asset_format_t format = art_source(kind, selected_index, path, sizeof(path));
+    if (format == ASSET_NONE) return 0;
 
-    // Try to load screenshot - try multiple extensions (old method for Recent/Favorites)
-    uint16_t *img_data = NULL;
-    int img_w = 0, img_h = 0;
-    int loaded = 0;
-    char try_path[MAX_PATH_LEN];
+    if (art_cache_get(kind, path, &art->data, &art->width, &art->height)) return 1;
+    return decode && art_decode(kind, path, format) &&
+           art_cache_get(kind, path, &art->data, &art->width, &art->height);
+}
 
-    const char *exts[] = { ".png", ".jpg", ".jpeg", ".bmp", ".gif", ".webp", NULL };
+// Load thumbnail for currently selected item
+static void load_current_thumbnail() {
+    art_selected_index = selected_index;
+    thumbnail_cache_valid = (art_kind() == ART_THUMBNAIL) &&
+                            art_show(ART_THUMBNAIL, &current_thumbnail, 1);
+}
 
-    for (int e = 0; exts[e] && !loaded; e++) {
-        snprintf(try_path, sizeof(try_path), "%s%s", screenshot_path, exts[e]);
-        if (exts[e][1] == 'p' && exts[e][2] == 'n') {
-            loaded = load_png_rgb565(try_path, &img_data, &img_w, &img_h);
-        } else if (exts[e][1] == 'j') {
-            loaded = load_jpeg_rgb565(try_path, &img_data, &img_w, &img_h);
-        } else if (exts[e][1] == 'b') {
-            loaded = load_bmp_rgb565(try_path, &img_data, &img_w, &img_h);
-        } else if (exts[e][1] == 'g') {
-            loaded = load_gif_rgb565(try_path, &img_data, &img_w, &img_h);
-        } else if (exts[e][1] == 'w') {
-            loaded = load_webp_rgb565(try_path, &img_data, &img_w, &img_h);
-        }
-    }
+// v32/v52: Load screenshot for currently selected game
+static void load_current_screenshot() {
+    screenshot_cache_valid = (art_kind() == ART_SCREENSHOT) &&
+                             art_show(ART_SCREENSHOT, &current_screenshot, 1);
+}
 
-    if (loaded) {
-        current_screenshot.data = img_data;
-        current_screenshot.width = img_w;
-        current_screenshot.height = img_h;
-        strncpy(cached_screenshot_path, screenshot_path, sizeof(cached_screenshot_path) - 1);
-        cached_screenshot_path[sizeof(cached_screenshot_path) - 1] = '\0';
-        screenshot_cache_valid = 1;
-    }
+// Drop remembered folder listings and decoded artwork (the files may have changed)
+static void art_forget(void) {
+    asset_forget();
+    thumb_pak_close();
+    art_cache_clear();
+    thumbnail_cache_valid = 0;
+    screenshot_cache_valid = 0;
 }
 
-// v32: Render screenshot in theme-defined area with proper aspect ratio
+// v32: Render screenshot in theme-defined area, centered (the art cache
+// already scaled it to fit, keeping the aspect ratio)
 static void render_screenshot(uint16_t *framebuffer) {
     if (!screenshot_cache_valid || !current_screenshot.data) return;
 
-    int x_start = gfx_theme_get_screenshot_x_start();
-    int x_end = gfx_theme_get_screenshot_x_end();
-    int y_start = gfx_theme_get_screenshot_y_start();
-    int y_end = gfx_theme_get_screenshot_y_end();
+    int x_start, y_start, area_width, area_height;
+    if (!get_screenshot_area(&x_start, &y_start, &area_width, &area_height)) return;
 
-    // v61: Allow start=0 for full-screen
-    if (x_start < 0 || x_end <= 0 || x_end <= x_start ||
-        y_start < 0 || y_end <= 0 || y_end <= y_start) {
-        return;
-    }
-
-    int area_width = x_end - x_start;
-    int area_height = y_end - y_start;
+    int x_end = x_start + area_width;
+    int y_end = y_start + area_height;
     int img_width = current_screenshot.width;
     int img_height = current_screenshot.height;
 
-    if (img_width <= 0 || img_height <= 0) return;
-
-    // Calculate scaling to fit in the area while maintaining aspect ratio
-    int scale_w = (area_width * 100) / img_width;
-    int scale_h = (area_height * 100) / img_height;
-    int scale = (scale_w < scale_h) ? scale_w : scale_h;
-
-    // Calculate displayed size
-    int disp_width = (img_width * scale) / 100;
-    int disp_height = (img_height * scale) / 100;
-
     // Center in the designated area
-    int offset_x = x_start + (area_width - disp_width) / 2;
-    int offset_y = y_start + (area_height - disp_height) / 2;
+    int offset_x = x_start + (area_width - img_width) / 2;
+    int offset_y = y_start + (area_height - img_height) / 2;
 
     // v61: Fill screenshot area with black first (for letterboxing)
     for (int y = y_start; y < y_end && y < SCREEN_HEIGHT; y++) {
         for (int x = x_start; x < x_end && x < SCREEN_WIDTH; x++) {
-            if (x >= 0 && y >= 0) {
-                framebuffer[y * SCREEN_WIDTH + x] = 0x0000;  // Black
-            }
+            framebuffer[y * SCREEN_WIDTH + x] = 0x0000;  // Black
         }
     }
 
-    // Simple nearest-neighbor scaling
-    for (int dy = 0; dy < disp_height && (offset_y + dy) < SCREEN_HEIGHT; dy++) {
-        int src_y = (dy * img_height) / disp_height;
-        if (src_y >= img_height) src_y = img_height - 1;
-
-        for (int dx = 0; dx < disp_width && (offset_x + dx) < SCREEN_WIDTH; dx++) {
-            int src_x = (dx * img_width) / disp_width;
-            if (src_x >= img_width) src_x = img_width - 1;
-
-            int screen_x = offset_x + dx;
-            int screen_y = offset_y + dy;
+    for (int dy = 0; dy < img_height; dy++) {
+        int screen_y = offset_y + dy;
+        if (screen_y < 0 || screen_y >= SCREEN_HEIGHT) continue;
 
-            if (screen_x >= 0 && screen_x < SCREEN_WIDTH &&
-                screen_y >= 0 && screen_y < SCREEN_HEIGHT) {
-                framebuffer[screen_y * SCREEN_WIDTH + screen_x] =
-                    current_screenshot.data[src_y * img_width + src_x];
-            }
+        // Clip to the screen and copy the row
+        int x0 = offset_x < 0 ? -offset_x : 0;
+        int x1 = (offset_x + img_width > SCREEN_WIDTH) ? SCREEN_WIDTH - offset_x : img_width;
+        if (x1 > x0) {
+            memcpy(&framebuffer[screen_y * SCREEN_WIDTH + offset_x + x0],
+                   &current_screenshot.data[dy * img_width + x0],
+                   (x1 - x0) * sizeof(uint16_t));
         }
     }
 }
@@ -1169,16 +1150,9 @@ static inline int is_directory_fast(const char *path, unsigned char d_type) {
     return 0;
 }
 
-// v36: Comparison function to sort entries alphabetically by name (case-insensitive)
-int compare_entries(const void *a, const void *b) {
-    const MenuEntry *entry_a = (const MenuEntry *)a;
-    const MenuEntry *entry_b = (const MenuEntry *)b;
-    return strcasecmp(entry_a->name, entry_b->name);  // v36: Case-insensitive sort
-}
-
 // Show recent games list
 static void show_recent_games(void) {
-    entry_count = 0;
+    entries_clear();
     reset_navigation_state();
     render_set_in_platform_menu(false);  // Recent games is a game list, not platform menu
 
@@ -1188,6 +1162,7 @@ static void show_recent_games(void) {
     
     // Clear thumbnail/screenshot cache when switching to recent games mode
     thumbnail_cache_valid = 0;
+    art_forget();  // Folders are listed again, the files may have changed
     screenshot_cache_valid = 0;
 
     const RecentGame* recent_list = recent_games_get_list();
@@ -1195,27 +1170,18 @@ static void show_recent_games(void) {
 
     if (recent_count == 0) {
         // Only show back entry if no recent games
-        ensure_entries_capacity(entry_count + 1);
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
+        entries_add("..", ROMS_PATH, 1);
     } else {
         // Add recent games first
         ensure_entries_capacity(entry_count + recent_count + 1);
         for (int i = 0; i < recent_count; i++) {
-            strncpy(entries[entry_count].name, recent_list[i].display_name, sizeof(entries[entry_count].name) - 1);
-            snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", recent_list[i].core_name, recent_list[i].game_name);
-            entries[entry_count].is_dir = 0;
-            entry_count++;
+            char game_path[MAX_PATH_LEN];
+            snprintf(game_path, sizeof(game_path), "%s;%s", recent_list[i].core_name, recent_list[i].game_name);
+            entries_add(recent_list[i].display_name, game_path, 0);
         }
 
         // Add back entry after recent games
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
+        entries_add("..", ROMS_PATH, 1);
     }
     
     // Load thumbnail/screenshot for initially selected item AND reset last_selected_index to prevent duplicate loading
@@ -1226,7 +1192,7 @@ static void show_recent_games(void) {
 
 // Show favorites
 static void show_favorites(void) {
-    entry_count = 0;
+    entries_clear();
     reset_navigation_state();
     render_set_in_platform_menu(false);  // Favorites is a game list, not platform menu
 
@@ -1236,6 +1202,7 @@ static void show_favorites(void) {
 
     // Clear thumbnail/screenshot cache when switching to favorites mode
     thumbnail_cache_valid = 0;
+    art_forget();  // Folders are listed again, the files may have changed
     screenshot_cache_valid = 0;
 
     const FavoriteGame* favorites_list = favorites_get_list();
@@ -1243,27 +1210,18 @@ static void show_favorites(void) {
 
     if (favorites_count == 0) {
         // Only show back entry if no favorites
-        ensure_entries_capacity(entry_count + 1);
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
+        entries_add("..", ROMS_PATH, 1);
     } else {
         // Add favorites first
         ensure_entries_capacity(entry_count + favorites_count + 1);
         for (int i = 0; i < favorites_count; i++) {
-            strncpy(entries[entry_count].name, favorites_list[i].display_name, sizeof(entries[entry_count].name) - 1);
-            snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", favorites_list[i].core_name, favorites_list[i].game_name);
-            entries[entry_count].is_dir = 0;
-            entry_count++;
+            char game_path[MAX_PATH_LEN];
+            snprintf(game_path, sizeof(game_path), "%s;%s", favorites_list[i].core_name, favorites_list[i].game_name);
+            entries_add(favorites_list[i].display_name, game_path, 0);
         }
 
         // Add back entry after favorites
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
+        entries_add("..", ROMS_PATH, 1);
     }
 
     // Load thumbnail/screenshot for initially selected item AND reset last_selected_index to prevent duplicate loading
@@ -1274,7 +1232,7 @@ static void show_favorites(void) {
 
 // Show tools menu
 static void show_tools_menu(void) {
-    entry_count = 0;
+    entries_clear();
     reset_navigation_state();
     render_set_in_platform_menu(false);  // Tools is not the platform menu
 
@@ -1286,44 +1244,29 @@ static void show_tools_menu(void) {
     thumbnail_cache_valid = 0;
     screenshot_cache_valid = 0;
 
-    // Ensure we have space for 6 entries
-    ensure_entries_capacity(6);
+    // Ensure we have space for 7 entries
+    ensure_entries_capacity(7);
 
     // Add Calculator entry
-    strncpy(entries[entry_count].name, "Calculator", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "CALCULATOR", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Calculator", "CALCULATOR", 1);
 
     // Add File Manager entry (v76)
-    strncpy(entries[entry_count].name, "File Manager", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "FILEMANAGER", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("File Manager", "FILEMANAGER", 1);
 
     // Add Hotkeys entry
-    strncpy(entries[entry_count].name, "Hotkeys", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "HOTKEYS", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Hotkeys", "HOTKEYS", 1);
 
     // Add Credits entry
-    strncpy(entries[entry_count].name, "Credits", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "CREDITS", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Credits", "CREDITS", 1);
+
+    // Add thumbnail pre-generation entry
+    entries_add("Prepare thumbnails", "THUMBGEN", 1);
 
     // Add Utils entry
-    strncpy(entries[entry_count].name, "Utils", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "UTILS", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Utils", "UTILS", 1);
 
     // Add back entry (v76: "Back" instead of "..")
-    strncpy(entries[entry_count].name, "Back", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Back", ROMS_PATH, 1);
 
     // Load thumbnail for initially selected item AND reset last_selected_index to prevent duplicate loading
     load_current_thumbnail();
@@ -1332,7 +1275,7 @@ static void show_tools_menu(void) {
 
 // Show utils menu with js2000 files
 static void show_utils_menu(void) {
-    entry_count = 0;
+    entries_clear();
     reset_navigation_state();
     
     // Set current_path for utils mode
@@ -1358,29 +1301,17 @@ static void show_utils_menu(void) {
 
             struct stat st;
             if (stat(full_path, &st) == 0) {
-                ensure_entries_capacity(entry_count + 1);
-                strncpy(entries[entry_count].name, ent->d_name, sizeof(entries[entry_count].name) - 1);
-                strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
-                entries[entry_count].is_dir = S_ISDIR(st.st_mode);
-                entry_count++;
+                entries_add(ent->d_name, full_path, S_ISDIR(st.st_mode));
             }
         }
         closedir(dir);
     }
 
     // Add "Rebuild folder cache" option
-    ensure_entries_capacity(entry_count + 1);
-    strncpy(entries[entry_count].name, "Rebuild folder cache", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "REBUILD_CACHE", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 0;
-    entry_count++;
+    entries_add("Rebuild folder cache", "REBUILD_CACHE", 0);
 
     // Add back entry (v76: "Back" instead of "..")
-    ensure_entries_capacity(entry_count + 1);
-    strncpy(entries[entry_count].name, "Back", sizeof(entries[entry_count].name) - 1);
-    strncpy(entries[entry_count].path, "TOOLS", sizeof(entries[entry_count].path) - 1);
-    entries[entry_count].is_dir = 1;
-    entry_count++;
+    entries_add("Back", "TOOLS", 1);
 
     // Load thumbnail for initially selected item
     load_current_thumbnail();
@@ -1396,7 +1327,7 @@ static void show_hotkeys_screen(void) {
     // Clear thumbnail/screenshot cache and entries for hotkeys mode
     thumbnail_cache_valid = 0;
     screenshot_cache_valid = 0;
-    entry_count = 0;
+    entries_clear();
     reset_navigation_state();
 }
 
@@ -1409,8 +1340,34 @@ static void show_credits_screen(void) {
     // Clear thumbnail/screenshot cache and entries for credits mode
     thumbnail_cache_valid = 0;
     screenshot_cache_valid = 0;
-    entry_count = 0;
+    entries_clear();
+    reset_navigation_state();
+}
+
+// Background job: convert .res/ artwork into pre-scaled .rgb565 files
+static int thumb_gen_job(void *ctx) {
+    (void)ctx;
+    return thumb_gen_step() ? JOB_MORE : JOB_DONE;
+}
+
+// Show thumbnail pre-generation screen and start (or continue) the run
+static void show_thumb_gen_screen(void) {
+    strncpy(current_path, "THUMBGEN", sizeof(current_path) - 1);
+    current_path[sizeof(current_path) - 1] = '\0';
+
+    thumbnail_cache_valid = 0;
+    screenshot_cache_valid = 0;
+    entries_clear();
     reset_navigation_state();
+
+    thumb_gen_start(ROMS_PATH);
+    jobs_add(thumb_gen_job, NULL);
+}
+
+// Leave the thumbnail screen; a run in progress stops and continues next time
+static void close_thumb_gen_screen(void) {
+    jobs_cancel(thumb_gen_job);
+    thumb_gen_stop();
 }
 
 // Scan directory and populate entries
@@ -1446,80 +1403,75 @@ static void update_current_platform(const char *path) {
     }
 }
 
-// v52: Temp storage for screenshot filenames during directory scan
-#define MAX_SCREENSHOTS_CACHE 512
-static char screenshot_cache_names[MAX_SCREENSHOTS_CACHE][256];
-static int screenshot_cache_count = 0;
-
-// v52: Temp storage for thumbnail filenames during directory scan
-#define MAX_THUMBNAILS_CACHE 512
-static char thumbnail_cache_names[MAX_THUMBNAILS_CACHE][256];
-static int thumbnail_cache_count = 0;
-static int thumbnail_res_exists = 0;  // Does .res/ directory exist?
+// ============== FOLDER LISTINGS ==============
+// A listing is built into its own array by ListBuild, a few directory
+// entries per step, and then swapped in as the menu's entries. Platform
+// folders are stored in the listing cache (list_cache.c): entering one that
+// is cached is a single file read, and a stale listing is shown while it is
+// rebuilt in the background.
 
-// v52: Check if filename (without extension) matches image name (without extension)
-// Used for both screenshots and thumbnails
-static int filename_base_matches(const char *game_name, const char *image_name) {
-    // Get base name of game (without extension)
-    int game_len = strlen(game_name);
-    const char *game_ext = strrchr(game_name, '.');
-    if (game_ext) game_len = game_ext - game_name;
+#define LIST_SYNC_STEP  256  // readdir entries per step when the user is waiting
+#define LIST_JOB_STEP   32   // readdir entries per background job step
 
-    // Get base name of image (without extension)
-    int img_len = strlen(image_name);
-    const char *img_ext = strrchr(image_name, '.');
-    if (img_ext) img_len = img_ext - image_name;
-
-    // Compare lengths first
-    if (game_len != img_len) return 0;
-
-    // Case-insensitive compare
-    for (int i = 0; i < game_len; i++) {
-        char c1 = game_name[i];
-        char c2 = image_name[i];
-        if (c1 >= 'A' && c1 <= 'Z') c1 += 32;
-        if (c2 >= 'A' && c2 <= 'Z') c2 += 32;
-        if (c1 != c2) return 0;
-    }
-    return 1;
-}
-
-static void scan_directory(const char *path) {
+typedef struct {
+    char path[MAX_PATH_LEN];
+    int is_root;
     DIR *dir;
+    MenuEntry *list;
+    int count;
+    int capacity;
+    StringPool pool;
+    uint32_t dir_name;   // path in the pool (entry_dir once installed)
+    uint32_t raw_count;  // Non-hidden entries in the folder and .res/ (cache stamp)
+    name_index_t shots;  // v52: Screenshot files seen in the folder, matched to games by base name
+    name_index_t thumbs; // v52: .rgb565 files in .res/
+} ListBuild;
+
+static MenuEntry *list_build_push(ListBuild *b, const char *name, int is_dir) {
+    if (b->count >= b->capacity) {
+        int new_capacity = b->capacity ? b->capacity * 2 : INITIAL_ENTRIES_CAPACITY;
+        MenuEntry *list = (MenuEntry *)realloc(b->list, new_capacity * sizeof(MenuEntry));
+        if (!list) return NULL;
+        b->list = list;
+        b->capacity = new_capacity;
+    }
+
+    MenuEntry *e = &b->list[b->count++];
+    memset(e, 0, sizeof(*e));
+    e->name = pool_add(&b->pool, name);
+    e->path = ENTRY_IN_DIR;
+    e->is_dir = is_dir;
+    e->thumb_checked = -1;  // v52: Will update after scan if found
+    e->screenshot_checked = -1;  // v52: Will update after scan if found
+    return e;
+}
+
+// Returns 0 if the folder can't be opened (the listing is then just "..")
+static int list_build_start(ListBuild *b, const char *path) {
+    memset(b, 0, sizeof(*b));
+    strncpy(b->path, path, sizeof(b->path) - 1);
+    b->is_root = (strcmp(path, ROMS_PATH) == 0);
+    b->dir_name = pool_add(&b->pool, path);
+
+    // Add parent directory entry if not at root (its path is the folder itself)
+    if (!b->is_root) {
+        MenuEntry *e = list_build_push(b, "..", 1);
+        if (e) e->path = b->dir_name;
+    }
+
+    b->dir = opendir(path);
+    return b->dir != NULL;
+}
+
+// Read up to max directory entries. Returns 1 while there are more.
+static int list_build_step(ListBuild *b, int max) {
     struct dirent *ent;
 
-    entry_count = 0;
-    screenshot_cache_count = 0;  // v52: Reset screenshot cache
-    reset_navigation_state();
-
-    // Update current platform for per-platform theme backgrounds
-    update_current_platform(path);
-
-    // Store whether we're at root for recent games insertion later
-    int is_root = (strcmp(path, ROMS_PATH) == 0);
-
-    // Set render mode: platform menu (root ROMS) vs game list (inside folders)
-    render_set_in_platform_menu(is_root);
-
-    // Add parent directory entry if not at root
-    if (!is_root) {
-        ensure_entries_capacity(entry_count + 1);
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, path, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entries[entry_count].thumb_checked = -1;  // v52: No thumbnail for ".."
-        entries[entry_count].screenshot_checked = -1;  // v52: No screenshot for ".."
-        entry_count++;
-    }
-
-    dir = opendir(path);
-    if (!dir) {
-        return;
-    }
+    if (!b->dir) return 0;
 
-    // Collect all entries in a single pass - optimized
-    while ((ent = readdir(dir)) != NULL) {
+    while (max-- > 0 && (ent = readdir(b->dir)) != NULL) {
         if (ent->d_name[0] == '.') continue;  // Skip hidden files
+        b->raw_count++;
 
         // Skip frogui, and saves folders
         if (strcasecmp(ent->d_name, "frogui") == 0 || strcasecmp(ent->d_name, "saves") == 0 || strcasecmp(ent->d_name, "save") == 0) {
@@ -1533,18 +1485,18 @@ static void scan_directory(const char *path) {
         int entry_type = ent->d_type;
 
         char full_path[MAX_PATH_LEN];
-        snprintf(full_path, sizeof(full_path), "%s/%s", path, entry_name);
+        snprintf(full_path, sizeof(full_path), "%s/%s", b->path, entry_name);
 
         // Fast path: use d_type if available, avoid stat() calls
         int is_dir = is_directory_fast(full_path, entry_type);
 
         // Skip files if in root ROMS directory (only show folders there)
-        if (is_root && !is_dir) {
+        if (b->is_root && !is_dir) {
             continue;
         }
 
         // v24: Apply display options filtering (only in platform folders, not root)
-        if (!is_root) {
+        if (!b->is_root) {
             // Filter directories based on display mode
             if (is_dir && !display_opts_should_show_dirs()) {
                 continue;
@@ -1562,11 +1514,7 @@ static void scan_directory(const char *path) {
                             strcasecmp(ext, ".webp") == 0 ||
                             strcasecmp(ext, ".rgb565") == 0)) {
                     // v52: Store screenshot filename for later matching
-                    if (screenshot_cache_count < MAX_SCREENSHOTS_CACHE) {
-                        strncpy(screenshot_cache_names[screenshot_cache_count], entry_name, 255);
-                        screenshot_cache_names[screenshot_cache_count][255] = '\0';
-                        screenshot_cache_count++;
-                    }
+                    name_index_add(&b->shots, entry_name);
                     continue;
                 }
             }
@@ -1581,7 +1529,7 @@ static void scan_directory(const char *path) {
         }
 
         // Skip empty directories in root ROMS directory (use cache for speed)
-        if (is_root && is_dir) {
+        if (b->is_root && is_dir) {
             const char *hide_empty = settings_get_value("frogui_hide_empty");
             if (!hide_empty || strcmp(hide_empty, "true") == 0) {
                 // Load cache on first use (default to hiding if setting not found)
@@ -1592,136 +1540,383 @@ static void scan_directory(const char *path) {
             }
         }
 
-        // Ensure we have space for one more entry
-        ensure_entries_capacity(entry_count + 1);
+        list_build_push(b, entry_name, is_dir);
+    }
 
-        // Add directories first, then files
-        if (is_dir) {
-            // Add directory entry
-            strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
-            strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
-            entries[entry_count].is_dir = 1;
-            entries[entry_count].thumb_checked = -1;  // v52: No thumbnails for dirs
-            entries[entry_count].screenshot_checked = -1;  // v52: No screenshots for dirs
-            entry_count++;
-        } else {
-            // Add file entry
-            strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
-            strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
-            entries[entry_count].is_dir = 0;
-            entries[entry_count].thumb_checked = -1;  // v52: Will update after scan if found
-            entries[entry_count].screenshot_checked = -1;  // v52: Will update after scan if found
-            entry_count++;
-        }
+    if (max >= 0) {
+        // Close the directory after reading
+        closedir(b->dir);
+        b->dir = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// qsort has no context argument
+static const ListBuild *list_sort_build;
+
+// v36: Sort alphabetically by name (case-insensitive)
+static int compare_entries(const void *a, const void *b) {
+    const ListBuild *lb = list_sort_build;
+    return strcasecmp(pool_str(&lb->pool, lb->list[*(const uint32_t *)a].name),
+                      pool_str(&lb->pool, lb->list[*(const uint32_t *)b].name));
+}
+
+// Sort through an index array, then put the records in that order
+static void list_build_sort(ListBuild *b) {
+    if (b->count < 2) return;
+
+    uint32_t *order = (uint32_t *)malloc(b->count * sizeof(uint32_t));
+    MenuEntry *sorted = (MenuEntry *)malloc(b->capacity * sizeof(MenuEntry));
+    if (!order || !sorted) {
+        free(order);
+        free(sorted);
+        return;
     }
 
-    // Close the directory after reading
-    closedir(dir);
+    for (int i = 0; i < b->count; i++) order[i] = i;
+    list_sort_build = b;
+    qsort(order, b->count, sizeof(uint32_t), compare_entries);
 
+    for (int i = 0; i < b->count; i++) sorted[i] = b->list[order[i]];
+    free(b->list);
+    b->list = sorted;
+    free(order);
+}
+
+// Match thumbnails and screenshots, then sort
+static void list_build_finish(ListBuild *b) {
     // v52: Scan .res/ subdirectory for thumbnails (if it exists)
-    thumbnail_cache_count = 0;
-    thumbnail_res_exists = 0;
-    if (!is_root) {
+    if (!b->is_root) {
         char res_path[MAX_PATH_LEN];
-        snprintf(res_path, sizeof(res_path), "%s/.res", path);
+        snprintf(res_path, sizeof(res_path), "%s/.res", b->path);
         DIR *res_dir = opendir(res_path);
         if (res_dir) {
-            thumbnail_res_exists = 1;
             struct dirent *res_ent;
-            while ((res_ent = readdir(res_dir)) != NULL && thumbnail_cache_count < MAX_THUMBNAILS_CACHE) {
+            while ((res_ent = readdir(res_dir)) != NULL) {
                 if (res_ent->d_name[0] == '.') continue;
+                b->raw_count++;
                 // Check for .rgb565 extension
                 const char *ext = strrchr(res_ent->d_name, '.');
                 if (ext && strcasecmp(ext, ".rgb565") == 0) {
-                    strncpy(thumbnail_cache_names[thumbnail_cache_count], res_ent->d_name, 255);
-                    thumbnail_cache_names[thumbnail_cache_count][255] = '\0';
-                    thumbnail_cache_count++;
+                    name_index_add(&b->thumbs, res_ent->d_name);
                 }
             }
             closedir(res_dir);
         }
     }
 
-    // v52: Match thumbnails to game entries (fast in-memory lookup)
-    // Only if .res/ directory exists and has thumbnails
-    if (!is_root && thumbnail_res_exists && thumbnail_cache_count > 0) {
-        for (int i = 0; i < entry_count; i++) {
-            if (entries[i].is_dir) continue;  // Skip directories
-
-            // Look for matching thumbnail in cache
-            for (int t = 0; t < thumbnail_cache_count; t++) {
-                if (filename_base_matches(entries[i].name, thumbnail_cache_names[t])) {
-                    // Found matching thumbnail - build full path
-                    snprintf(entries[i].thumb_path, MAX_PATH_LEN, "%s/.res/%s",
-                             path, thumbnail_cache_names[t]);
-                    entries[i].thumb_checked = 1;
-                    break;
-                }
+    // v52: Match thumbnails and screenshots to game entries, one hash lookup
+    // per game and kind. If not found, *_checked stays -1 (initialized value)
+    if (!b->is_root && (name_index_count(&b->thumbs) > 0 || name_index_count(&b->shots) > 0)) {
+        for (int i = 0; i < b->count; i++) {
+            MenuEntry *e = &b->list[i];
+            if (e->is_dir) continue;  // Skip directories
+
+            const char *thumb = name_index_find(&b->thumbs, pool_str(&b->pool, e->name));
+            if (thumb) {
+                // Found matching thumbnail - keep its name, the path is <folder>/.res/<name>
+                e->thumb = pool_add(&b->pool, thumb);
+                e->flags |= ENTRY_THUMB_RES;
+                e->thumb_checked = 1;
             }
-            // If not found, thumb_checked stays -1 (initialized value)
-        }
-    }
 
-    // v52: Match screenshots to game entries (fast in-memory lookup)
-    if (!is_root && screenshot_cache_count > 0) {
-        for (int i = 0; i < entry_count; i++) {
-            if (entries[i].is_dir) continue;  // Skip directories
-
-            // Look for matching screenshot in cache
-            for (int s = 0; s < screenshot_cache_count; s++) {
-                if (filename_base_matches(entries[i].name, screenshot_cache_names[s])) {
-                    // Found matching screenshot - build full path
-                    snprintf(entries[i].screenshot_path, MAX_PATH_LEN, "%s/%s",
-                             path, screenshot_cache_names[s]);
-                    entries[i].screenshot_checked = 1;
-                    break;
-                }
+            const char *shot = name_index_find(&b->shots, pool_str(&b->pool, e->name));
+            if (shot) {
+                // Found matching screenshot - keep its name, it sits next to the game
+                e->screenshot = pool_add(&b->pool, shot);
+                e->screenshot_checked = 1;
             }
-            // If not found, screenshot_checked stays -1 (initialized value)
         }
     }
 
+    // The image names are now in the entry pool
+    name_index_free(&b->thumbs);
+    name_index_free(&b->shots);
+
     // Sort all entries alphabetically by name
-    qsort(entries, entry_count, sizeof(MenuEntry), compare_entries);
+    list_build_sort(b);
+}
+
+static void list_build_free(ListBuild *b) {
+    if (b->dir) {
+        closedir(b->dir);
+        b->dir = NULL;
+    }
+    free(b->list);
+    free(b->pool.buf);
+    name_index_free(&b->thumbs);
+    name_index_free(&b->shots);
+    b->list = NULL;
+    b->count = b->capacity = 0;
+    memset(&b->pool, 0, sizeof(b->pool));
+}
+
+// Make the built listing the menu's entries (the old ones' memory goes to the builder)
+static void list_build_install(ListBuild *b) {
+    MenuEntry *old_list = entries;
+    int old_capacity = entries_capacity;
+    StringPool old_pool = entry_pool;
+
+    entries = b->list;
+    entry_count = b->count;
+    entries_capacity = b->capacity;
+    entry_pool = b->pool;
+    entry_dir = b->dir_name;
+
+    b->list = old_list;
+    b->count = 0;
+    b->capacity = old_capacity;
+    b->pool = old_pool;
+    list_build_free(b);
+}
+
+// Display filters a listing was built with, so changing them invalidates it
+static uint32_t list_filter_sig(void) {
+    const DisplayOptions *opts = display_opts_get();
+    uint32_t h = 2166136261u;
+    h = (h ^ (uint32_t)opts->mode) * 16777619u;
+    h = (h ^ (uint32_t)opts->disk1_only) * 16777619u;
+    for (int i = 0; i < opts->pattern_count && i < MAX_DISPLAY_PATTERNS; i++) {
+        for (const char *p = opts->patterns[i]; *p && p < opts->patterns[i] + MAX_PATTERN_LEN; p++) {
+            h = (h ^ (uint8_t)*p) * 16777619u;
+        }
+        h = (h ^ '|') * 16777619u;
+    }
+    return h;
+}
+
+static void list_save_cache(const ListBuild *b) {
+    lc_stamp_t stamp;
+    lc_writer_t w;
+
+    if (!lc_stamp_dir(b->path, list_filter_sig(), &stamp)) return;
+    stamp.raw_count = b->raw_count;
+
+    lc_writer_init(&w);
+    for (int i = 0; i < b->count; i++) {
+        const MenuEntry *m = &b->list[i];
+        lc_entry_t e;
+        e.flags = m->is_dir ? LC_DIR : 0;
+        e.name = pool_str(&b->pool, m->name);
+        e.thumb = (m->thumb_checked == 1) ? pool_str(&b->pool, m->thumb) : NULL;
+        e.shot = (m->screenshot_checked == 1) ? pool_str(&b->pool, m->screenshot) : NULL;
+        if (e.thumb) e.flags |= LC_THUMB;
+        if (e.shot) e.flags |= LC_SHOT;
+        if (!lc_writer_add(&w, &e)) {
+            lc_writer_free(&w);
+            return;
+        }
+    }
+    lc_save(b->path, &stamp, &w);
+    lc_writer_free(&w);
+}
 
-    // Add Recent games at the very top if in root directory
-    if (is_root) {
-        // Ensure we have space for 4 more entries (Recent games, Favorites, Random game, Tools)
-        ensure_entries_capacity(entry_count + 4);
+// Background refresh of the folder on screen: count its entries against the
+// cached stamp, and rebuild the listing if they differ (or if the cached
+// listing was already known to be stale)
+static struct {
+    char path[MAX_PATH_LEN];
+    uint32_t expect_count;
+    int stage;          // 0 = counting folder, 1 = counting .res/, 2 = rebuilding
+    DIR *dir;
+    uint32_t count;
+    ListBuild build;
+} list_refresh;
+
+static void list_refresh_cancel(void) {
+    jobs_cancel(list_refresh_job);
+    if (list_refresh.dir) {
+        closedir(list_refresh.dir);
+        list_refresh.dir = NULL;
+    }
+    list_build_free(&list_refresh.build);
+}
+
+static void list_refresh_start(const char *path, uint32_t expect_count, int stale) {
+    list_refresh_cancel();
+    strncpy(list_refresh.path, path, sizeof(list_refresh.path) - 1);
+    list_refresh.path[sizeof(list_refresh.path) - 1] = '\0';
+    list_refresh.expect_count = expect_count;
+    list_refresh.stage = stale ? 2 : 0;
+    list_refresh.count = 0;
+    jobs_add(list_refresh_job, NULL);
+}
+
+// Swap the rebuilt listing in, keeping the selected entry
+static void list_refresh_install(ListBuild *b) {
+    char selected_name[256] = "";
+    int old_index = selected_index;
+    if (selected_index >= 0 && selected_index < entry_count) {
+        strncpy(selected_name, entry_name(&entries[selected_index]), sizeof(selected_name) - 1);
+        selected_name[sizeof(selected_name) - 1] = '\0';
+    }
+
+    list_build_install(b);
+
+    // Same folder, so the name identifies the entry
+    int found = 0;
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entry_name(&entries[i]), selected_name) == 0) {
+            selected_index = i;
+            found = 1;
+            break;
+        }
+    }
+    if (!found) {
+        selected_index = (old_index < entry_count) ? old_index : entry_count - 1;
+        if (selected_index < 0) selected_index = 0;
+    }
+    if (!found || selected_index != old_index) {
+        last_selected_index = -1;
+        art_selected_index = -1;
+    }
+}
 
-        // Shift all entries down by 1 to make room for Recent games at index 0
-        for (int i = entry_count; i > 0; i--) {
-            entries[i] = entries[i - 1];
+static int list_refresh_job(void *ctx) {
+    (void)ctx;
+    struct dirent *ent;
+
+    if (list_refresh.stage < 2) {
+        if (!list_refresh.dir) {
+            char res_path[MAX_PATH_LEN];
+            if (list_refresh.stage == 0) {
+                list_refresh.dir = opendir(list_refresh.path);
+                if (!list_refresh.dir) return JOB_DONE;
+            } else {
+                snprintf(res_path, sizeof(res_path), "%s/.res", list_refresh.path);
+                list_refresh.dir = opendir(res_path);
+            }
+        }
+        for (int n = 0; list_refresh.dir && n < LIST_JOB_STEP * 4; n++) {
+            if ((ent = readdir(list_refresh.dir)) == NULL) {
+                closedir(list_refresh.dir);
+                list_refresh.dir = NULL;
+                break;
+            }
+            if (ent->d_name[0] != '.') list_refresh.count++;
         }
+        if (list_refresh.dir) return JOB_MORE;
+        if (list_refresh.stage == 0) {
+            list_refresh.stage = 1;
+            return JOB_MORE;
+        }
+        if (list_refresh.count == list_refresh.expect_count) return JOB_DONE;
+        xlog("Listing cache: %s changed (%u -> %u entries), rebuilding\n", list_refresh.path,
+             (unsigned)list_refresh.expect_count, (unsigned)list_refresh.count);
+        list_refresh.stage = 2;
+    }
+
+    ListBuild *b = &list_refresh.build;
+    if (!b->list && !b->dir) {
+        list_build_start(b, list_refresh.path);
+        return JOB_MORE;
+    }
+    if (list_build_step(b, LIST_JOB_STEP)) return JOB_MORE;
+
+    list_build_finish(b);
+    list_save_cache(b);
+    if (strcmp(current_path, b->path) == 0) {
+        list_refresh_install(b);
+    }
+    list_build_free(b);
+    return JOB_DONE;
+}
+
+// Fill entries from the listing cache. Returns 0 if there is no usable
+// listing (missing, or built with other display filters).
+static int list_load_cache(const char *path) {
+    lc_list_t l;
+    lc_stamp_t now;
+    lc_entry_t e;
+
+    if (!lc_load(path, &l)) return 0;
+    if (!lc_stamp_dir(path, list_filter_sig(), &now) || l.stamp.filter_sig != now.filter_sig) {
+        lc_close(&l);
+        return 0;
+    }
 
-        // Insert Recent games at the top
-        strncpy(entries[0].name, "Recent games", sizeof(entries[0].name) - 1);
-        strncpy(entries[0].path, "RECENT_GAMES", sizeof(entries[0].path) - 1);
-        entries[0].is_dir = 1;
-        entry_count++;
+    entries_clear();
+    ensure_entries_capacity((int)l.count);
+    if (entries_capacity < (int)l.count) {
+        lc_close(&l);
+        return 0;
+    }
+    entry_dir = pool_add(&entry_pool, path);
 
-        // Shift entries down by 1 more to make room for Favorites
-        for (int i = entry_count; i > 1; i--) {
-            entries[i] = entries[i - 1];
+    while (lc_next(&l, &e) && entry_count < (int)l.count) {
+        MenuEntry *m = &entries[entry_count++];
+        memset(m, 0, sizeof(*m));
+        m->name = pool_add(&entry_pool, e.name);
+        // ".." points at the folder itself, like scan_directory builds it
+        m->path = (strcmp(e.name, "..") == 0) ? entry_dir : ENTRY_IN_DIR;
+        m->is_dir = (e.flags & LC_DIR) ? 1 : 0;
+        m->thumb_checked = -1;
+        m->screenshot_checked = -1;
+        if (e.thumb) {
+            m->thumb = pool_add(&entry_pool, e.thumb);
+            m->flags |= ENTRY_THUMB_RES;
+            m->thumb_checked = 1;
+        }
+        if (e.shot) {
+            m->screenshot = pool_add(&entry_pool, e.shot);
+            m->screenshot_checked = 1;
         }
+    }
+
+    // Changed since it was cached: show it now, rebuild behind it
+    int stale = !lc_stamp_fresh(&l.stamp, &now);
+    list_refresh_start(path, l.stamp.raw_count, stale);
+    lc_close(&l);
+    return 1;
+}
+
+static void scan_directory(const char *path) {
+    // A refresh of the folder we're leaving is no longer wanted
+    list_refresh_cancel();
+    art_forget();
 
-        // Insert Favorites at position 1 (right after Recent games)
-        strncpy(entries[1].name, "Favorites", sizeof(entries[1].name) - 1);
-        strncpy(entries[1].path, "FAVORITES", sizeof(entries[1].path) - 1);
-        entries[1].is_dir = 1;
-        entry_count++;
+    entries_clear();
+    reset_navigation_state();
+
+    // Update current platform for per-platform theme backgrounds
+    update_current_platform(path);
 
-        // Shift entries down by 1 more to make room for Random Game
-        for (int i = entry_count; i > 2; i--) {
-            entries[i] = entries[i - 1];
+    // Store whether we're at root for recent games insertion later
+    int is_root = (strcmp(path, ROMS_PATH) == 0);
+
+    // Set render mode: platform menu (root ROMS) vs game list (inside folders)
+    render_set_in_platform_menu(is_root);
+
+    // Platform folders: cached listing if there is one, otherwise read the
+    // folder now and cache the result
+    if (is_root || !list_load_cache(path)) {
+        ListBuild b;
+        if (list_build_start(&b, path)) {
+            while (list_build_step(&b, LIST_SYNC_STEP)) {}
+            list_build_finish(&b);
+            if (!is_root) list_save_cache(&b);
         }
+        list_build_install(&b);
+    }
 
-        // Insert Random Game at position 2 (right after Favorites)
-        strncpy(entries[2].name, "Random game", sizeof(entries[2].name) - 1);
-        strncpy(entries[2].path, "RANDOM_GAME", sizeof(entries[2].path) - 1);
-        entries[2].is_dir = 1;
-        entry_count++;
+    // Add Recent games at the very top if in root directory
+    if (is_root) {
+        // Recent games, Favorites and Random game go first: shift the list once
+        ensure_entries_capacity(entry_count + 3);
+        if (entries_capacity >= entry_count + 3) {
+            memmove(&entries[3], &entries[0], entry_count * sizeof(MenuEntry));
+            entry_count += 3;
 
+            static const char *const special_names[3] = { "Recent games", "Favorites", "Random game" };
+            static const char *const special_paths[3] = { "RECENT_GAMES", "FAVORITES", "RANDOM_GAME" };
+            for (int i = 0; i < 3; i++) {
+                memset(&entries[i], 0, sizeof(MenuEntry));
+                entries[i].name = pool_add(&entry_pool, special_names[i]);
+                entries[i].path = pool_add(&entry_pool, special_paths[i]);
+                entries[i].is_dir = 1;
+            }
+        }
     }
 
     // Defer thumbnail loading to first render for faster boot
@@ -1729,6 +1924,28 @@ static void scan_directory(const char *path) {
     thumbnail_cache_valid = 0;
     screenshot_cache_valid = 0;
     last_selected_index = -1;  // Force load on first render
+    art_selected_index = -1;
+}
+
+// Called when the empty dirs cache job finishes: if the platform list is on
+// screen, list it again with the new cache, keeping the selected folder
+static void rescan_root_after_cache_rebuild(void) {
+    if (strcmp(current_path, ROMS_PATH) != 0) return;
+
+    char selected_name[256] = "";
+    if (selected_index >= 0 && selected_index < entry_count) {
+        strncpy(selected_name, entry_name(&entries[selected_index]), sizeof(selected_name) - 1);
+        selected_name[sizeof(selected_name) - 1] = '\0';
+    }
+
+    scan_directory(current_path);
+
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entry_name(&entries[i]), selected_name) == 0) {
+            selected_index = i;
+            break;
+        }
+    }
 }
 
 // Render settings menu
@@ -1891,6 +2108,99 @@ static void render_credits_screen() {
     font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, legend_x, legend_y, legend, COLOR_LEGEND);
 }
 
+// Render thumbnail pre-generation screen
+static void render_thumb_gen_screen() {
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, "PREPARE THUMBNAILS", COLOR_HEADER);
+
+    int start_y = 50;
+    int line_height = 24;
+    char line[300];
+
+    if (thumb_gen_running()) {
+        snprintf(line, sizeof(line), "Working on: %s", thumb_gen_folder());
+    } else if (thumb_gen_finished()) {
+        snprintf(line, sizeof(line), "All folders done");
+    } else {
+        snprintf(line, sizeof(line), "Stopped");
+    }
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, start_y, line, COLOR_TEXT);
+
+    snprintf(line, sizeof(line), "Converted: %d", thumb_gen_converted());
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, start_y + line_height, line, COLOR_TEXT);
+
+    snprintf(line, sizeof(line), "Failed: %d", thumb_gen_failed());
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, start_y + line_height * 2, line, COLOR_TEXT);
+
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, start_y + line_height * 4, "Leaving stops, the next visit", COLOR_TEXT);
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, start_y + line_height * 5, "continues where it left off.", COLOR_TEXT);
+
+    // Draw legend
+    const char *legend = " B - BACK ";
+    int legend_y = SCREEN_HEIGHT - 24;
+    int legend_width = font_measure_text(legend);
+    int legend_x = SCREEN_WIDTH - legend_width - 12;
+
+    render_rounded_rect(framebuffer, legend_x - 4, legend_y - 2, legend_width + 8, 20, 10, COLOR_LEGEND_BG);
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, legend_x, legend_y, legend, COLOR_LEGEND);
+}
+
+// Background job: load the selected entry's thumbnail and screenshot once
+// the selection has held still for a frame, so holding UP/DOWN through a
+// list doesn't decode every image on the way
+static int selection_art_job(void *ctx) {
+    static int settle_index = -1;
+    (void)ctx;
+
+    if (settle_index != selected_index) {
+        settle_index = selected_index;
+        return JOB_WAIT;
+    }
+    load_current_thumbnail();
+    load_current_screenshot();
+    return JOB_DONE;
+}
+
+// Background job: decode the artwork of the rows around the selection into
+// the art cache, one image per step, rows in the direction the list is
+// moving first, so the next steps through the list find them decoded.
+// Nothing is decoded until the selection has held still for
+// ART_PREFETCH_SETTLE frames: while it keeps moving, the frame time goes
+// to input and the selected entry's own art, not to rows it passes by
+static int art_prefetch_job(void *ctx) {
+    static int center = -1;
+    static int direction = 1;
+    static int step = 0;
+    static int settle = 0;
+    (void)ctx;
+
+    if (center != selected_index) {
+        direction = (selected_index < center) ? -1 : 1;
+        center = selected_index;
+        step = 0;
+        settle = ART_PREFETCH_SETTLE;
+    }
+    if (settle > 0) {
+        settle--;
+        return JOB_WAIT;
+    }
+
+    int kind = art_kind();
+    while (step < 2 * ART_PREFETCH_ROWS) {
+        // 1..ART_PREFETCH_ROWS rows ahead, then as many behind
+        int row = (step < ART_PREFETCH_ROWS) ? step + 1 : ART_PREFETCH_ROWS - step - 1;
+        int index = center + row * direction;
+        step++;
+
+        char path[MAX_PATH_LEN];
+        asset_format_t format = art_source(kind, index, path, sizeof(path));
+        if (format == ASSET_NONE || art_cache_has(kind, path)) continue;
+
+        art_decode(kind, path, format);
+        return JOB_MORE;
+    }
+    return JOB_DONE;
+}
+
 // Render the menu using modular render system
 static void render_menu() {
     render_clear_screen_gfx(framebuffer);
@@ -1938,6 +2248,12 @@ static void render_menu() {
         return;
     }
 
+    // Thumbnail pre-generation progress
+    if (strcmp(current_path, "THUMBGEN") == 0) {
+        render_thumb_gen_screen();
+        return;
+    }
+
     // v62: Header drawing moved after overlay application (see below)
 
     // Get visible items count (respects gfx_theme layout if active)
@@ -1952,9 +2268,18 @@ static void render_menu() {
 
     // Load and display thumbnail for selected item FIRST (background layer)
     // Only reload if selection changed
+    // Artwork already in the art cache shows at once. Anything else is
+    // decoded in selection_art_job; until it lands no art is shown, rather
+    // than the previous entry's
     if (last_selected_index != selected_index) {
-        load_current_thumbnail();
-        load_current_screenshot();  // v32: Load screenshot too
+        int kind = art_kind();
+        art_selected_index = selected_index;
+        thumbnail_cache_valid = (kind == ART_THUMBNAIL) && art_show(kind, &current_thumbnail, 0);
+        screenshot_cache_valid = (kind == ART_SCREENSHOT) && art_show(kind, &current_screenshot, 0);
+        if (!thumbnail_cache_valid && !screenshot_cache_valid) {
+            jobs_add(selection_art_job, NULL);
+        }
+        jobs_add(art_prefetch_job, NULL);
         last_selected_index = selected_index;
         // Reset scrolling state for new selection
         text_scroll_frame_counter = 0;
@@ -1962,18 +2287,16 @@ static void render_menu() {
         text_scroll_direction = 1;
     }
 
-    // v42: Only show thumbnail if screenshot is NOT configured in theme
-    // Screenshot system takes priority (theme-controlled position)
-    // v61: Allow start=0 for full-screen, check end > 0 instead
-    int screenshot_enabled = (gfx_theme_get_screenshot_x_end() > 0 &&
-                              gfx_theme_get_screenshot_x_end() > gfx_theme_get_screenshot_x_start());
+    // v42: Only one kind is loaded (see art_kind): a thumbnail if the theme
+    // doesn't place screenshots
+    int art_current = (art_selected_index == selected_index);
 
-    if (!screenshot_enabled && thumbnail_cache_valid) {
+    if (thumbnail_cache_valid && art_current) {
         render_thumbnail(framebuffer, &current_thumbnail);
     }
 
     // v32: Render screenshot in theme-defined area (if configured)
-    if (screenshot_cache_valid) {
+    if (screenshot_cache_valid && art_current) {
         render_screenshot(framebuffer);
     }
 
@@ -2049,7 +2372,7 @@ static void render_menu() {
     for (int i = scroll_offset; i < entry_count && i < scroll_offset + visible_items; i++) {
         // Get display name (with scrolling for selected item)
         char display_name[MAX_FILENAME_DISPLAY_LEN + 4];
-        get_scrolling_text(entries[i].name, (i == selected_index), display_name, sizeof(display_name));
+        get_scrolling_text(entry_name(&entries[i]), (i == selected_index), display_name, sizeof(display_name));
 
         // Check if this item is favorited
         int is_favorited = 0;
@@ -2062,8 +2385,8 @@ static void render_menu() {
             strcmp(current_path, "HOTKEYS") != 0 &&
             strcmp(current_path, "CREDITS") != 0) {
             const char *core_name = get_basename(current_path);
-            const char *filename_path = strrchr(entries[i].path, '/');
-            const char *filename = filename_path ? filename_path + 1 : entries[i].name;
+            const char *filename_path = strrchr(entry_path(&entries[i]), '/');
+            const char *filename = filename_path ? filename_path + 1 : entry_name(&entries[i]);
             is_favorited = favorites_is_favorited(core_name, filename);
         }
 
@@ -2164,10 +2487,10 @@ static void pick_random_game(void) {
         int valid_console_count = 0;
         for (int i = 0; i < entry_count; i++) {
             if (entries[i].is_dir &&
-                strcmp(entries[i].path, "RECENT_GAMES") != 0 &&
-                strcmp(entries[i].path, "FAVORITES") != 0 &&
-                strcmp(entries[i].path, "RANDOM_GAME") != 0 &&
-                strcmp(entries[i].path, "TOOLS") != 0) {
+                strcmp(entry_path(&entries[i]), "RECENT_GAMES") != 0 &&
+                strcmp(entry_path(&entries[i]), "FAVORITES") != 0 &&
+                strcmp(entry_path(&entries[i]), "RANDOM_GAME") != 0 &&
+                strcmp(entry_path(&entries[i]), "TOOLS") != 0) {
                 valid_console_count++;
             }
         }
@@ -2183,12 +2506,12 @@ static void pick_random_game(void) {
         int console_idx = 0;
         for (int i = 0; i < entry_count; i++) {
             if (entries[i].is_dir &&
-                strcmp(entries[i].path, "RECENT_GAMES") != 0 &&
-                strcmp(entries[i].path, "FAVORITES") != 0 &&
-                strcmp(entries[i].path, "RANDOM_GAME") != 0 &&
-                strcmp(entries[i].path, "TOOLS") != 0) {
+                strcmp(entry_path(&entries[i]), "RECENT_GAMES") != 0 &&
+                strcmp(entry_path(&entries[i]), "FAVORITES") != 0 &&
+                strcmp(entry_path(&entries[i]), "RANDOM_GAME") != 0 &&
+                strcmp(entry_path(&entries[i]), "TOOLS") != 0) {
                 if (console_idx == random_console) {
-                    strncpy(current_path, entries[i].path, sizeof(current_path) - 1);
+                    strncpy(current_path, entry_path(&entries[i]), sizeof(current_path) - 1);
                     break;
                 }
                 console_idx++;
@@ -2201,7 +2524,7 @@ static void pick_random_game(void) {
         // Count files (not directories, not ..)
         int file_count = 0;
         for (int i = 0; i < entry_count; i++) {
-            if (!entries[i].is_dir && strcmp(entries[i].name, "..") != 0) {
+            if (!entries[i].is_dir && strcmp(entry_name(&entries[i]), "..") != 0) {
                 file_count++;
             }
         }
@@ -2214,11 +2537,11 @@ static void pick_random_game(void) {
         int random_file = rand() % file_count;
         int file_idx = 0;
         for (int i = 0; i < entry_count; i++) {
-            if (!entries[i].is_dir && strcmp(entries[i].name, "..") != 0) {
+            if (!entries[i].is_dir && strcmp(entry_name(&entries[i]), "..") != 0) {
                 if (file_idx == random_file) {
                     const char *core_name = get_basename(current_path);
-                    const char *filename_path = strrchr(entries[i].path, '/');
-                    const char *filename = filename_path ? filename_path + 1 : entries[i].name;
+                    const char *filename_path = strrchr(entry_path(&entries[i]), '/');
+                    const char *filename = filename_path ? filename_path + 1 : entry_name(&entries[i]);
 
                     sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename);
                     sprintf((char *)ptr_gs_run_game_name, "%s", filename);
@@ -2228,7 +2551,7 @@ static void pick_random_game(void) {
                         *dot_position = '\0';
                     }
 
-                    recent_games_add(core_name, filename, entries[i].path);
+                    recent_games_add(core_name, filename, entry_path(&entries[i]));
                     game_queued = true;
                     return;
                 }
@@ -2244,7 +2567,7 @@ static void pick_random_game(void) {
 // v44: Helper to open file browser for a section with appropriate config
 static void open_section_browser(MainSection section) {
     strncpy(current_path, "MAIN_MENU", sizeof(current_path) - 1);
-    entry_count = 0;
+    entries_clear();
     switch(section) {
         case SECTION_VIDEOS:
             vb_open_with_config("/mnt/sda1/VIDEOS", VB_FILTER_VIDEOS);
@@ -2531,7 +2854,7 @@ static void handle_input() {
             // Find first entry starting with this letter (case insensitive)
             // v79: Also track last entry that comes before this letter
             for (int i = 0; i < entry_count; i++) {
-                char entry_first = entries[i].name[0];
+                char entry_first = entry_name(&entries[i])[0];
                 if (entry_first >= 'a' && entry_first <= 'z') {
                     entry_first = entry_first - 'a' + 'A'; // Convert to uppercase
                 }
@@ -2775,7 +3098,7 @@ static void handle_input() {
         // Handle removing from favorites when in FAVORITES view
         if (strcmp(current_path, "FAVORITES") == 0) {
             // Don't allow removing the ".." back entry
-            if (!entry->is_dir && strcmp(entry->name, "..") != 0) {
+            if (!entry->is_dir && strcmp(entry_name(entry), "..") != 0) {
                 // Remove this favorite by index
                 favorites_remove_by_index(selected_index);
 
@@ -2807,11 +3130,11 @@ static void handle_input() {
 
             // Get core name and filename
             const char *core_name = get_basename(current_path);
-            const char *filename_path = strrchr(entry->path, '/');
-            const char *filename = filename_path ? filename_path + 1 : entry->name;
+            const char *filename_path = strrchr(entry_path(entry), '/');
+            const char *filename = filename_path ? filename_path + 1 : entry_name(entry);
 
             // Toggle favorite
-            favorites_toggle(core_name, filename, entry->path);
+            favorites_toggle(core_name, filename, entry_path(entry));
         }
     }
 
@@ -2820,7 +3143,7 @@ static void handle_input() {
     int on_filemanager = 0;
     if (entry_count > 0 && selected_index < entry_count && !header_selected) {
         MenuEntry *entry = &entries[selected_index];
-        if (entry->is_dir && strcmp(entry->path, "FILEMANAGER") == 0) {
+        if (entry->is_dir && strcmp(entry_path(entry), "FILEMANAGER") == 0) {
             on_filemanager = 1;
         }
     }
@@ -2872,7 +3195,7 @@ static void handle_input() {
         // v43: Reset header_selected when navigating
         header_selected = 0;
 
-        if (strcmp(entry->name, "..") == 0) {
+        if (strcmp(entry_name(entry), "..") == 0) {
             // Go to parent directory
             char *last_slash = strrchr(current_path, '/');
             if (last_slash && last_slash != current_path) {
@@ -2886,7 +3209,7 @@ static void handle_input() {
 
                 // Find the directory we just left and restore selection to it
                 for (int i = 0; i < entry_count; i++) {
-                    if (strcmp(entries[i].name, prev_dir) == 0) {
+                    if (strcmp(entry_name(&entries[i]), prev_dir) == 0) {
                         selected_index = i;
                         // Update scroll offset to keep selection visible
                         if (selected_index < scroll_offset) {
@@ -2900,42 +3223,45 @@ static void handle_input() {
             }
         } else if (entry->is_dir) {
             // Enter directory
-            if (strcmp(entry->path, "RECENT_GAMES") == 0) {
+            if (strcmp(entry_path(entry), "RECENT_GAMES") == 0) {
                 // Show recent games list
                 show_recent_games();
                 strncpy(current_path, "RECENT_GAMES", sizeof(current_path) - 1);
-            } else if (strcmp(entry->path, "FAVORITES") == 0) {
+            } else if (strcmp(entry_path(entry), "FAVORITES") == 0) {
                 // Show favorites list
                 show_favorites();
                 strncpy(current_path, "FAVORITES", sizeof(current_path) - 1);
-            } else if (strcmp(entry->path, "RANDOM_GAME") == 0) {
+            } else if (strcmp(entry_path(entry), "RANDOM_GAME") == 0) {
                 // Pick and launch a random game
                 pick_random_game();
                 return;
-            } else if (strcmp(entry->path, "TOOLS") == 0) {
+            } else if (strcmp(entry_path(entry), "TOOLS") == 0) {
                 // Show tools menu
                 show_tools_menu();
                 strncpy(current_path, "TOOLS", sizeof(current_path) - 1);
-            } else if (strcmp(entry->path, "CALCULATOR") == 0) {
+            } else if (strcmp(entry_path(entry), "CALCULATOR") == 0) {
                 // Open calculator
                 calc_open();
-            } else if (strcmp(entry->path, "FILEMANAGER") == 0) {
+            } else if (strcmp(entry_path(entry), "FILEMANAGER") == 0) {
                 // Open file manager (v76)
                 fm_open();
-            } else if (strcmp(entry->path, "HOTKEYS") == 0) {
+            } else if (strcmp(entry_path(entry), "HOTKEYS") == 0) {
                 // Show hotkeys screen
                 show_hotkeys_screen();
                 strncpy(current_path, "HOTKEYS", sizeof(current_path) - 1);
-            } else if (strcmp(entry->path, "CREDITS") == 0) {
+            } else if (strcmp(entry_path(entry), "CREDITS") == 0) {
                 // Show credits screen
                 show_credits_screen();
                 strncpy(current_path, "CREDITS", sizeof(current_path) - 1);
-            } else if (strcmp(entry->path, "UTILS") == 0) {
+            } else if (strcmp(entry_path(entry), "THUMBGEN") == 0) {
+                // Convert thumbnails to pre-scaled .rgb565
+                show_thumb_gen_screen();
+            } else if (strcmp(entry_path(entry), "UTILS") == 0) {
                 // Show utils menu
                 show_utils_menu();
                 strncpy(current_path, "UTILS", sizeof(current_path) - 1);
             } else {
-                strncpy(current_path, entry->path, sizeof(current_path) - 1);
+                strncpy(current_path, entry_path(entry), sizeof(current_path) - 1);
 
                 // v24: Load display options when entering a platform folder
                 // Check if we're entering a direct child of ROMS_PATH (a platform folder)
@@ -2957,11 +3283,16 @@ static void handle_input() {
             // File selected - try to launch it
             const char *core_name;
             const char *filename;
+            char game_path[MAX_PATH_LEN];
+
+            // Entries keep their strings in the shared pool: work on a copy
+            strncpy(game_path, entry_path(entry), sizeof(game_path) - 1);
+            game_path[sizeof(game_path) - 1] = '\0';
 
             // Check if we're in Utils
             if (strcmp(current_path, "UTILS") == 0) {
                 // Handle "Rebuild folder cache" action
-                if (strcmp(entry->path, "REBUILD_CACHE") == 0) {
+                if (strcmp(entry_path(entry), "REBUILD_CACHE") == 0) {
                     rebuild_empty_dirs_cache();
                     // Go back to ROMS root after rebuild
                     strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
@@ -2970,9 +3301,9 @@ static void handle_input() {
                 }
 
                 // Launch selected file with js2000 core using format: corename;full_path
-                sprintf((char *)ptr_gs_run_game_file, "js2000;js2000;%s.gba", entry->name);
+                sprintf((char *)ptr_gs_run_game_file, "js2000;js2000;%s.gba", entry_name(entry));
                 // Don't set ptr_gs_run_folder - inherit from menu core for savestates to work
-                sprintf((char *)ptr_gs_run_game_name, "%s", entry->name);
+                sprintf((char *)ptr_gs_run_game_name, "%s", entry_name(entry));
 
                 // Remove extension from game name
                 char *dot_position = strrchr(ptr_gs_run_game_name, '.');
@@ -2986,11 +3317,11 @@ static void handle_input() {
             
             // Check if we're in Recent games
             if (strcmp(current_path, "RECENT_GAMES") == 0) {
-                // Parse core_name;game_name from entry->path
-                char *separator = strchr(entry->path, ';');
+                // Parse core_name;game_name from the entry path
+                char *separator = strchr(game_path, ';');
                 if (separator) {
                     *separator = '\0';
-                    core_name = entry->path;
+                    core_name = game_path;
                     filename = separator + 1;
 
                     // For recent games, get the full_path from the RecentGame structure
@@ -3012,11 +3343,11 @@ static void handle_input() {
                     return; // Invalid format
                 }
             } else if (strcmp(current_path, "FAVORITES") == 0) {
-                // Parse core_name;game_name from entry->path
-                char *separator = strchr(entry->path, ';');
+                // Parse core_name;game_name from the entry path
+                char *separator = strchr(game_path, ';');
                 if (separator) {
                     *separator = '\0';
-                    core_name = entry->path;
+                    core_name = game_path;
                     filename = separator + 1;
 
                     // For favorites, get the full_path from the FavoriteGame structure
@@ -3040,11 +3371,11 @@ static void handle_input() {
             } else {
                 // Extract core name from parent directory
                 core_name = get_basename(current_path);
-                const char *filename_path = strrchr(entry->path, '/');
-                filename = filename_path ? filename_path + 1 : entry->name;
+                const char *filename_path = strrchr(game_path, '/');
+                filename = filename_path ? filename_path + 1 : entry_name(entry);
 
                 // Add to recent history - use full entry path
-                recent_games_add(core_name, filename, entry->path);
+                recent_games_add(core_name, filename, game_path);
             }
 
             sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename); // TODO: Replace second core_name with full directory (besides /mnt/sda1) and seperate core_name from directory
@@ -3088,7 +3419,7 @@ static void handle_input() {
             scan_directory(current_path);
             // Restore selection to "Recent games" entry
             for (int i = 0; i < entry_count; i++) {
-                if (strcmp(entries[i].path, "RECENT_GAMES") == 0) {
+                if (strcmp(entry_path(&entries[i]), "RECENT_GAMES") == 0) {
                     selected_index = i;
                     if (selected_index >= scroll_offset + visible_items) {
                         scroll_offset = selected_index - visible_items + 1;
@@ -3102,7 +3433,7 @@ static void handle_input() {
             scan_directory(current_path);
             // Restore selection to "Favorites" entry
             for (int i = 0; i < entry_count; i++) {
-                if (strcmp(entries[i].path, "FAVORITES") == 0) {
+                if (strcmp(entry_path(&entries[i]), "FAVORITES") == 0) {
                     selected_index = i;
                     if (selected_index >= scroll_offset + visible_items) {
                         scroll_offset = selected_index - visible_items + 1;
@@ -3121,6 +3452,10 @@ static void handle_input() {
             // Go back from Credits to Tools
             show_tools_menu();
             strncpy(current_path, "TOOLS", sizeof(current_path) - 1);
+        } else if (strcmp(current_path, "THUMBGEN") == 0) {
+            // Stop converting (progress is kept) and go back to Tools
+            close_thumb_gen_screen();
+            show_tools_menu();
         } else if (strcmp(current_path, "UTILS") == 0) {
             // Go back from Utils to Tools
             show_tools_menu();
@@ -3138,7 +3473,7 @@ static void handle_input() {
 
                 // Find the directory we just left and restore selection to it
                 for (int i = 0; i < entry_count; i++) {
-                    if (strcmp(entries[i].name, prev_dir) == 0) {
+                    if (strcmp(entry_name(&entries[i]), prev_dir) == 0) {
                         selected_index = i;
                         // Update scroll offset to keep selection visible
                         if (selected_index < scroll_offset) {
@@ -3167,6 +3502,11 @@ static void handle_input() {
 }
 
 // Libretro API implementation
+// Audio refill for the job scheduler, run before every job step
+static void menu_jobs_audio(void) {
+    if (mp_is_active()) mp_update_audio();
+}
+
 void retro_init(void) {
     framebuffer = (uint16_t*)malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
 
@@ -3191,6 +3531,7 @@ void retro_init(void) {
     mp_init();  // v52: Music player
     mp_set_audio_callback(audio_batch_cb);  // v52: Audio for music player
     iv_init();  // v56: Image viewer
+    jobs_set_audio_hook(menu_jobs_audio);  // Background music keeps playing under menu jobs
 
     recent_games_load();
     favorites_load();
@@ -3220,20 +3561,9 @@ void retro_deinit(void) {
     // Clean up GFX theme system
     gfx_theme_cleanup();
 
-    // Free thumbnail cache
-    if (thumbnail_cache_valid) {
-        free_thumbnail(&current_thumbnail);
-        thumbnail_cache_valid = 0;
-    }
-
-    // v32: Free screenshot cache
-    if (screenshot_cache_valid) {
-        if (current_screenshot.data) {
-            free(current_screenshot.data);
-            current_screenshot.data = NULL;
-        }
-        screenshot_cache_valid = 0;
-    }
+    // Free artwork (the images themselves live in the art cache's static arena)
+    art_forget();
+    thumb_gen_stop();
 
     // Free entries array
     if (entries) {
@@ -3242,6 +3572,9 @@ void retro_deinit(void) {
         entries_capacity = 0;
         entry_count = 0;
     }
+    free(entry_pool.buf);
+    memset(&entry_pool, 0, sizeof(entry_pool));
+    entry_dir = 0;
 
     if (framebuffer) {
         free(framebuffer);
@@ -3573,6 +3906,10 @@ void retro_run(void) {
     if (video_cb) {
         video_cb(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * sizeof(uint16_t));
     }
+
+    // Background work (folder cache, music library, artwork) in what's left of the frame
+    jobs_run(MENU_JOBS_BUDGET_MS);
+
     if (game_queued) {
         const char *stub_path = "/mnt/sda1/temp_launch.gba";
         FILE *stub_file = fopen(stub_path, "wb");
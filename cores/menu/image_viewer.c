@@ -8,6 +8,7 @@
 #include "font.h"
 #include "theme.h"
 #include "music_player.h"  // v69: For pausing music during heavy image load
+#include "playlist.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,7 +46,6 @@
 #define PAN_SLOW_DIV 5
 
 // Playlist
-#define MAX_PLAYLIST 512
 #define MAX_PATH_LEN 512
 #define MAX_FILENAME_LEN 256
 
@@ -86,8 +86,7 @@ static char iv_current_dir[MAX_PATH_LEN];
 static char iv_current_filename[MAX_FILENAME_LEN];
 
 // Playlist
-static char iv_playlist[MAX_PLAYLIST][MAX_FILENAME_LEN];
-static int iv_playlist_count = 0;
+static playlist_t iv_playlist;
 static int iv_playlist_current = -1;
 
 // Error state
@@ -339,53 +338,13 @@ static int iv_decode_from_memory(void) {
 void iv_init(void) {
     iv_active = 0;
     iv_image_data = NULL;
-    iv_playlist_count = 0;
+    playlist_clear(&iv_playlist);
     iv_playlist_current = -1;
 }
 
 static void iv_scan_playlist(void) {
-    iv_playlist_count = 0;
-    iv_playlist_current = -1;
-
-    DIR *dir = opendir(iv_current_dir);
-    if (!dir) return;
-
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL && iv_playlist_count < MAX_PLAYLIST) {
-        if (entry->d_name[0] == '.') continue;
-
-        if (iv_is_image_file(entry->d_name)) {
-            strncpy(iv_playlist[iv_playlist_count], entry->d_name, MAX_FILENAME_LEN - 1);
-            iv_playlist[iv_playlist_count][MAX_FILENAME_LEN - 1] = '\0';
-
-            // Check if this is current file
-            if (iv_strcasecmp(entry->d_name, iv_current_filename) == 0) {
-                iv_playlist_current = iv_playlist_count;
-            }
-            iv_playlist_count++;
-        }
-    }
-    closedir(dir);
-
-    // Sort playlist alphabetically (simple bubble sort - small lists)
-    for (int i = 0; i < iv_playlist_count - 1; i++) {
-        for (int j = i + 1; j < iv_playlist_count; j++) {
-            if (iv_strcasecmp(iv_playlist[i], iv_playlist[j]) > 0) {
-                char temp[MAX_FILENAME_LEN];
-                strcpy(temp, iv_playlist[i]);
-                strcpy(iv_playlist[i], iv_playlist[j]);
-                strcpy(iv_playlist[j], temp);
-            }
-        }
-    }
-
-    // Find current file index after sorting
-    for (int i = 0; i < iv_playlist_count; i++) {
-        if (iv_strcasecmp(iv_playlist[i], iv_current_filename) == 0) {
-            iv_playlist_current = i;
-            break;
-        }
-    }
+    playlist_scan(&iv_playlist, iv_current_dir, iv_is_image_file);
+    iv_playlist_current = playlist_find(&iv_playlist, iv_current_filename);
 }
 
 static int iv_load_image(const char *path) {
@@ -486,7 +445,7 @@ void iv_close(void) {
     iv_image_data = NULL;  // Points to universal_buffer, don't free
     iv_image_width = 0;
     iv_image_height = 0;
-    iv_playlist_count = 0;
+    playlist_clear(&iv_playlist);
     iv_playlist_current = -1;
 
     // v70: Clean up any loading state
@@ -531,17 +490,17 @@ int iv_update(void) {
 }
 
 static int iv_load_next(int direction) {
-    if (iv_playlist_count <= 1) return 0;
+    if (playlist_count(&iv_playlist) <= 1) return 0;
 
     // v70: Don't start new load while already loading
     if (iv_load_state == IV_LOAD_READING || iv_load_state == IV_LOAD_DECODING) return 0;
 
     int next_idx = iv_playlist_current + direction;
-    if (next_idx < 0) next_idx = iv_playlist_count - 1;
-    if (next_idx >= iv_playlist_count) next_idx = 0;
+    if (next_idx < 0) next_idx = playlist_count(&iv_playlist) - 1;
+    if (next_idx >= playlist_count(&iv_playlist)) next_idx = 0;
 
     char new_path[MAX_PATH_LEN];
-    snprintf(new_path, MAX_PATH_LEN, "%s/%s", iv_current_dir, iv_playlist[next_idx]);
+    snprintf(new_path, MAX_PATH_LEN, "%s/%s", iv_current_dir, playlist_name(&iv_playlist, next_idx));
 
     // v70: Save current zoom and pending index to restore after chunked loading completes
     iv_saved_zoom = iv_zoom;
@@ -550,7 +509,7 @@ static int iv_load_next(int direction) {
     // v70: Use chunked loading
     if (iv_start_load(new_path)) {
         strncpy(iv_current_path, new_path, MAX_PATH_LEN - 1);
-        strncpy(iv_current_filename, iv_playlist[next_idx], MAX_FILENAME_LEN - 1);
+        strncpy(iv_current_filename, playlist_name(&iv_playlist, next_idx), MAX_FILENAME_LEN - 1);
         return 1;
     }
     iv_pending_playlist_idx = -1;
@@ -883,7 +842,7 @@ void iv_render(uint16_t *framebuffer) {
     int zoom_percent = (iv_zoom * 100) / ZOOM_100_PERCENT;
     snprintf(info, sizeof(info), "%dx%d  %d%%  [%d/%d]",
              iv_image_width, iv_image_height, zoom_percent,
-             iv_playlist_current + 1, iv_playlist_count);
+             iv_playlist_current + 1, playlist_count(&iv_playlist));
 
     // Semi-transparent bar at bottom
     for (int y = SCREEN_HEIGHT - 20; y < SCREEN_HEIGHT; y++) {
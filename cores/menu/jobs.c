@@ -0,0 +1,122 @@
+/*
+ * jobs.c - Cooperative background jobs for the menu
+ *
+ * See jobs.h.
+ */
+
+#include "jobs.h"
+#include <stddef.h>
+
+#ifdef SF2000
+#include "../../stockfw.h"
+#else
+#include <time.h>
+#endif
+
+#define JOBS_MAX 8
+
+typedef struct {
+    job_step_fn step;       /* NULL once finished or cancelled */
+    void *ctx;
+    int waiting;            /* returned JOB_WAIT this frame */
+} job_t;
+
+static job_t jobs[JOBS_MAX];
+static int jobs_count = 0;
+static int jobs_running = 0;
+static void (*jobs_audio_hook)(void) = NULL;
+
+static uint32_t jobs_now(void) {
+#ifdef SF2000
+    return os_get_tick_count();
+#else
+    return (uint32_t)(clock() * 1000 / CLOCKS_PER_SEC);
+#endif
+}
+
+/* Squeeze out finished slots, keeping queue order */
+static void jobs_compact(void) {
+    int n = 0;
+    for (int i = 0; i < jobs_count; i++) {
+        if (jobs[i].step) jobs[n++] = jobs[i];
+    }
+    jobs_count = n;
+}
+
+static job_t *jobs_find(job_step_fn step) {
+    for (int i = 0; i < jobs_count; i++) {
+        if (jobs[i].step == step) return &jobs[i];
+    }
+    return NULL;
+}
+
+void jobs_set_audio_hook(void (*refill)(void)) {
+    jobs_audio_hook = refill;
+}
+
+int jobs_add(job_step_fn step, void *ctx) {
+    if (!step) return 0;
+
+    job_t *j = jobs_find(step);
+    if (j) {
+        j->ctx = ctx;
+        return 1;
+    }
+
+    if (jobs_count >= JOBS_MAX && !jobs_running) jobs_compact();
+    if (jobs_count >= JOBS_MAX) return 0;
+
+    j = &jobs[jobs_count++];
+    j->step = step;
+    j->ctx = ctx;
+    /* Added from inside a step: start next frame, the budget is already spoken for */
+    j->waiting = jobs_running;
+    return 1;
+}
+
+void jobs_cancel(job_step_fn step) {
+    job_t *j = jobs_find(step);
+    if (!j) return;
+    j->step = NULL;
+    if (!jobs_running) jobs_compact();
+}
+
+int jobs_queued(job_step_fn step) {
+    return step && jobs_find(step) != NULL;
+}
+
+void jobs_run(uint32_t budget_ms) {
+    if (jobs_count == 0) return;
+
+    uint32_t start = jobs_now();
+    int steps = 0;
+    int ran;
+
+    jobs_running = 1;
+    for (int i = 0; i < jobs_count; i++) jobs[i].waiting = 0;
+
+    do {
+        ran = 0;
+        for (int i = 0; i < jobs_count; i++) {
+            if (!jobs[i].step || jobs[i].waiting) continue;
+            if (steps > 0 && jobs_now() - start >= budget_ms) goto out;
+
+            if (jobs_audio_hook) jobs_audio_hook();
+
+            /* The step may queue or cancel jobs, so don't hold a pointer across it */
+            job_step_fn step = jobs[i].step;
+            int r = step(jobs[i].ctx);
+            steps++;
+            ran = 1;
+
+            if (jobs[i].step != step) continue;   /* cancelled itself */
+            if (r == JOB_DONE) jobs[i].step = NULL;
+            else if (r == JOB_WAIT) jobs[i].waiting = 1;
+        }
+    } while (ran);
+
+out:
+    jobs_running = 0;
+    jobs_compact();
+    if (steps > 0 && jobs_audio_hook) jobs_audio_hook();
+}
@@ -0,0 +1,44 @@
+/*
+ * jobs.h - Cooperative background jobs for the menu
+ *
+ * Work that would stall a frame (folder cache rebuilds, library scans,
+ * artwork decodes) is registered as a step function that does a small
+ * piece and says whether it is finished. jobs_run() is called once per menu
+ * frame and steps the queued jobs round-robin until the frame's time budget
+ * is used; at least one step runs every frame, so every job makes progress
+ * even when rendering ran long.
+ *
+ * Audio refill goes first: the refill hook is called before every step, so
+ * music playing in the background is topped up between steps instead of
+ * waiting for the whole batch.
+ *
+ * Jobs are identified by their step function; queueing one that is
+ * already queued just updates its context.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdint.h>
+
+#define JOB_DONE 0      /* finished: drop it */
+#define JOB_MORE 1      /* call again, this frame if there is time */
+#define JOB_WAIT 2      /* call again next frame */
+
+typedef int (*job_step_fn)(void *ctx);
+
+/* Called before every step (NULL for none) */
+void jobs_set_audio_hook(void (*refill)(void));
+
+/* Queue a job. Returns 1 on success, 0 if the table is full. */
+int jobs_add(job_step_fn step, void *ctx);
+
+/* Drop a queued job without running it again */
+void jobs_cancel(job_step_fn step);
+
+int jobs_queued(job_step_fn step);
+
+/* Step jobs until budget_ms have passed */
+void jobs_run(uint32_t budget_ms);
+
+#endif /* JOBS_H */
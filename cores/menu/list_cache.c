@@ -0,0 +1,205 @@
+/*
+ * list_cache.c - Cached listings of ROM folders
+ *
+ * See list_cache.h.
+ */
+
+#include "list_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define LC_MAGIC    0x54534C46   /* "FLST" */
+#define LC_VERSION  1
+#define LC_PARENT   "/mnt/sda1/frogui"
+#define LC_MAX_PATH 512
+
+/*
+ * File layout: header, the folder path (NUL-terminated, to catch hash
+ * collisions), then count records of one flags byte followed by the name
+ * and, if flagged, the thumbnail and screenshot names, each NUL-terminated.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t path_hash;
+    lc_stamp_t stamp;
+    uint32_t count;
+    uint32_t data_size;     /* bytes of records */
+} lc_header_t;
+
+/* FNV-1a of the folder path */
+static uint32_t lc_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void lc_file(const char *dir, char *out, int out_size) {
+    snprintf(out, out_size, "%s/%08x.lst", LIST_CACHE_DIR, (unsigned)lc_hash(dir));
+}
+
+int lc_stamp_dir(const char *dir, uint32_t filter_sig, lc_stamp_t *stamp) {
+    char res[LC_MAX_PATH];
+    struct stat st;
+
+    memset(stamp, 0, sizeof(*stamp));
+    if (stat(dir, &st) != 0) return 0;
+    stamp->dir_mtime = (uint32_t)st.st_mtime;
+    stamp->filter_sig = filter_sig;
+
+    snprintf(res, sizeof(res), "%s/.res", dir);
+    if (stat(res, &st) == 0) stamp->res_mtime = (uint32_t)st.st_mtime;
+    return 1;
+}
+
+int lc_stamp_fresh(const lc_stamp_t *cached, const lc_stamp_t *now) {
+    return cached->dir_mtime == now->dir_mtime &&
+           cached->res_mtime == now->res_mtime &&
+           cached->filter_sig == now->filter_sig;
+}
+
+void lc_writer_init(lc_writer_t *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void lc_writer_free(lc_writer_t *w) {
+    free(w->buf);
+    lc_writer_init(w);
+}
+
+static int lc_put_str(uint8_t *p, const char *s) {
+    int len = strlen(s) + 1;
+    memcpy(p, s, len);
+    return len;
+}
+
+int lc_writer_add(lc_writer_t *w, const lc_entry_t *e) {
+    uint8_t flags = e->flags & (LC_DIR | LC_THUMB | LC_SHOT);
+    if (!e->thumb) flags &= ~LC_THUMB;
+    if (!e->shot) flags &= ~LC_SHOT;
+
+    uint32_t need = 1 + strlen(e->name) + 1;
+    if (flags & LC_THUMB) need += strlen(e->thumb) + 1;
+    if (flags & LC_SHOT) need += strlen(e->shot) + 1;
+
+    if (w->used + need > w->size) {
+        uint32_t size = w->size ? w->size : 4096;
+        while (size < w->used + need) size *= 2;
+        uint8_t *p = (uint8_t *)realloc(w->buf, size);
+        if (!p) return 0;
+        w->buf = p;
+        w->size = size;
+    }
+
+    uint8_t *p = w->buf + w->used;
+    *p++ = flags;
+    p += lc_put_str(p, e->name);
+    if (flags & LC_THUMB) p += lc_put_str(p, e->thumb);
+    if (flags & LC_SHOT) p += lc_put_str(p, e->shot);
+    w->used += need;
+    w->count++;
+    return 1;
+}
+
+int lc_save(const char *dir, const lc_stamp_t *stamp, const lc_writer_t *w) {
+    char path[LC_MAX_PATH];
+    lc_header_t h;
+
+    memset(&h, 0, sizeof(h));
+    h.magic = LC_MAGIC;
+    h.version = LC_VERSION;
+    h.path_hash = lc_hash(dir);
+    h.stamp = *stamp;
+    h.count = w->count;
+    h.data_size = w->used;
+
+    mkdir(LC_PARENT, 0755);
+    mkdir(LIST_CACHE_DIR, 0755);
+
+    lc_file(dir, path, sizeof(path));
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return 0;
+
+    int ok = (fwrite(&h, sizeof(h), 1, fp) == 1);
+    if (ok && fwrite(dir, 1, strlen(dir) + 1, fp) != strlen(dir) + 1) ok = 0;
+    if (ok && w->used > 0 && fwrite(w->buf, 1, w->used, fp) != w->used) ok = 0;
+    if (fclose(fp) != 0) ok = 0;
+
+    if (!ok) remove(path);
+    return ok;
+}
+
+int lc_load(const char *dir, lc_list_t *l) {
+    char path[LC_MAX_PATH];
+
+    memset(l, 0, sizeof(*l));
+    lc_file(dir, path, sizeof(path));
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    /* Whole file in one read */
+    long len = 0;
+    if (fseek(fp, 0, SEEK_END) == 0) len = ftell(fp);
+    if (len >= (long)sizeof(lc_header_t)) {
+        l->buf = (uint8_t *)malloc(len);
+        fseek(fp, 0, SEEK_SET);
+        if (l->buf && fread(l->buf, 1, len, fp) != (size_t)len) {
+            free(l->buf);
+            l->buf = NULL;
+        }
+    }
+    fclose(fp);
+    if (!l->buf) return 0;
+
+    lc_header_t h;
+    memcpy(&h, l->buf, sizeof(h));
+    uint32_t dir_len = strlen(dir) + 1;
+    if (h.magic != LC_MAGIC || h.version != LC_VERSION || h.path_hash != lc_hash(dir) ||
+        sizeof(h) + dir_len + h.data_size != (uint32_t)len ||
+        memcmp(l->buf + sizeof(h), dir, dir_len) != 0) {
+        lc_close(l);
+        return 0;
+    }
+
+    l->pos = l->buf + sizeof(h) + dir_len;
+    l->end = l->pos + h.data_size;
+    l->count = h.count;
+    l->stamp = h.stamp;
+    return 1;
+}
+
+/* NUL-terminated string at *p, or NULL if it runs past end */
+static const char *lc_get_str(const uint8_t **p, const uint8_t *end) {
+    const uint8_t *nul = (const uint8_t *)memchr(*p, 0, end - *p);
+    if (!nul) return NULL;
+    const char *s = (const char *)*p;
+    *p = nul + 1;
+    return s;
+}
+
+int lc_next(lc_list_t *l, lc_entry_t *e) {
+    if (!l->buf || l->pos >= l->end) return 0;
+
+    const uint8_t *p = l->pos;
+    memset(e, 0, sizeof(*e));
+    e->flags = *p++;
+    e->name = lc_get_str(&p, l->end);
+    if (e->name && (e->flags & LC_THUMB)) e->thumb = lc_get_str(&p, l->end);
+    if (e->name && (e->flags & LC_SHOT)) e->shot = lc_get_str(&p, l->end);
+    if (!e->name || ((e->flags & LC_THUMB) && !e->thumb) || ((e->flags & LC_SHOT) && !e->shot)) {
+        l->pos = l->end;
+        return 0;
+    }
+    l->pos = p;
+    return 1;
+}
+
+void lc_close(lc_list_t *l) {
+    free(l->buf);
+    memset(l, 0, sizeof(*l));
+}
@@ -0,0 +1,82 @@
+/*
+ * list_cache.h - Cached listings of ROM folders
+ *
+ * Listing a platform folder means reading every directory entry, running
+ * the display filters, scanning .res/ and matching thumbnails and
+ * screenshots to games, which takes seconds for folders with thousands of
+ * ROMs. The finished listing (after filters, with the matches resolved) is
+ * stored as one small binary file under LIST_CACHE_DIR and read back in
+ * one go the next time the folder is entered.
+ *
+ * A listing is tied to its folder by a stamp: the mtimes of the folder and
+ * its .res/, a signature of the display filters it was built with, and the
+ * number of raw directory entries. The mtimes and filters can be checked
+ * with two stat() calls; the entry count needs a readdir pass and is meant
+ * to be verified in the background, since FAT doesn't always bump a
+ * folder's mtime when files are added.
+ */
+
+#ifndef LIST_CACHE_H
+#define LIST_CACHE_H
+
+#include <stdint.h>
+
+#define LIST_CACHE_DIR "/mnt/sda1/frogui/lists"
+
+#define LC_DIR   0x01   /* subfolder */
+#define LC_THUMB 0x02   /* thumb is set */
+#define LC_SHOT  0x04   /* shot is set */
+
+typedef struct {
+    uint32_t dir_mtime;
+    uint32_t res_mtime;     /* 0 if there is no .res/ */
+    uint32_t filter_sig;
+    uint32_t raw_count;     /* entries in the folder and .res/, hidden ones excluded */
+} lc_stamp_t;
+
+typedef struct {
+    uint8_t flags;
+    const char *name;
+    const char *thumb;      /* file name in .res/ (LC_THUMB) */
+    const char *shot;       /* image file next to the game (LC_SHOT) */
+} lc_entry_t;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t used;
+    uint32_t size;
+    uint32_t count;
+} lc_writer_t;
+
+typedef struct {
+    uint8_t *buf;
+    const uint8_t *pos;
+    const uint8_t *end;
+    uint32_t count;
+    lc_stamp_t stamp;
+} lc_list_t;
+
+/* Stamp of dir as it is now, without raw_count. Returns 0 if dir is missing. */
+int lc_stamp_dir(const char *dir, uint32_t filter_sig, lc_stamp_t *stamp);
+
+/* 1 if the mtimes and filter signature match (raw_count is not compared) */
+int lc_stamp_fresh(const lc_stamp_t *cached, const lc_stamp_t *now);
+
+/* Build a listing in memory, then write it with lc_save */
+void lc_writer_init(lc_writer_t *w);
+int lc_writer_add(lc_writer_t *w, const lc_entry_t *e);
+void lc_writer_free(lc_writer_t *w);
+
+/* Write the listing of dir. Returns 1 on success. */
+int lc_save(const char *dir, const lc_stamp_t *stamp, const lc_writer_t *w);
+
+/* Read the cached listing of dir (whatever its stamp - compare l->stamp).
+ * Returns 1 on success; lc_close() it when done. */
+int lc_load(const char *dir, lc_list_t *l);
+
+/* Next entry, in the stored order. Strings point into the loaded buffer. */
+int lc_next(lc_list_t *l, lc_entry_t *e);
+
+void lc_close(lc_list_t *l);
+
+#endif /* LIST_CACHE_H */
@@ -0,0 +1,550 @@
+/*
+ * music_lib.c - Persistent metadata cache for music files
+ *
+ * See music_lib.h.
+ */
+
+#include "music_lib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef SF2000
+#include "../../stockfw.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+#define ML_MAGIC        0x424C4D46   /* "FMLB" */
+#define ML_VERSION      2
+#define ML_PARENT_DIR   "/mnt/sda1/frogui"
+#define ML_MAX_PATH     512
+#define ML_PROBE_BYTES  4096
+#define ML_SCAN_BUDGET_MS 4
+#define ML_SCAN_STATS   32           /* files looked at per step without a clock */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_size;
+    uint32_t count;
+} ml_file_header_t;
+
+/* Sorted by path_hash, then path_check */
+static ml_entry_t ml_entries[ML_MAX_ENTRIES];
+static int ml_count = 0;
+static int ml_loaded = 0;
+static int ml_dirty = 0;
+static uint32_t ml_visit = 0;        /* stamp for ml_entry_t.seen, one per scan */
+
+/* Background scan of one directory */
+static int ml_scan_active = 0;
+static char ml_scan_path[ML_MAX_PATH / 2];
+#ifdef SF2000
+static int ml_scan_fd = -1;
+#else
+static DIR *ml_scan_handle = NULL;
+#endif
+
+
+#define ML_HASH_SEED  2166136261u
+#define ML_CHECK_SEED 5381u
+
+/* Both hashes of a path. Hashing dir, "/" and name in turn gives the same
+ * result as hashing the joined path. */
+typedef struct {
+    uint32_t hash;      /* FNV-1a */
+    uint32_t check;     /* djb2 (xor) */
+} ml_key_t;
+
+static void ml_key_step(ml_key_t *k, const char *s) {
+    while (*s) {
+        uint8_t c = (uint8_t)*s++;
+        k->hash = (k->hash ^ c) * 16777619u;
+        k->check = (k->check * 33) ^ c;
+    }
+}
+
+static ml_key_t ml_key_path(const char *dir, const char *name) {
+    ml_key_t k = { ML_HASH_SEED, ML_CHECK_SEED };
+    ml_key_step(&k, dir);
+    if (name) {
+        ml_key_step(&k, "/");
+        ml_key_step(&k, name);
+    }
+    return k;
+}
+
+static int ml_key_before(const ml_entry_t *e, ml_key_t k) {
+    return e->path_hash < k.hash || (e->path_hash == k.hash && e->path_check < k.check);
+}
+
+/* Index of key, or where it would be inserted */
+static int ml_search(ml_key_t k, int *found) {
+    int lo = 0, hi = ml_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ml_key_before(&ml_entries[mid], k)) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = (lo < ml_count && ml_entries[lo].path_hash == k.hash &&
+              ml_entries[lo].path_check == k.check);
+    return lo;
+}
+
+static void ml_remove(int i) {
+    memmove(&ml_entries[i], &ml_entries[i + 1], (ml_count - i - 1) * sizeof(ml_entry_t));
+    ml_count--;
+    ml_dirty = 1;
+}
+
+static void ml_load(void) {
+    if (ml_loaded) return;
+    ml_loaded = 1;
+    ml_count = 0;
+
+    FILE *fp = fopen(ML_LIB_FILE, "rb");
+    if (!fp) return;
+
+    ml_file_header_t h;
+    if (fread(&h, sizeof(h), 1, fp) == 1 &&
+        h.magic == ML_MAGIC && h.version == ML_VERSION &&
+        h.entry_size == sizeof(ml_entry_t) && h.count <= ML_MAX_ENTRIES &&
+        fread(ml_entries, sizeof(ml_entry_t), h.count, fp) == h.count) {
+        ml_count = h.count;
+    }
+    fclose(fp);
+
+    /* Don't trust the order of a file we didn't just write */
+    for (int i = 1; i < ml_count; i++) {
+        ml_key_t k = { ml_entries[i].path_hash, ml_entries[i].path_check };
+        if (!ml_key_before(&ml_entries[i - 1], k)) {
+            ml_count = 0;
+            break;
+        }
+    }
+    for (int i = 0; i < ml_count; i++) {
+        if (ml_entries[i].seen > ml_visit) ml_visit = ml_entries[i].seen;
+    }
+}
+
+void ml_flush(void) {
+    if (!ml_dirty) return;
+    ml_dirty = 0;
+
+    mkdir(ML_PARENT_DIR, 0755);
+    FILE *fp = fopen(ML_LIB_FILE, "wb");
+    if (!fp) return;
+
+    ml_file_header_t h;
+    h.magic = ML_MAGIC;
+    h.version = ML_VERSION;
+    h.entry_size = sizeof(ml_entry_t);
+    h.count = ml_count;
+
+    int ok = (fwrite(&h, sizeof(h), 1, fp) == 1) &&
+             (fwrite(ml_entries, sizeof(ml_entry_t), ml_count, fp) == (size_t)ml_count);
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) remove(ML_LIB_FILE);
+}
+
+/* Insert or replace. A full table drops the entry seen longest ago, unless
+ * even that one was seen in this visit (a folder bigger than the table). */
+static void ml_store(const ml_entry_t *e) {
+    ml_key_t k = { e->path_hash, e->path_check };
+    int found;
+    int i = ml_search(k, &found);
+    if (!found) {
+        if (ml_count >= ML_MAX_ENTRIES) {
+            int oldest = 0;
+            for (int j = 1; j < ml_count; j++) {
+                if (ml_entries[j].seen < ml_entries[oldest].seen) oldest = j;
+            }
+            if (ml_entries[oldest].seen == ml_visit) return;
+            ml_remove(oldest);
+            i = ml_search(k, &found);
+        }
+        memmove(&ml_entries[i + 1], &ml_entries[i], (ml_count - i) * sizeof(ml_entry_t));
+        ml_count++;
+    }
+    ml_entries[i] = *e;
+    ml_dirty = 1;
+}
+
+const ml_entry_t *ml_find(const char *dir, const char *name) {
+    ml_load();
+    int found;
+    int i = ml_search(ml_key_path(dir, name), &found);
+    if (!found) return NULL;
+    ml_entries[i].seen = ml_visit;  /* saved with the next change */
+    return &ml_entries[i];
+}
+
+void ml_set_duration(const char *path, uint32_t seconds) {
+    ml_load();
+    int found;
+    int i = ml_search(ml_key_path(path, NULL), &found);
+    if (!found || seconds == 0) return;
+    if (ml_entries[i].duration_exact && ml_entries[i].duration == seconds) return;
+    ml_entries[i].duration = seconds;
+    ml_entries[i].duration_exact = 1;
+    ml_dirty = 1;
+}
+
+void ml_format_duration(uint32_t seconds, char *out, int out_size) {
+    if (seconds >= 3600) {
+        snprintf(out, out_size, "%u:%02u:%02u", (unsigned)(seconds / 3600),
+                 (unsigned)(seconds / 60 % 60), (unsigned)(seconds % 60));
+    } else {
+        snprintf(out, out_size, "%u:%02u", (unsigned)(seconds / 60), (unsigned)(seconds % 60));
+    }
+}
+
+
+static uint32_t ml_u16_le(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t ml_u32_le(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint32_t ml_u32_be(const uint8_t *p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+static uint32_t ml_syncsafe(const uint8_t *p) {
+    return ((p[0] & 0x7F) << 21) | ((p[1] & 0x7F) << 14) | ((p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+static int ml_ends_with_ci(const char *s, const char *suffix) {
+    size_t ls = strlen(s), lx = strlen(suffix);
+    if (lx > ls) return 0;
+    s += ls - lx;
+    while (*s) {
+        char a = *s++, b = *suffix++;
+        if (a >= 'A' && a <= 'Z') a += 32;
+        if (a != b) return 0;
+    }
+    return 1;
+}
+
+static int ml_is_music_file(const char *name) {
+    return ml_ends_with_ci(name, ".mp3") || ml_ends_with_ci(name, ".wav") ||
+           ml_ends_with_ci(name, ".adp") || ml_ends_with_ci(name, ".adpcm");
+}
+
+/* ID3 text frame -> ASCII. Latin-1/UTF-8 bytes outside ASCII and non-ASCII
+ * UTF-16 code units become '?', the font has nothing else to draw. */
+static void ml_id3_text(const uint8_t *p, uint32_t len, char *out, int out_size) {
+    int n = 0;
+    if (len == 0) {
+        out[0] = '\0';
+        return;
+    }
+    uint8_t enc = *p++;
+    len--;
+
+    if (enc == 1 || enc == 2) {
+        int big_endian = (enc == 2);
+        if (len >= 2 && ((p[0] == 0xFF && p[1] == 0xFE) || (p[0] == 0xFE && p[1] == 0xFF))) {
+            big_endian = (p[0] == 0xFE);
+            p += 2;
+            len -= 2;
+        }
+        for (uint32_t i = 0; i + 1 < len && n < out_size - 1; i += 2) {
+            uint32_t c = big_endian ? (p[i] << 8) | p[i + 1] : p[i] | (p[i + 1] << 8);
+            if (c == 0) break;
+            out[n++] = (c >= 32 && c < 127) ? (char)c : '?';
+        }
+    } else {
+        for (uint32_t i = 0; i < len && n < out_size - 1; i++) {
+            uint8_t c = p[i];
+            if (c == 0) break;
+            if (enc == 3 && (c & 0xC0) == 0x80) continue;  /* UTF-8 continuation */
+            out[n++] = (c >= 32 && c < 127) ? (char)c : '?';
+        }
+    }
+    while (n > 0 && out[n - 1] == ' ') n--;
+    out[n] = '\0';
+}
+
+/* Title/artist from the part of an ID3v2 tag that is in buf */
+static void ml_parse_id3(const uint8_t *buf, uint32_t len, ml_entry_t *e) {
+    int ver = buf[3];
+    uint32_t end = 10 + ml_syncsafe(buf + 6);
+    uint32_t pos = 10;
+    int hdr = (ver == 2) ? 6 : 10;
+
+    if (end > len) end = len;
+    if (buf[5] & 0x80) return;  /* unsynchronised tag, not worth undoing */
+    if (ver >= 3 && (buf[5] & 0x40) && pos + 4 <= end) {
+        /* Extended header */
+        uint32_t ext = (ver == 4) ? ml_syncsafe(buf + pos) : ml_u32_be(buf + pos) + 4;
+        pos += ext;
+    }
+
+    while (pos + hdr <= end && buf[pos] != 0) {
+        const uint8_t *f = buf + pos;
+        uint32_t size;
+        if (ver == 2) size = (f[3] << 16) | (f[4] << 8) | f[5];
+        else if (ver == 4) size = ml_syncsafe(f + 4);
+        else size = ml_u32_be(f + 4);
+
+        uint32_t avail = end - pos - hdr;
+        uint32_t n = (size < avail) ? size : avail;
+        if ((ver == 2 && memcmp(f, "TT2", 3) == 0) || (ver != 2 && memcmp(f, "TIT2", 4) == 0)) {
+            ml_id3_text(f + hdr, n, e->title, ML_TITLE_LEN);
+        } else if ((ver == 2 && memcmp(f, "TP1", 3) == 0) || (ver != 2 && memcmp(f, "TPE1", 4) == 0)) {
+            ml_id3_text(f + hdr, n, e->artist, ML_ARTIST_LEN);
+        }
+        if (size > avail) break;
+        pos += hdr + size;
+    }
+}
+
+static const uint16_t ml_mp3_bitrate[2][16] = {
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0},  /* MPEG-1 */
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0}       /* MPEG-2/2.5 */
+};
+
+static const uint16_t ml_mp3_rate[3][3] = {
+    {44100, 48000, 32000}, {22050, 24000, 16000}, {11025, 12000, 8000}
+};
+
+/* Layer III frame header: rate, channels, bitrate and bytes, 0 if invalid */
+static int ml_mp3_header(const uint8_t *h, int *rate, int *channels, int *kbps, int *mpeg1) {
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return 0;
+    int ver = (h[1] >> 3) & 3;
+    if (ver == 1 || ((h[1] >> 1) & 3) != 1) return 0;
+    int br = h[2] >> 4, sr = (h[2] >> 2) & 3;
+    if (br == 0 || br == 15 || sr == 3) return 0;
+
+    *mpeg1 = (ver == 3);
+    *rate = ml_mp3_rate[*mpeg1 ? 0 : (ver == 0 ? 2 : 1)][sr];
+    *channels = ((h[3] >> 6) == 3) ? 1 : 2;
+    *kbps = ml_mp3_bitrate[*mpeg1 ? 0 : 1][br];
+    return (*mpeg1 ? 144000 : 72000) * *kbps / *rate + ((h[2] >> 1) & 1);
+}
+
+static int ml_probe_mp3(FILE *fp, uint8_t *buf, uint32_t n, uint32_t file_size, ml_entry_t *e) {
+    uint32_t tag = 0;
+    if (n >= 10 && memcmp(buf, "ID3", 3) == 0) {
+        ml_parse_id3(buf, n, e);
+        tag = 10 + ml_syncsafe(buf + 6) + ((buf[5] & 0x10) ? 10 : 0);
+        if (fseek(fp, tag, SEEK_SET) != 0) return 0;
+        n = fread(buf, 1, ML_PROBE_BYTES, fp);
+    }
+
+    /* First frame whose successor is also a frame header */
+    int rate = 0, channels = 0, kbps = 0, mpeg1 = 0, len = 0;
+    uint32_t pos;
+    for (pos = 0; pos + 4 <= n; pos++) {
+        len = ml_mp3_header(buf + pos, &rate, &channels, &kbps, &mpeg1);
+        if (len <= 0) continue;
+        int r2, c2, k2, m2;
+        if (pos + len + 4 > n || ml_mp3_header(buf + pos + len, &r2, &c2, &k2, &m2) > 0) break;
+    }
+    if (pos + 4 > n || len <= 0) return 0;
+
+    e->format = ML_FMT_MP3;
+    e->sample_rate = rate;
+    e->channels = channels;
+
+    /* Xing/Info or VBRI frame count gives the exact length */
+    uint32_t spf = mpeg1 ? 1152 : 576;
+    uint32_t side = mpeg1 ? (channels == 1 ? 17 : 32) : (channels == 1 ? 9 : 17);
+    const uint8_t *x = buf + pos + 4 + side;
+    const uint8_t *v = buf + pos + 4 + 32;
+    uint32_t frames = 0;
+    if (x + 12 <= buf + n && (memcmp(x, "Xing", 4) == 0 || memcmp(x, "Info", 4) == 0) &&
+        (ml_u32_be(x + 4) & 1)) {
+        frames = ml_u32_be(x + 8);
+    } else if (v + 18 <= buf + n && memcmp(v, "VBRI", 4) == 0) {
+        frames = ml_u32_be(v + 14);
+    }
+
+    if (frames > 0) {
+        e->duration = (uint32_t)((uint64_t)frames * spf / rate);
+        e->duration_exact = 1;
+    } else if (kbps > 0 && file_size > tag + pos) {
+        e->duration = (uint32_t)((uint64_t)(file_size - tag - pos) * 8 / ((uint32_t)kbps * 1000));
+    }
+    return 1;
+}
+
+static int ml_probe_wav(FILE *fp, uint32_t file_size, ml_entry_t *e) {
+    uint8_t h[24];
+    uint32_t pos = 12;
+    uint32_t byte_rate = 0;
+
+    while (pos + 8 <= file_size) {
+        if (fseek(fp, pos, SEEK_SET) != 0 || fread(h, 1, 8, fp) != 8) return 0;
+        uint32_t size = ml_u32_le(h + 4);
+
+        if (memcmp(h, "fmt ", 4) == 0) {
+            if (size < 16 || fread(h + 8, 1, 16, fp) != 16) return 0;
+            int tag = ml_u16_le(h + 8);
+            if (tag == 1) e->format = ML_FMT_WAV_PCM;
+            else if (tag == 2 || tag == 0x11) e->format = ML_FMT_WAV_ADPCM;
+            else return 0;
+            e->channels = ml_u16_le(h + 10);
+            e->sample_rate = ml_u32_le(h + 12);
+            byte_rate = ml_u32_le(h + 16);
+        } else if (memcmp(h, "data", 4) == 0) {
+            if (e->format == ML_FMT_UNKNOWN) return 0;
+            if (size > file_size - pos - 8) size = file_size - pos - 8;
+            if (byte_rate > 0) {
+                e->duration = size / byte_rate;
+                e->duration_exact = 1;
+            }
+            return 1;
+        }
+        /* A chunk running past the end is a broken file; this also keeps
+         * a huge size from wrapping pos around */
+        if (size > file_size - pos - 8) return 0;
+        uint32_t next = pos + 8 + size + (size & 1);
+        if (next <= pos) return 0;
+        pos = next;
+    }
+    return 0;
+}
+
+/* Fill e from the file's headers; e carries key/size/mtime already */
+static int ml_probe(const char *path, ml_entry_t *e) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    uint8_t *buf = (uint8_t *)malloc(ML_PROBE_BYTES);
+    int ok = 0;
+    uint32_t n = buf ? fread(buf, 1, ML_PROBE_BYTES, fp) : 0;
+
+    if (n >= 12 && memcmp(buf, "RIFF", 4) == 0 && memcmp(buf + 8, "WAVE", 4) == 0) {
+        ok = ml_probe_wav(fp, e->file_size, e);
+    } else if (ml_ends_with_ci(path, ".adp") || ml_ends_with_ci(path, ".adpcm")) {
+        /* Headerless: same assumptions as the player, 22 kHz mono 256-byte blocks */
+        e->format = ML_FMT_RAW_ADPCM;
+        e->sample_rate = 22050;
+        e->channels = 1;
+        e->duration = (uint32_t)((uint64_t)(e->file_size / 256) * (2 + (256 - 7) * 2) / 22050);
+        e->duration_exact = 1;
+        ok = 1;
+    } else if (n >= 4) {
+        ok = ml_probe_mp3(fp, buf, n, e->file_size, e);
+    }
+
+    free(buf);
+    fclose(fp);
+    return ok;
+}
+
+
+static void ml_scan_close(void) {
+#ifdef SF2000
+    if (ml_scan_fd >= 0) fs_closedir(ml_scan_fd);
+    ml_scan_fd = -1;
+#else
+    if (ml_scan_handle) closedir(ml_scan_handle);
+    ml_scan_handle = NULL;
+#endif
+    ml_scan_active = 0;
+}
+
+void ml_scan_dir(const char *dir) {
+    ml_load();
+    ml_scan_close();
+    strncpy(ml_scan_path, dir, sizeof(ml_scan_path) - 1);
+    ml_scan_path[sizeof(ml_scan_path) - 1] = '\0';
+    ml_visit++;
+
+#ifdef SF2000
+    ml_scan_fd = fs_opendir(ml_scan_path);
+    ml_scan_active = (ml_scan_fd >= 0);
+#else
+    ml_scan_handle = opendir(ml_scan_path);
+    ml_scan_active = (ml_scan_handle != NULL);
+#endif
+}
+
+/* Next music file name in the scanned directory, NULL at the end */
+static const char *ml_scan_next(void) {
+#ifdef SF2000
+    static union {
+        struct {
+            uint8_t _1[0x10];
+            uint32_t type;
+        };
+        struct {
+            uint8_t _2[0x22];
+            char d_name[0x225];
+        };
+        uint8_t __[0x428];
+    } buffer;
+
+    while (fs_readdir(ml_scan_fd, &buffer) >= 0) {
+        if (buffer.type == 0x4000) continue;
+        if (ml_is_music_file(buffer.d_name)) return buffer.d_name;
+    }
+#else
+    struct dirent *entry;
+    while ((entry = readdir(ml_scan_handle)) != NULL) {
+        if (entry->d_type == DT_DIR) continue;
+        if (ml_is_music_file(entry->d_name)) return entry->d_name;
+    }
+#endif
+    return NULL;
+}
+
+/* Look at one file; returns 1 if it had to be opened */
+static int ml_scan_file(const char *name) {
+    char path[ML_MAX_PATH];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", ml_scan_path, name);
+    if (stat(path, &st) != 0) return 0;
+
+    ml_key_t k = ml_key_path(ml_scan_path, name);
+    int found;
+    int i = ml_search(k, &found);
+    if (found && ml_entries[i].file_size == (uint32_t)st.st_size &&
+        ml_entries[i].file_mtime == (uint32_t)st.st_mtime) {
+        ml_entries[i].seen = ml_visit;
+        return 0;
+    }
+
+    ml_entry_t e;
+    memset(&e, 0, sizeof(e));
+    e.path_hash = k.hash;
+    e.path_check = k.check;
+    e.dir_hash = ml_key_path(ml_scan_path, NULL).hash;
+    e.seen = ml_visit;
+    e.file_size = (uint32_t)st.st_size;
+    e.file_mtime = (uint32_t)st.st_mtime;
+    /* Unreadable files are stored too, so they aren't retried every visit */
+    ml_probe(path, &e);
+    ml_store(&e);
+    return 1;
+}
+
+int ml_scan_step(void) {
+    if (!ml_scan_active) return 0;
+
+#ifdef SF2000
+    uint32_t start = os_get_tick_count();
+    for (;;) {
+        const char *name = ml_scan_next();
+        if (!name) break;
+        ml_scan_file(name);
+        if (os_get_tick_count() - start >= ML_SCAN_BUDGET_MS) return 1;
+    }
+#else
+    /* No cheap clock here: one opened file or ML_SCAN_STATS stats per call */
+    int stats = 0;
+    const char *name;
+    while ((name = ml_scan_next()) != NULL) {
+        if (ml_scan_file(name) || ++stats >= ML_SCAN_STATS) return 1;
+    }
+#endif
+
+    /* Files of this directory the scan didn't see are gone */
+    uint32_t dir_hash = ml_key_path(ml_scan_path, NULL).hash;
+    for (int i = ml_count - 1; i >= 0; i--) {
+        if (ml_entries[i].dir_hash == dir_hash && ml_entries[i].seen != ml_visit) ml_remove(i);
+    }
+
+    ml_scan_close();
+    ml_flush();
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * music_lib.h - Persistent metadata cache for music files
+ *
+ * Keeps format, sample rate, channels, duration and ID3v2 title/artist of
+ * music files in /mnt/sda1/frogui/music.lib, so the music browser and the
+ * player can show them without opening each file.
+ *
+ * Entries are keyed by two independent hashes of the full path, so a
+ * collision of one doesn't hand out another file's tags, and tied to the
+ * file by size and mtime. They are filled in by a background scanner that
+ * walks one directory a file at a time (ml_scan_dir / ml_scan_step, run as a
+ * menu job) and only opens files it doesn't know yet or that changed since.
+ * A finished scan drops the directory's entries for files that are gone;
+ * when the table is full, the entry seen longest ago makes room.
+ */
+
+#ifndef MUSIC_LIB_H
+#define MUSIC_LIB_H
+
+#include <stdint.h>
+
+#define ML_LIB_FILE     "/mnt/sda1/frogui/music.lib"
+#define ML_MAX_ENTRIES  1024
+#define ML_TITLE_LEN    48
+#define ML_ARTIST_LEN   32
+
+/* Same values as the music player's MP_FMT_* */
+#define ML_FMT_UNKNOWN   0
+#define ML_FMT_MP3       1
+#define ML_FMT_WAV_PCM   2
+#define ML_FMT_WAV_ADPCM 3
+#define ML_FMT_RAW_ADPCM 4
+
+typedef struct {
+    uint32_t path_hash;
+    uint32_t path_check;        /* second hash of the path, tells collisions apart */
+    uint32_t dir_hash;          /* path_hash of the directory */
+    uint32_t seen;              /* visit it was last scanned or looked up in */
+    uint32_t file_size;
+    uint32_t file_mtime;
+    uint32_t sample_rate;
+    uint32_t duration;          /* seconds, 0 if unknown */
+    uint8_t format;             /* ML_FMT_* */
+    uint8_t channels;
+    uint8_t duration_exact;     /* duration from a frame count, not a bitrate guess */
+    uint8_t reserved;
+    char title[ML_TITLE_LEN];   /* ASCII, empty if the file has no tag */
+    char artist[ML_ARTIST_LEN];
+} ml_entry_t;
+
+/* Known metadata for dir/name, or NULL. Doesn't touch the file - the entry
+ * may be stale until the scanner has been through the directory. */
+const ml_entry_t *ml_find(const char *dir, const char *name);
+
+/* Start scanning the music files of dir in the background (replaces any
+ * scan in progress) */
+void ml_scan_dir(const char *dir);
+
+/* Scan files for a few milliseconds. Returns 1 while there is more to do,
+ * 0 once the directory is done and the cache written. */
+int ml_scan_step(void);
+
+/* Record an exact duration learned elsewhere (e.g. by the player) */
+void ml_set_duration(const char *path, uint32_t seconds);
+
+/* Write the cache file if anything changed */
+void ml_flush(void);
+
+/* "m:ss" or "h:mm:ss" */
+void ml_format_duration(uint32_t seconds, char *out, int out_size);
+
+#endif /* MUSIC_LIB_H */
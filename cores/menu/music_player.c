@@ -11,6 +11,11 @@
 #include "theme.h"
 #include "render.h"
 #include "gfx_theme.h"  // v64: For background animation
+#include "audio_ring.h"
+#include "audio_resample.h"
+#include "music_lib.h"
+#include "playlist.h"
+#include "adpcm.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,11 +44,10 @@
 #define MP_FMT_RAW_ADPCM 4
 
 // Audio buffer sizes - large buffers needed for smooth playback
-#define MP_AUDIO_RING_SIZE (176 * 1024)
+#define MP_AUDIO_RING_FRAMES (32 * 1024)  // stereo frames, power of two
 #define MP_MAX_AUDIO_BUFFER 4096
 #define MP_MP3_INPUT_BUF_SIZE 16384
 #define MP_MP3_DECODE_BUF_SIZE 4608
-#define MP_ADPCM_DECODE_BUF_SIZE 8192
 
 // Play modes
 #define MP_PLAY_MODE_REPEAT   0
@@ -61,7 +65,6 @@
 #define MP_MAX_FILENAME 128
 
 // Playlist
-#define MP_MAX_PLAYLIST 256
 
 // Window dimensions (same as video_browser)
 #define MP_WIN_X 20
@@ -77,6 +80,8 @@ static FILE *mp_file = NULL;
 static char mp_current_path[MP_MAX_PATH];
 static char mp_current_dir[MP_MAX_PATH];
 static char mp_current_filename[MP_MAX_FILENAME];
+static char mp_display_title[MP_MAX_FILENAME];  // tag title, else filename
+static uint32_t mp_lib_duration = 0;  // exact length from the music library, 0 if unknown
 
 // Audio format info
 static int mp_format = MP_FMT_UNKNOWN;
@@ -88,23 +93,11 @@ static uint32_t mp_data_size = 0;
 static uint32_t mp_file_size = 0;
 
 // ADPCM state
+static int mp_adpcm_kind = ADPCM_MS;
 static int mp_adpcm_block_align = 0;
 static int mp_adpcm_samples_per_block = 0;
-static int mp_adpcm_sample1[2] = {0, 0};
-static int mp_adpcm_sample2[2] = {0, 0};
-static int mp_adpcm_delta[2] = {0, 0};
-static int mp_adpcm_coef_idx[2] = {0, 0};
-
-// ADPCM tables
-static const int mp_adpcm_adapt_table[16] = {
-    230, 230, 230, 230, 307, 409, 512, 614,
-    768, 614, 512, 409, 307, 230, 230, 230
-};
-static const int mp_adpcm_coef1[7] = { 256, 512, 0, 192, 240, 460, 392 };
-static const int mp_adpcm_coef2[7] = { 0, -256, 0, 64, 0, -208, -232 };
 
-// Decode buffers
-static int16_t mp_adpcm_decode_buf[MP_ADPCM_DECODE_BUF_SIZE];
+// Read buffer (one block)
 static uint8_t mp_adpcm_read_buf[8192];
 
 // MP3 decoder state
@@ -116,18 +109,17 @@ static int mp_mp3_input_remaining = 0;
 static int16_t mp_mp3_decode_buf[MP_MP3_DECODE_BUF_SIZE];
 static int mp_mp3_detected_samplerate = 0;
 static int mp_mp3_detected_channels = 0;
+static int mp_mp3_half_rate = 0;  // decoder output is source rate / 2 (44.1/48 kHz sources)
 
-// Audio ring buffer
-static uint8_t *mp_audio_ring = NULL;
-static int mp_aring_read = 0;
-static int mp_aring_write = 0;
-static int mp_aring_count = 0;
+// Audio ring buffer (decoded stereo frames at the source rate)
+static audio_ring_t mp_ring;
 
 // v61: Audio mute after seek to avoid crackle
 static int mp_audio_mute_samples = 0;
 #define MP_AUDIO_MUTE_AFTER_SEEK 4096  // ~93ms at 44.1kHz - covers 2+ batches
 
-// Audio output buffer
+// Audio output buffer (core runs at a fixed 22050 Hz)
+#define MP_OUTPUT_RATE 22050
 static int16_t mp_audio_out_buffer[MP_MAX_AUDIO_BUFFER * 2];
 
 // Audio callback
@@ -154,8 +146,7 @@ static int mp_eof_pending = 0;    // Prevents repeated EOF handling
 static int mp_background_mode = 0;
 
 // Playlist
-static char mp_playlist[MP_MAX_PLAYLIST][MP_MAX_FILENAME];
-static int mp_playlist_count = 0;
+static playlist_t mp_playlist;
 static int mp_playlist_current = -1;
 static int mp_play_mode = MP_PLAY_MODE_REPEAT;
 static int mp_next_track_request = 0;
@@ -176,16 +167,15 @@ static int mp_title_end_timer = 0;    // v59: Module-level end timer
 #define MP_TITLE_MAX_DISPLAY_WIDTH 256  // Max pixels for title display area
 
 // Simple random
-static uint32_t mp_rand_state = 12345;
 
-// Resampling accumulator for fractional sample rates
-static uint32_t mp_resample_acc = 0;
+// Resampler from the decoded rate to MP_OUTPUT_RATE
+static audio_resample_t mp_resampler;
 
 // Forward declarations
 static void mp_reset_state(void);
 static int mp_detect_format(void);
 static int mp_parse_wav_header(void);
-static void mp_read_and_decode_audio(void);
+static int mp_read_and_decode_audio(void);
 static void mp_output_audio(void);
 static void mp_scan_playlist(void);
 
@@ -219,16 +209,22 @@ static int mp_str_ends_with_ci(const char *str, const char *suffix) {
     return mp_strcasecmp(str + str_len - suf_len, suffix) == 0;
 }
 
-static uint32_t mp_rand(void) {
-    mp_rand_state = mp_rand_state * 1103515245 + 12345;
-    return (mp_rand_state >> 16) & 0x7FFF;
-}
-
 // MPEG-1 Layer III bitrate table (kbps), index 0 = free, 15 = bad
 static const int mp3_bitrate_table[16] = {
     0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0
 };
 
+// MPEG-2/2.5 Layer III
+static const int mp3_bitrate_table_v2[16] = {
+    0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0
+};
+
+static const int mp3_samplerate_table[3][3] = {
+    {44100, 48000, 32000},  // MPEG-1
+    {22050, 24000, 16000},  // MPEG-2
+    {11025, 12000,  8000}   // MPEG-2.5
+};
+
 // Parse MP3 frame header to extract bitrate, sample rate, and channels
 // Returns bitrate in kbps, or 0 on failure
 static int mp_parse_mp3_frame_header(const uint8_t *data, int *out_samplerate, int *out_channels) {
@@ -258,9 +254,6 @@ static int mp_parse_mp3_frame_header(const uint8_t *data, int *out_samplerate, i
         bitrate = mp3_bitrate_table[br_index];
     } else if (!is_mpeg1 && layer_bits == 1) {  // MPEG-2/2.5 Layer III
         // Different table for MPEG-2
-        static const int mp3_bitrate_table_v2[16] = {
-            0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0
-        };
         bitrate = mp3_bitrate_table_v2[br_index];
     } else {
         // Other layers - use rough estimate
@@ -269,13 +262,8 @@ static int mp_parse_mp3_frame_header(const uint8_t *data, int *out_samplerate, i
 
     // Get sample rate
     if (out_samplerate) {
-        static const int sr_table[3][3] = {
-            {44100, 48000, 32000},  // MPEG-1
-            {22050, 24000, 16000},  // MPEG-2
-            {11025, 12000,  8000}   // MPEG-2.5
-        };
         int sr_ver = is_mpeg1 ? 0 : (version_bits == 0 ? 2 : 1);
-        *out_samplerate = sr_table[sr_ver][sr_index];
+        *out_samplerate = mp3_samplerate_table[sr_ver][sr_index];
     }
 
     // Get channel mode: byte 3, bits 7-6
@@ -558,74 +546,288 @@ static void mp_draw_icon_next(uint16_t *fb, int x, int y, int size, uint16_t col
 }
 
 // ============================================================================
-// ADPCM decoding (MS ADPCM)
+// MP3 seek index
 // ============================================================================
+// A single bitrate can't place VBR files, so MP3 seeks and duration use a
+// sparse table of (frame number, byte offset) points instead:
+//  - files with a Xing/Info or VBRI header get it from the header's TOC
+//  - other files get it from a header-only scan that walks the frame chain
+//    a few KB per update while playing; when the table fills up, every other
+//    point is dropped and the spacing doubles, so long audiobooks still fit
+
+#define MP_MP3_INDEX_MAX  4096
+#define MP_MP3_SCAN_BYTES 16384  // read per update by the background scan
+
+typedef struct {
+    uint32_t frame;
+    uint32_t offset;
+} mp_mp3_point_t;
+
+// What the Xing/Info or VBRI header says about the file
+typedef struct {
+    uint32_t frames;    // audio frames, 0 if unknown
+    uint32_t bytes;     // bytes the TOC spans, counted from toc_base
+    uint32_t toc_base;  // file offset of the tag frame, where the TOC starts
+    uint32_t start;     // file offset of the first audio frame
+    int has_toc;
+    uint8_t toc[100];   // position at each percent of the frames, in 1/256 of bytes
+} mp_mp3_tag_t;
+
+static mp_mp3_tag_t mp_mp3_tag;
+static mp_mp3_point_t mp_mp3_index[MP_MP3_INDEX_MAX];
+static int mp_mp3_index_count = 0;
+static uint32_t mp_mp3_index_step = 1;     // frames between scanned points
+static uint32_t mp_mp3_total_frames = 0;   // from the tag or a finished scan
+static uint32_t mp_mp3_scan_pos = 0;
+static uint32_t mp_mp3_scan_frames = 0;
+static int mp_mp3_scan_done = 1;
+
+static uint32_t mp_read_u32_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// Samples per Layer III frame: 1152 for MPEG-1 rates, 576 for MPEG-2/2.5
+static int mp_mp3_frame_samples(int sample_rate) {
+    return (sample_rate >= 32000) ? 1152 : 576;
+}
 
-static inline int16_t mp_decode_adpcm_sample(int nibble, int ch) {
-    int signed_nibble = (nibble < 8) ? nibble : (nibble - 16);
-    int pred = ((mp_adpcm_sample1[ch] * mp_adpcm_coef1[mp_adpcm_coef_idx[ch]]) +
-                (mp_adpcm_sample2[ch] * mp_adpcm_coef2[mp_adpcm_coef_idx[ch]])) >> 8;
-    int unsigned_nibble = nibble & 0xF;
-    int sample = pred + signed_nibble * mp_adpcm_delta[ch];
-    if (sample > 32767) sample = 32767;
-    if (sample < -32768) sample = -32768;
-    mp_adpcm_sample2[ch] = mp_adpcm_sample1[ch];
-    mp_adpcm_sample1[ch] = sample;
-    mp_adpcm_delta[ch] = (mp_adpcm_adapt_table[unsigned_nibble] * mp_adpcm_delta[ch]) >> 8;
-    if (mp_adpcm_delta[ch] < 16) mp_adpcm_delta[ch] = 16;
-    return (int16_t)sample;
-}
-
-static int mp_decode_adpcm_block_mono(uint8_t *src, int src_size, int16_t *dst, int max_samples) {
-    if (src_size < 7) return 0;
-    mp_adpcm_coef_idx[0] = src[0];
-    if (mp_adpcm_coef_idx[0] > 6) mp_adpcm_coef_idx[0] = 0;
-    mp_adpcm_delta[0] = (int16_t)(src[1] | (src[2] << 8));
-    mp_adpcm_sample1[0] = (int16_t)(src[3] | (src[4] << 8));
-    mp_adpcm_sample2[0] = (int16_t)(src[5] | (src[6] << 8));
-
-    int out_idx = 0;
-    if (out_idx < max_samples) dst[out_idx++] = mp_adpcm_sample2[0];
-    if (out_idx < max_samples) dst[out_idx++] = mp_adpcm_sample1[0];
-
-    for (int i = 7; i < src_size && out_idx < max_samples; i++) {
-        dst[out_idx++] = mp_decode_adpcm_sample((src[i] >> 4) & 0xF, 0);
-        if (out_idx < max_samples) {
-            dst[out_idx++] = mp_decode_adpcm_sample(src[i] & 0xF, 0);
+// Length in bytes of the Layer III frame starting at h, 0 if h is not a frame header.
+// side_info gets the size of the side information that follows the header.
+static int mp_mp3_frame_length(const uint8_t *h, int *side_info) {
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return 0;
+
+    int version_bits = (h[1] >> 3) & 0x03;
+    if (version_bits == 1) return 0;
+    if (((h[1] >> 1) & 0x03) != 1) return 0;  // Layer III only
+
+    int br_index = (h[2] >> 4) & 0x0F;
+    int sr_index = (h[2] >> 2) & 0x03;
+    if (br_index == 0 || br_index == 15 || sr_index == 3) return 0;
+
+    int is_mpeg1 = (version_bits == 3);
+    int sr_ver = is_mpeg1 ? 0 : (version_bits == 0 ? 2 : 1);
+    int bitrate = is_mpeg1 ? mp3_bitrate_table[br_index] : mp3_bitrate_table_v2[br_index];
+    int sample_rate = mp3_samplerate_table[sr_ver][sr_index];
+    int padding = (h[2] >> 1) & 0x01;
+
+    if (side_info) {
+        int mono = ((h[3] >> 6) & 0x03) == 3;
+        *side_info = is_mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    }
+    return (is_mpeg1 ? 144000 : 72000) * bitrate / sample_rate + padding;
+}
+
+// VBRI table -> percent TOC like Xing's
+static void mp_mp3_vbri_toc(const uint8_t *table, int entries, int entry_size,
+                            uint32_t scale, uint32_t frames_per_entry) {
+    uint64_t cum = 0;
+    int k = 0;
+
+    for (int i = 0; i < 100; i++) {
+        uint32_t f = (uint32_t)((uint64_t)i * mp_mp3_tag.frames / 100);
+        uint64_t size = 0;
+        while (k < entries) {
+            size = 0;
+            for (int b = 0; b < entry_size; b++) size = (size << 8) | table[k * entry_size + b];
+            size *= scale;
+            if ((uint32_t)(k + 1) * frames_per_entry > f) break;
+            cum += size;
+            k++;
         }
+        uint64_t pos = cum;
+        if (k < entries) pos += size * (f - k * frames_per_entry) / frames_per_entry;
+        uint32_t v = (uint32_t)(pos * 256 / mp_mp3_tag.bytes);
+        mp_mp3_tag.toc[i] = (v > 255) ? 255 : v;
     }
-    return out_idx;
+    mp_mp3_tag.has_toc = 1;
 }
 
-static int mp_decode_adpcm_block_stereo(uint8_t *src, int src_size, int16_t *dst, int max_samples) {
-    if (src_size < 14) return 0;
-    mp_adpcm_coef_idx[0] = src[0];
-    mp_adpcm_coef_idx[1] = src[1];
-    if (mp_adpcm_coef_idx[0] > 6) mp_adpcm_coef_idx[0] = 0;
-    if (mp_adpcm_coef_idx[1] > 6) mp_adpcm_coef_idx[1] = 0;
+// Look for a Xing/Info or VBRI header in the first frame
+static void mp_mp3_read_tag(void) {
+    memset(&mp_mp3_tag, 0, sizeof(mp_mp3_tag));
+    if (!mp_file) return;
+
+    uint8_t buf[4096];
+    if (fseek(mp_file, mp_data_offset, SEEK_SET) != 0) return;
+    int got = fread(buf, 1, sizeof(buf), mp_file);
+
+    // First frame header whose successor is a frame header too
+    int pos = 0, len = 0, side_info = 0;
+    for (; pos + 4 <= got; pos++) {
+        len = mp_mp3_frame_length(buf + pos, &side_info);
+        if (len <= 0) continue;
+        if (pos + len + 4 > got || mp_mp3_frame_length(buf + pos + len, NULL) > 0) break;
+    }
+    if (pos + 4 > got) return;
+
+    uint32_t frame_start = mp_data_offset + pos;
+    uint32_t data_end = mp_data_offset + mp_data_size;
+    const uint8_t *x = buf + pos + 4 + side_info;
+    const uint8_t *v = buf + pos + 4 + 32;
+    int xing = 0;
+
+    if (x + 8 <= buf + got && (memcmp(x, "Xing", 4) == 0 || memcmp(x, "Info", 4) == 0)) {
+        xing = 1;
+        uint32_t flags = mp_read_u32_be(x + 4);
+        const uint8_t *q = x + 8;
+        if ((flags & 1) && q + 4 <= buf + got) { mp_mp3_tag.frames = mp_read_u32_be(q); q += 4; }
+        if ((flags & 2) && q + 4 <= buf + got) { mp_mp3_tag.bytes = mp_read_u32_be(q); q += 4; }
+        if ((flags & 4) && q + 100 <= buf + got) {
+            memcpy(mp_mp3_tag.toc, q, 100);
+            mp_mp3_tag.has_toc = 1;
+        } else if (memcmp(x, "Info", 4) == 0) {
+            // Info = CBR: time is linear in bytes
+            for (int i = 0; i < 100; i++) mp_mp3_tag.toc[i] = i * 256 / 100;
+            mp_mp3_tag.has_toc = 1;
+        }
+    } else if (v + 26 <= buf + got && memcmp(v, "VBRI", 4) == 0) {
+        mp_mp3_tag.bytes = mp_read_u32_be(v + 10);
+        mp_mp3_tag.frames = mp_read_u32_be(v + 14);
+        int entries = (v[18] << 8) | v[19];
+        uint32_t scale = (v[20] << 8) | v[21];
+        int entry_size = (v[22] << 8) | v[23];
+        uint32_t frames_per_entry = (v[24] << 8) | v[25];
+        if (mp_mp3_tag.frames > 0 && mp_mp3_tag.bytes > 0 && entries > 0 &&
+            entry_size >= 1 && entry_size <= 4 && frames_per_entry > 0 &&
+            v + 26 + entries * entry_size <= buf + got) {
+            mp_mp3_vbri_toc(v + 26, entries, entry_size, scale, frames_per_entry);
+        }
+    } else {
+        return;
+    }
 
-    mp_adpcm_delta[0] = (int16_t)(src[2] | (src[3] << 8));
-    mp_adpcm_delta[1] = (int16_t)(src[4] | (src[5] << 8));
-    mp_adpcm_sample1[0] = (int16_t)(src[6] | (src[7] << 8));
-    mp_adpcm_sample1[1] = (int16_t)(src[8] | (src[9] << 8));
-    mp_adpcm_sample2[0] = (int16_t)(src[10] | (src[11] << 8));
-    mp_adpcm_sample2[1] = (int16_t)(src[12] | (src[13] << 8));
+    // The tag frame itself carries no audio. Xing offsets count from the start
+    // of the tag frame; the VBRI table is built from the first audio frame.
+    mp_mp3_tag.start = frame_start + len;
+    if (mp_mp3_tag.start > data_end) mp_mp3_tag.start = data_end;
+    mp_mp3_tag.toc_base = xing ? frame_start : mp_mp3_tag.start;
+    if (mp_mp3_tag.bytes == 0 || mp_mp3_tag.bytes > data_end - frame_start) {
+        mp_mp3_tag.bytes = data_end - frame_start;
+    }
+    if (mp_mp3_tag.frames == 0) mp_mp3_tag.has_toc = 0;
+}
 
-    int out_idx = 0;
-    if (out_idx + 1 < max_samples) {
-        dst[out_idx++] = mp_adpcm_sample2[0];
-        dst[out_idx++] = mp_adpcm_sample2[1];
+static void mp_mp3_index_add(uint32_t frame, uint32_t offset) {
+    if (mp_mp3_index_count == MP_MP3_INDEX_MAX) {
+        // Full: keep every other point and double the spacing
+        for (int i = 0; i < MP_MP3_INDEX_MAX / 2; i++) {
+            mp_mp3_index[i] = mp_mp3_index[i * 2];
+        }
+        mp_mp3_index_count = MP_MP3_INDEX_MAX / 2;
+        mp_mp3_index_step *= 2;
+        if (frame % mp_mp3_index_step) return;
     }
-    if (out_idx + 1 < max_samples) {
-        dst[out_idx++] = mp_adpcm_sample1[0];
-        dst[out_idx++] = mp_adpcm_sample1[1];
+    mp_mp3_index[mp_mp3_index_count].frame = frame;
+    mp_mp3_index[mp_mp3_index_count].offset = offset;
+    mp_mp3_index_count++;
+}
+
+// Start the index for a newly opened file (after mp_mp3_read_tag)
+static void mp_mp3_index_reset(void) {
+    mp_mp3_index_count = 0;
+    mp_mp3_total_frames = mp_mp3_tag.frames;
+    mp_mp3_scan_frames = 0;
+    mp_mp3_scan_pos = mp_mp3_tag.start ? mp_mp3_tag.start : mp_data_offset;
+    mp_mp3_scan_done = (mp_format != MP_FMT_MP3);
+
+    // About one point per second
+    int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
+    mp_mp3_index_step = sr / mp_mp3_frame_samples(sr);
+    if (mp_mp3_index_step == 0) mp_mp3_index_step = 1;
+
+    if (mp_format == MP_FMT_MP3 && mp_mp3_tag.has_toc) {
+        for (int i = 0; i < 100; i++) {
+            uint32_t offset = mp_mp3_tag.toc_base +
+                              (uint32_t)((uint64_t)mp_mp3_tag.toc[i] * mp_mp3_tag.bytes / 256);
+            if (offset < mp_mp3_tag.start) offset = mp_mp3_tag.start;
+            mp_mp3_index_add((uint32_t)((uint64_t)i * mp_mp3_tag.frames / 100), offset);
+        }
+        mp_mp3_scan_done = 1;
     }
+}
+
+// Background scan: follow the frame headers for up to MP_MP3_SCAN_BYTES
+static void mp_mp3_scan_step(void) {
+    if (mp_mp3_scan_done || !mp_file) return;
+    // Decoding comes first
+    if (audio_ring_count(&mp_ring) < MP_AUDIO_RING_FRAMES / 2) return;
+
+    uint8_t buf[4096];
+    uint32_t data_end = mp_data_offset + mp_data_size;
+    int budget = MP_MP3_SCAN_BYTES;
+
+    while (budget > 0) {
+        uint32_t want = data_end - mp_mp3_scan_pos;
+        if (mp_mp3_scan_pos + 4 > data_end) want = 0;
+        if (want > sizeof(buf)) want = sizeof(buf);
 
-    for (int i = 14; i < src_size && out_idx + 1 < max_samples; i++) {
-        dst[out_idx++] = mp_decode_adpcm_sample((src[i] >> 4) & 0xF, 0);
-        dst[out_idx++] = mp_decode_adpcm_sample(src[i] & 0xF, 1);
+        int got = 0;
+        if (want > 0 && fseek(mp_file, mp_mp3_scan_pos, SEEK_SET) == 0) {
+            got = fread(buf, 1, want, mp_file);
+        }
+        if (got < 4) {
+            // Reached the end: the frame count is exact now
+            mp_mp3_scan_done = 1;
+            if (mp_mp3_total_frames == 0) mp_mp3_total_frames = mp_mp3_scan_frames;
+            return;
+        }
+        budget -= got;
+
+        int i = 0;
+        while (i + 4 <= got) {
+            int len = mp_mp3_frame_length(buf + i, NULL);
+            if (len <= 0) {
+                i++;  // lost sync (tags, junk) - search for the next header
+                continue;
+            }
+            if (mp_mp3_scan_frames % mp_mp3_index_step == 0) {
+                mp_mp3_index_add(mp_mp3_scan_frames, mp_mp3_scan_pos + i);
+            }
+            mp_mp3_scan_frames++;
+            i += len;
+        }
+        mp_mp3_scan_pos += i;  // may point past buf: next header is in the next read
     }
-    return out_idx;
+}
+
+// File offset to decode from to reach target_frame; *frame gets the frame
+// number actually landed on. Returns 0 if the index has nothing yet.
+static uint32_t mp_mp3_index_find(uint32_t target_frame, uint32_t *frame) {
+    if (mp_mp3_index_count == 0) return 0;
+
+    // Last point at or before the target
+    int lo = 0, hi = mp_mp3_index_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (mp_mp3_index[mid].frame <= target_frame) lo = mid;
+        else hi = mid - 1;
+    }
+    const mp_mp3_point_t *p = &mp_mp3_index[lo];
+    if (p->frame >= target_frame) {
+        *frame = p->frame;
+        return p->offset;
+    }
+
+    // Between two points (or past the scanned part): interpolate
+    uint32_t f0 = p->frame, o0 = p->offset, f1, o1;
+    if (lo + 1 < mp_mp3_index_count) {
+        f1 = mp_mp3_index[lo + 1].frame;
+        o1 = mp_mp3_index[lo + 1].offset;
+    } else if (mp_mp3_total_frames > f0) {
+        f1 = mp_mp3_total_frames;
+        o1 = mp_data_offset + mp_data_size;
+    } else {
+        // Past the scanned part: extrapolate with the average frame size so far
+        f1 = f0;
+        o1 = o0;
+        f0 = mp_mp3_index[0].frame;
+        o0 = mp_mp3_index[0].offset;
+        if (f1 == f0) return 0;
+    }
+    *frame = target_frame;
+    uint64_t off = o0 + (uint64_t)(target_frame - f0) * (o1 - o0) / (f1 - f0);
+    if (off >= mp_data_offset + mp_data_size) return 0;
+    return (uint32_t)off;
 }
 
 // ============================================================================
@@ -677,7 +879,7 @@ static void mp_mp3_resync(void) {
     }
 }
 
-static void mp_mp3_reset(void) {
+static void mp_mp3_reset_decoder(void) {
     // Reset decoder state but KEEP sample rate/channels/bitrate
     // (they are constant for the entire file)
     if (mp_mp3_initialized && mp_mp3_handle) {
@@ -686,6 +888,10 @@ static void mp_mp3_reset(void) {
     }
     mp_mp3_input_len = 0;
     mp_mp3_input_remaining = 0;
+}
+
+static void mp_mp3_reset(void) {
+    mp_mp3_reset_decoder();
 
     // Resync to next valid MP3 frame after seek
     mp_mp3_resync();
@@ -740,12 +946,11 @@ static int mp_read_audio_mp3(void) {
     mp_mp3_init();
     if (!mp_mp3_handle) return 0;
 
-    int total_decoded_bytes = 0;
-    int free_space = MP_AUDIO_RING_SIZE - mp_aring_count;
+    int total_decoded_frames = 0;
     int consecutive_errors = 0;
     int loop_iterations = 0;  // v58: Safety counter to prevent infinite loops
 
-    while (free_space > 512 && consecutive_errors < 100 && loop_iterations < 500) {
+    while (audio_ring_space(&mp_ring) > 128 && consecutive_errors < 100 && loop_iterations < 500) {
         loop_iterations++;
 
         // v58: Check EOF status each iteration (file_pos updated during loop)
@@ -765,16 +970,21 @@ static int mp_read_audio_mp3(void) {
         int bytes_done = 0;
         int out_buf_size = MP_MP3_DECODE_BUF_SIZE * sizeof(int16_t);
 
+        // 44.1/48 kHz: let the polyphase synthesis produce ~22 kHz directly
+        int source_rate = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
+        mp_mp3_half_rate = (source_rate >= 2 * MP_OUTPUT_RATE);
+
         int result = mad_decode(mp_mp3_handle,
                                 (char *)mp_mp3_input_buf, mp_mp3_input_len,
                                 (char *)mp_mp3_decode_buf, out_buf_size,
-                                &bytes_read, &bytes_done, 16, 0);
+                                &bytes_read, &bytes_done, 16, mp_mp3_half_rate);
 
         if (result == MAD_OK) {
             consecutive_errors = 0;
             if (mp_mp3_detected_samplerate == 0) {
                 int sr = 0, ch = 0;
                 if (mad_get_info(mp_mp3_handle, &sr, &ch)) {
+                    if (mp_mp3_half_rate) sr *= 2;  // mad reports the synthesized rate
                     mp_mp3_detected_samplerate = sr;
                     mp_mp3_detected_channels = ch;
                     mp_sample_rate = sr;
@@ -824,52 +1034,15 @@ static int mp_read_audio_mp3(void) {
         // Handle mono->stereo conversion
         int actual_channels = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
         if (actual_channels == 1) {
-            int mono_samples = bytes_done / 2;
-            int stereo_bytes = mono_samples * 4;
-
-            if (stereo_bytes > free_space) {
-                mono_samples = free_space / 4;
-                stereo_bytes = mono_samples * 4;
-            }
-
-            int16_t *mono_src = (int16_t *)mp_mp3_decode_buf;
-            for (int i = 0; i < mono_samples; i++) {
-                int16_t sample = mono_src[i];
-                mp_audio_ring[mp_aring_write] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 1] = (sample >> 8) & 0xFF;
-                mp_audio_ring[mp_aring_write + 2] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 3] = (sample >> 8) & 0xFF;
-                mp_aring_write = (mp_aring_write + 4) % MP_AUDIO_RING_SIZE;
-            }
-
-            mp_aring_count += stereo_bytes;
-            free_space -= stereo_bytes;
-            total_decoded_bytes += stereo_bytes;
+            total_decoded_frames += audio_ring_write_mono(&mp_ring, mp_mp3_decode_buf, bytes_done / 2);
         } else {
-            int decoded_bytes = bytes_done;
-            if (decoded_bytes > free_space) decoded_bytes = free_space;
-
-            uint8_t *src = (uint8_t *)mp_mp3_decode_buf;
-            int written = 0;
-            while (written < decoded_bytes) {
-                int before_wrap = MP_AUDIO_RING_SIZE - mp_aring_write;
-                int to_write = decoded_bytes - written;
-                if (to_write > before_wrap) to_write = before_wrap;
-
-                memcpy(mp_audio_ring + mp_aring_write, src + written, to_write);
-                mp_aring_write = (mp_aring_write + to_write) % MP_AUDIO_RING_SIZE;
-                written += to_write;
-            }
-
-            mp_aring_count += decoded_bytes;
-            free_space -= decoded_bytes;
-            total_decoded_bytes += decoded_bytes;
+            total_decoded_frames += audio_ring_write(&mp_ring, mp_mp3_decode_buf, bytes_done / 4);
         }
 
-        if (total_decoded_bytes > 4096) break;
+        if (total_decoded_frames > 1024) break;
     }
 
-    return total_decoded_bytes;
+    return total_decoded_frames;
 }
 
 // ============================================================================
@@ -877,99 +1050,69 @@ static int mp_read_audio_mp3(void) {
 // ============================================================================
 
 static int mp_read_audio_pcm(void) {
-    int free_space = MP_AUDIO_RING_SIZE - mp_aring_count;
-    if (free_space < 1024) return 0;
+    uint32_t frames = audio_ring_space(&mp_ring);
+    if (frames < 256) return 0;
+    if (frames > 1024) frames = 1024;
 
     uint32_t remaining_in_file = mp_data_size - (mp_file_pos - mp_data_offset);
     if (remaining_in_file == 0) return 0;
 
-    int to_read = (free_space < (int)remaining_in_file) ? free_space : (int)remaining_in_file;
-    if (to_read > 4096) to_read = 4096;
-
-    // For 8-bit or mono, we need to convert
-    if (mp_bits_per_sample == 8 || mp_channels == 1) {
-        uint8_t temp_buf[4096];
-        int src_bytes = to_read;
-
-        // Calculate how many source bytes we need for the output
-        if (mp_bits_per_sample == 8 && mp_channels == 1) {
-            src_bytes = to_read / 4;  // 1 byte -> 4 bytes (8bit mono -> 16bit stereo)
-        } else if (mp_bits_per_sample == 8) {
-            src_bytes = to_read / 2;  // 2 bytes -> 4 bytes (8bit stereo -> 16bit stereo)
-        } else if (mp_channels == 1) {
-            src_bytes = to_read / 2;  // 2 bytes -> 4 bytes (16bit mono -> 16bit stereo)
-        }
-
-        if (src_bytes > (int)remaining_in_file) src_bytes = remaining_in_file;
-        if (src_bytes > (int)sizeof(temp_buf)) src_bytes = sizeof(temp_buf);
-
-        if (fseek(mp_file, mp_file_pos, SEEK_SET) != 0) return 0;
-        size_t got = fread(temp_buf, 1, src_bytes, mp_file);
-        if (got == 0) return 0;
-        mp_file_pos += got;
+    int convert = (mp_bits_per_sample == 8 || mp_channels == 1);
+    uint32_t frame_bytes = 4;
+    if (mp_bits_per_sample == 8) frame_bytes = mp_channels;
+    else if (mp_channels == 1) frame_bytes = 2;
 
-        int out_bytes = 0;
-
-        if (mp_bits_per_sample == 8 && mp_channels == 1) {
-            // 8-bit mono -> 16-bit stereo
-            for (size_t i = 0; i < got && mp_aring_count < MP_AUDIO_RING_SIZE - 4; i++) {
-                int16_t sample = (int16_t)((temp_buf[i] - 128) << 8);
-                mp_audio_ring[mp_aring_write] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 1] = (sample >> 8) & 0xFF;
-                mp_audio_ring[mp_aring_write + 2] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 3] = (sample >> 8) & 0xFF;
-                mp_aring_write = (mp_aring_write + 4) % MP_AUDIO_RING_SIZE;
-                mp_aring_count += 4;
-                out_bytes += 4;
-            }
-        } else if (mp_bits_per_sample == 8) {
-            // 8-bit stereo -> 16-bit stereo
-            for (size_t i = 0; i + 1 < got && mp_aring_count < MP_AUDIO_RING_SIZE - 4; i += 2) {
-                int16_t left = (int16_t)((temp_buf[i] - 128) << 8);
-                int16_t right = (int16_t)((temp_buf[i+1] - 128) << 8);
-                mp_audio_ring[mp_aring_write] = left & 0xFF;
-                mp_audio_ring[mp_aring_write + 1] = (left >> 8) & 0xFF;
-                mp_audio_ring[mp_aring_write + 2] = right & 0xFF;
-                mp_audio_ring[mp_aring_write + 3] = (right >> 8) & 0xFF;
-                mp_aring_write = (mp_aring_write + 4) % MP_AUDIO_RING_SIZE;
-                mp_aring_count += 4;
-                out_bytes += 4;
-            }
-        } else {
-            // 16-bit mono -> 16-bit stereo
-            for (size_t i = 0; i + 1 < got && mp_aring_count < MP_AUDIO_RING_SIZE - 4; i += 2) {
-                int16_t sample = temp_buf[i] | (temp_buf[i+1] << 8);
-                mp_audio_ring[mp_aring_write] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 1] = (sample >> 8) & 0xFF;
-                mp_audio_ring[mp_aring_write + 2] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 3] = (sample >> 8) & 0xFF;
-                mp_aring_write = (mp_aring_write + 4) % MP_AUDIO_RING_SIZE;
-                mp_aring_count += 4;
-                out_bytes += 4;
-            }
-        }
-        return out_bytes;
+    if (remaining_in_file < frame_bytes) {
+        mp_file_pos += remaining_in_file;  // trailing partial frame
+        return 0;
     }
+    if (frames > remaining_in_file / frame_bytes) frames = remaining_in_file / frame_bytes;
 
-    // 16-bit stereo - direct copy
     if (fseek(mp_file, mp_file_pos, SEEK_SET) != 0) return 0;
 
-    int written = 0;
-    while (written < to_read) {
-        int before_wrap = MP_AUDIO_RING_SIZE - mp_aring_write;
-        int chunk = to_read - written;
-        if (chunk > before_wrap) chunk = before_wrap;
+    audio_ring_span_t span;
+    uint32_t done = 0;
 
-        size_t got = fread(mp_audio_ring + mp_aring_write, 1, chunk, mp_file);
-        if (got == 0) break;
-
-        mp_file_pos += got;
-        mp_aring_write = (mp_aring_write + got) % MP_AUDIO_RING_SIZE;
-        mp_aring_count += got;
-        written += got;
+    if (!convert) {
+        // 16-bit stereo - read straight into the ring
+        audio_ring_write_span(&mp_ring, &span, frames);
+        for (int k = 0; k < 2 && span.n[k] > 0; k++) {
+            size_t got = fread(span.p[k], 4, span.n[k], mp_file);
+            done += got;
+            if (got < span.n[k]) break;
+        }
+        mp_file_pos += done * 4;
+        audio_ring_commit_write(&mp_ring, done);
+        return done;
+    }
+
+    // 8-bit or mono -> 16-bit stereo
+    uint8_t temp_buf[4096];
+    if (frames > sizeof(temp_buf) / frame_bytes) frames = sizeof(temp_buf) / frame_bytes;
+    done = fread(temp_buf, frame_bytes, frames, mp_file);
+    if (done == 0) return 0;
+    mp_file_pos += done * frame_bytes;
+
+    const uint8_t *src = temp_buf;
+    audio_ring_write_span(&mp_ring, &span, done);
+    for (int k = 0; k < 2; k++) {
+        int16_t *dst = span.p[k];
+        for (uint32_t i = 0; i < span.n[k]; i++, dst += 2) {
+            if (mp_bits_per_sample == 8 && mp_channels == 1) {
+                dst[0] = dst[1] = (int16_t)((src[0] - 128) << 8);
+                src += 1;
+            } else if (mp_bits_per_sample == 8) {
+                dst[0] = (int16_t)((src[0] - 128) << 8);
+                dst[1] = (int16_t)((src[1] - 128) << 8);
+                src += 2;
+            } else {
+                dst[0] = dst[1] = (int16_t)(src[0] | (src[1] << 8));
+                src += 2;
+            }
+        }
     }
-
-    return written;
+    audio_ring_commit_write(&mp_ring, done);
+    return done;
 }
 
 // ============================================================================
@@ -978,16 +1121,20 @@ static int mp_read_audio_pcm(void) {
 
 static int mp_read_audio_adpcm(void) {
     if (mp_adpcm_block_align <= 0) return 0;
+    if (mp_channels < 1 || mp_channels > 2) return 0;
 
-    int free_space = MP_AUDIO_RING_SIZE - mp_aring_count;
-    if (free_space < 1024) return 0;
+    // Blocks are decoded straight into the ring, so wait for room for a whole one
+    int max_block = mp_adpcm_block_align;
+    if (max_block > (int)sizeof(mp_adpcm_read_buf)) max_block = sizeof(mp_adpcm_read_buf);
+    uint32_t block_frames = adpcm_block_frames(mp_adpcm_kind, max_block, mp_channels);
+    if (audio_ring_space(&mp_ring) < block_frames) return 0;
 
     uint32_t remaining_in_file = mp_data_size - (mp_file_pos - mp_data_offset);
     if (remaining_in_file == 0) return 0;
 
-    int total_decoded_bytes = 0;
+    int total_decoded_frames = 0;
 
-    while (free_space > 1024 && remaining_in_file > 0) {
+    while (audio_ring_space(&mp_ring) >= block_frames && remaining_in_file > 0) {
         int block_size = mp_adpcm_block_align;
         if (block_size > (int)remaining_in_file) block_size = remaining_in_file;
         if (block_size > (int)sizeof(mp_adpcm_read_buf)) block_size = sizeof(mp_adpcm_read_buf);
@@ -1000,53 +1147,13 @@ static int mp_read_audio_adpcm(void) {
         mp_file_pos += got;
         remaining_in_file -= got;
 
-        int samples;
-        if (mp_channels == 1) {
-            samples = mp_decode_adpcm_block_mono(mp_adpcm_read_buf, got, mp_adpcm_decode_buf, MP_ADPCM_DECODE_BUF_SIZE);
-        } else {
-            samples = mp_decode_adpcm_block_stereo(mp_adpcm_read_buf, got, mp_adpcm_decode_buf, MP_ADPCM_DECODE_BUF_SIZE);
-        }
-
-        if (samples <= 0) continue;
-
-        // Convert to stereo if mono
-        if (mp_channels == 1) {
-            for (int i = 0; i < samples && mp_aring_count < MP_AUDIO_RING_SIZE - 4; i++) {
-                int16_t sample = mp_adpcm_decode_buf[i];
-                mp_audio_ring[mp_aring_write] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 1] = (sample >> 8) & 0xFF;
-                mp_audio_ring[mp_aring_write + 2] = sample & 0xFF;
-                mp_audio_ring[mp_aring_write + 3] = (sample >> 8) & 0xFF;
-                mp_aring_write = (mp_aring_write + 4) % MP_AUDIO_RING_SIZE;
-                mp_aring_count += 4;
-                free_space -= 4;
-                total_decoded_bytes += 4;
-            }
-        } else {
-            int decoded_bytes = samples * 2;
-            if (decoded_bytes > free_space) decoded_bytes = free_space;
-
-            uint8_t *src = (uint8_t *)mp_adpcm_decode_buf;
-            int written = 0;
-            while (written < decoded_bytes) {
-                int before_wrap = MP_AUDIO_RING_SIZE - mp_aring_write;
-                int to_write = decoded_bytes - written;
-                if (to_write > before_wrap) to_write = before_wrap;
-
-                memcpy(mp_audio_ring + mp_aring_write, src + written, to_write);
-                mp_aring_write = (mp_aring_write + to_write) % MP_AUDIO_RING_SIZE;
-                written += to_write;
-            }
-
-            mp_aring_count += decoded_bytes;
-            free_space -= decoded_bytes;
-            total_decoded_bytes += decoded_bytes;
-        }
+        total_decoded_frames += adpcm_decode_block(mp_adpcm_kind, mp_adpcm_read_buf, got,
+                                                   mp_channels, &mp_ring);
 
-        if (total_decoded_bytes > 4096) break;
+        if (total_decoded_frames > 1024) break;
     }
 
-    return total_decoded_bytes;
+    return total_decoded_frames;
 }
 
 // ============================================================================
@@ -1103,16 +1210,16 @@ static int mp_parse_wav_header(void) {
             if (format_tag == 1) {
                 // PCM
                 mp_format = MP_FMT_WAV_PCM;
-            } else if (format_tag == 2) {
-                // MS ADPCM
+            } else if (adpcm_kind_from_tag(format_tag) >= 0) {
+                // MS ADPCM or IMA ADPCM
                 mp_format = MP_FMT_WAV_ADPCM;
+                mp_adpcm_kind = adpcm_kind_from_tag(format_tag);
                 mp_adpcm_block_align = mp_read_u16_le(header + 20);
                 if (chunk_size >= 20) {
                     mp_adpcm_samples_per_block = mp_read_u16_le(header + 26);
                 } else {
                     // Calculate samples per block
-                    int header_size = (mp_channels == 1) ? 7 : 14;
-                    mp_adpcm_samples_per_block = 2 + (mp_adpcm_block_align - header_size) * 2 / mp_channels;
+                    mp_adpcm_samples_per_block = adpcm_block_frames(mp_adpcm_kind, mp_adpcm_block_align, mp_channels);
                 }
             } else {
                 return 0;  // Unsupported format
@@ -1189,122 +1296,367 @@ static int mp_is_music_file(const char *name) {
            mp_str_ends_with_ci(name, ".adpcm");
 }
 
-static void mp_sort_playlist(void) {
-    // Simple bubble sort for A-Z
-    for (int i = 0; i < mp_playlist_count - 1; i++) {
-        for (int j = 0; j < mp_playlist_count - i - 1; j++) {
-            if (mp_strcasecmp(mp_playlist[j], mp_playlist[j+1]) > 0) {
-                char temp[MP_MAX_FILENAME];
-                strncpy(temp, mp_playlist[j], MP_MAX_FILENAME - 1);
-                strncpy(mp_playlist[j], mp_playlist[j+1], MP_MAX_FILENAME - 1);
-                strncpy(mp_playlist[j+1], temp, MP_MAX_FILENAME - 1);
-            }
-        }
+// Shuffle successor picked for mp_shuffle_from
+static int mp_shuffle_from = -1;
+static int mp_shuffle_pick = -1;
+
+// Shuffle entry after the current track. Asked again for the same track (a
+// lookahead cancelled by a seek, then the track change itself) it gives the
+// same answer, so the end of a cycle draws only one new permutation.
+static int mp_shuffle_next(void) {
+    if (mp_shuffle_from != mp_playlist_current || mp_shuffle_pick < 0) {
+        mp_shuffle_pick = playlist_shuffle_next(&mp_playlist, mp_playlist_current);
+        mp_shuffle_from = mp_playlist_current;
     }
+    return mp_shuffle_pick;
 }
 
 static void mp_scan_playlist(void) {
-    mp_playlist_count = 0;
-    mp_playlist_current = -1;
+    playlist_scan(&mp_playlist, mp_current_dir, mp_is_music_file);
+    mp_playlist_current = playlist_find(&mp_playlist, mp_current_filename);
+    mp_shuffle_from = -1;
+}
 
-#ifdef SF2000
-    union {
-        struct {
-            uint8_t _1[0x10];
-            uint32_t type;
-        };
-        struct {
-            uint8_t _2[0x22];
-            char d_name[0x225];
-        };
-        uint8_t __[0x428];
-    } buffer;
-
-    int dir_fd = fs_opendir(mp_current_dir);
-    if (dir_fd < 0) return;
-
-    while (fs_readdir(dir_fd, &buffer) >= 0 && mp_playlist_count < MP_MAX_PLAYLIST) {
-        if (buffer.type == 0x4000) continue;  // Skip directories
-        if (!mp_is_music_file(buffer.d_name)) continue;
-
-        strncpy(mp_playlist[mp_playlist_count], buffer.d_name, MP_MAX_FILENAME - 1);
-        mp_playlist[mp_playlist_count][MP_MAX_FILENAME - 1] = '\0';
-
-        if (mp_strcasecmp(buffer.d_name, mp_current_filename) == 0) {
-            mp_playlist_current = mp_playlist_count;
-        }
-        mp_playlist_count++;
-    }
+static int mp_load_next_az(void) {
+    if (playlist_count(&mp_playlist) <= 1) return 0;
+    int next_idx = (mp_playlist_current + 1) % playlist_count(&mp_playlist);
 
-    fs_closedir(dir_fd);
-#else
-    DIR *dir = opendir(mp_current_dir);
-    if (!dir) return;
+    char new_path[MP_MAX_PATH];
+    snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, playlist_name(&mp_playlist, next_idx));
+
+    mp_close();
+    return mp_open(new_path);
+}
+
+static int mp_load_shuffle(void) {
+    int next_idx = mp_shuffle_next();
+    if (next_idx < 0) return 0;
+
+    char new_path[MP_MAX_PATH];
+    snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, playlist_name(&mp_playlist, next_idx));
+
+    mp_close();
+    return mp_open(new_path);
+}
+
+
+// ============================================================================
+// Gapless playback
+// ============================================================================
+// While the current track still has MP_GAPLESS_LOOKAHEAD_SEC to go, the next
+// playlist entry is opened and parsed with the usual format code, one step
+// per frame (open, format, MP3 header, MP3 tag, first frame sync), and the
+// result is parked in mp_next. Once the current file is fully decoded, its
+// decoder state is swapped for the prepared one and decoding carries on into
+// the same ring, right behind the last frames of the old track - no file
+// reads or directory scan in the frame of the switch, and no gap.
+//
+// The UI (title, track number, position, duration) keeps showing the old
+// track until playback actually reaches the first frame of the new one.
+
+#define MP_GAPLESS_LOOKAHEAD_SEC 5
+
+// Everything the decoder needs to know about a file
+typedef struct {
+    FILE *file;
+    int format;
+    int sample_rate;
+    int channels;
+    int bits_per_sample;
+    uint32_t data_offset;
+    uint32_t data_size;
+    uint32_t file_size;
+    uint32_t file_pos;
+    int adpcm_kind;
+    int adpcm_block_align;
+    int adpcm_samples_per_block;
+    int mp3_bitrate;
+    int mp3_bitrate_from_header;
+    int mp3_detected_samplerate;
+    int mp3_detected_channels;
+    mp_mp3_tag_t mp3_tag;
+} mp_track_t;
+
+// Lookahead steps, one per frame
+enum {
+    MP_NEXT_NONE,       // not started for this track
+    MP_NEXT_OPEN,
+    MP_NEXT_FORMAT,
+    MP_NEXT_MP3_HEADER,
+    MP_NEXT_MP3_TAG,
+    MP_NEXT_MP3_SYNC,
+    MP_NEXT_READY,      // mp_next holds an open, parsed file
+    MP_NEXT_FAILED      // no next track, or it can't be played
+};
+
+static mp_track_t mp_next;
+static int mp_next_state = MP_NEXT_NONE;
+static int mp_next_index = -1;      // playlist entry of mp_next
+static char mp_next_path[MP_MAX_PATH];
+
+// Old track frames still in the ring after a gapless switch
+static int mp_gapless_pending = 0;
+static uint32_t mp_gapless_frames_left = 0;
+static int mp_gapless_old_duration = 0;
+
+static void mp_reset_format(void) {
+    mp_format = MP_FMT_UNKNOWN;
+    mp_sample_rate = 44100;
+    mp_channels = 2;
+    mp_bits_per_sample = 16;
+    mp_data_offset = 0;
+    mp_data_size = 0;
+    mp_file_size = 0;
+    mp_file_pos = 0;
+    mp_adpcm_kind = ADPCM_MS;
+    mp_adpcm_block_align = 0;
+    mp_adpcm_samples_per_block = 0;
+    memset(&mp_mp3_tag, 0, sizeof(mp_mp3_tag));
+}
+
+static void mp_track_save(mp_track_t *t) {
+    t->file = mp_file;
+    t->format = mp_format;
+    t->sample_rate = mp_sample_rate;
+    t->channels = mp_channels;
+    t->bits_per_sample = mp_bits_per_sample;
+    t->data_offset = mp_data_offset;
+    t->data_size = mp_data_size;
+    t->file_size = mp_file_size;
+    t->file_pos = mp_file_pos;
+    t->adpcm_kind = mp_adpcm_kind;
+    t->adpcm_block_align = mp_adpcm_block_align;
+    t->adpcm_samples_per_block = mp_adpcm_samples_per_block;
+    t->mp3_bitrate = mp_mp3_bitrate;
+    t->mp3_bitrate_from_header = mp_mp3_bitrate_from_header;
+    t->mp3_detected_samplerate = mp_mp3_detected_samplerate;
+    t->mp3_detected_channels = mp_mp3_detected_channels;
+    t->mp3_tag = mp_mp3_tag;
+}
+
+static void mp_track_load(const mp_track_t *t) {
+    mp_file = t->file;
+    mp_format = t->format;
+    mp_sample_rate = t->sample_rate;
+    mp_channels = t->channels;
+    mp_bits_per_sample = t->bits_per_sample;
+    mp_data_offset = t->data_offset;
+    mp_data_size = t->data_size;
+    mp_file_size = t->file_size;
+    mp_file_pos = t->file_pos;
+    mp_adpcm_kind = t->adpcm_kind;
+    mp_adpcm_block_align = t->adpcm_block_align;
+    mp_adpcm_samples_per_block = t->adpcm_samples_per_block;
+    mp_mp3_bitrate = t->mp3_bitrate;
+    mp_mp3_bitrate_from_header = t->mp3_bitrate_from_header;
+    mp_mp3_detected_samplerate = t->mp3_detected_samplerate;
+    mp_mp3_detected_channels = t->mp3_detected_channels;
+    mp_mp3_tag = t->mp3_tag;
+}
 
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL && mp_playlist_count < MP_MAX_PLAYLIST) {
-        if (entry->d_type == DT_DIR) continue;
-        if (!mp_is_music_file(entry->d_name)) continue;
+// Rate of the frames a track puts in the ring (44.1/48 kHz MP3 is synthesized at half rate)
+static int mp_track_ring_rate(const mp_track_t *t) {
+    int sr = t->sample_rate;
+    if (t->format == MP_FMT_MP3) {
+        if (t->mp3_detected_samplerate > 0) sr = t->mp3_detected_samplerate;
+        if (sr >= 2 * MP_OUTPUT_RATE) sr /= 2;
+    }
+    return sr;
+}
 
-        strncpy(mp_playlist[mp_playlist_count], entry->d_name, MP_MAX_FILENAME - 1);
-        mp_playlist[mp_playlist_count][MP_MAX_FILENAME - 1] = '\0';
+// Playlist entry that follows the current track in this play mode, -1 if none
+static int mp_gapless_pick_next(void) {
+    if (mp_playlist_current < 0) return -1;
+
+    switch (mp_play_mode) {
+        case MP_PLAY_MODE_REPEAT:
+            if (playlist_count(&mp_playlist) <= 1) return mp_playlist_current;  // loop the only track
+            return (mp_playlist_current + 1) % playlist_count(&mp_playlist);
+        case MP_PLAY_MODE_AZ:
+            if (playlist_count(&mp_playlist) <= 1) return -1;
+            return (mp_playlist_current + 1) % playlist_count(&mp_playlist);
+        case MP_PLAY_MODE_SHUFFLE:
+            return mp_shuffle_next();
+        default:
+            return -1;
+    }
+}
 
-        if (mp_strcasecmp(entry->d_name, mp_current_filename) == 0) {
-            mp_playlist_current = mp_playlist_count;
+// One lookahead step: open and parse the next track into mp_next, leaving
+// the current one untouched. The format code works on the mp_ globals, so
+// mp_next is swapped in for the step.
+static void mp_gapless_prepare_step(void) {
+    if (mp_next_state == MP_NEXT_NONE) mp_next_state = MP_NEXT_OPEN;
+
+    mp_track_t cur;
+    mp_track_save(&cur);
+    char cur_path[MP_MAX_PATH];
+    strcpy(cur_path, mp_current_path);
+
+    int ok = 1;
+    if (mp_next_state == MP_NEXT_OPEN) {
+        int idx = mp_gapless_pick_next();
+        snprintf(mp_next_path, MP_MAX_PATH, "%s/%s", mp_current_dir,
+                 idx >= 0 ? playlist_name(&mp_playlist, idx) : "");
+        mp_reset_format();
+        mp_mp3_detected_samplerate = 0;
+        mp_mp3_detected_channels = 0;
+        mp_mp3_bitrate = 128;
+        mp_mp3_bitrate_from_header = 0;
+        mp_file = (idx >= 0) ? fopen(mp_next_path, "rb") : NULL;
+        ok = (mp_file != NULL);
+        mp_next_index = idx;
+        mp_next_state = MP_NEXT_FORMAT;
+    } else {
+        // mp_detect_format looks at mp_current_path for the extension
+        mp_track_load(&mp_next);
+        strcpy(mp_current_path, mp_next_path);
+
+        switch (mp_next_state) {
+            case MP_NEXT_FORMAT:
+                ok = mp_detect_format();
+                mp_next_state = (mp_format == MP_FMT_MP3) ? MP_NEXT_MP3_HEADER : MP_NEXT_READY;
+                break;
+            case MP_NEXT_MP3_HEADER:
+                mp_scan_mp3_header();
+                mp_next_state = MP_NEXT_MP3_TAG;
+                break;
+            case MP_NEXT_MP3_TAG:
+                mp_mp3_read_tag();
+                mp_next_state = MP_NEXT_MP3_SYNC;
+                break;
+            case MP_NEXT_MP3_SYNC:
+                // Done here so the switch itself doesn't read the file
+                mp_mp3_resync();
+                mp_next_state = MP_NEXT_READY;
+                break;
         }
-        mp_playlist_count++;
+        if (!ok) fclose(mp_file);
     }
 
-    closedir(dir);
-#endif
+    if (ok) {
+        mp_track_save(&mp_next);
+    } else {
+        mp_next_state = MP_NEXT_FAILED;
+    }
 
-    mp_sort_playlist();
+    mp_track_load(&cur);
+    strcpy(mp_current_path, cur_path);
+}
 
-    // Find current file in sorted list
-    for (int i = 0; i < mp_playlist_count; i++) {
-        if (mp_strcasecmp(mp_playlist[i], mp_current_filename) == 0) {
-            mp_playlist_current = i;
-            break;
-        }
+// Drop the lookahead; it starts over from the current position
+static void mp_gapless_cancel(void) {
+    if (mp_next_state > MP_NEXT_OPEN && mp_next_state <= MP_NEXT_READY && mp_next.file) {
+        fclose(mp_next.file);
     }
+    mp_next_state = MP_NEXT_NONE;
+    mp_gapless_pending = 0;
 }
 
-static int mp_load_next_az(void) {
-    if (mp_playlist_count <= 1) return 0;
-    int next_idx = (mp_playlist_current + 1) % mp_playlist_count;
+// Tag title and exact length of the current file from the music library
+static void mp_lib_lookup(void) {
+    const ml_entry_t *e = ml_find(mp_current_dir, mp_current_filename);
+    if (e && e->file_size != mp_file_size) e = NULL;  // changed since it was scanned
 
-    char new_path[MP_MAX_PATH];
-    snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, mp_playlist[next_idx]);
+    mp_lib_duration = (e && e->duration_exact) ? e->duration : 0;
+    if (e && e->title[0] && e->artist[0]) {
+        snprintf(mp_display_title, sizeof(mp_display_title), "%s - %s", e->artist, e->title);
+    } else if (e && e->title[0]) {
+        snprintf(mp_display_title, sizeof(mp_display_title), "%s", e->title);
+    } else {
+        snprintf(mp_display_title, sizeof(mp_display_title), "%s", mp_current_filename);
+    }
+}
 
-    mp_close();
-    return mp_open(new_path);
+// Keep the exact MP3 length a finished scan found, so the browser shows it
+static void mp_lib_remember(void) {
+    if (mp_format == MP_FMT_MP3 && mp_mp3_scan_done && !mp_gapless_pending) {
+        ml_set_duration(mp_current_path, (uint32_t)mp_get_duration_seconds());
+    }
 }
 
-static int mp_load_shuffle(void) {
-    if (mp_playlist_count <= 1) return 0;
+// Show the new track in the UI
+static void mp_gapless_commit(void) {
+    mp_gapless_pending = 0;
+    mp_playlist_current = mp_next_index;
+    strcpy(mp_current_path, mp_next_path);
+    strncpy(mp_current_filename, playlist_name(&mp_playlist, mp_next_index), MP_MAX_FILENAME - 1);
+    mp_current_filename[MP_MAX_FILENAME - 1] = '\0';
+    mp_lib_lookup();
 
-    int next_idx;
-    do {
-        next_idx = mp_rand() % mp_playlist_count;
-    } while (next_idx == mp_playlist_current && mp_playlist_count > 1);
+    mp_samples_played = 0;
+    mp_title_scroll_offset = 0;
+    mp_title_scroll_delay = 0;
+    mp_title_at_end = 0;
+    mp_title_scroll_timer = 0;
+    mp_title_end_timer = 0;
+}
 
-    char new_path[MP_MAX_PATH];
-    snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, mp_playlist[next_idx]);
+// Continue decoding with the prepared track
+static void mp_gapless_switch(void) {
+    mp_track_t cur;
+    mp_track_save(&cur);
+    int same_rate = (mp_track_ring_rate(&mp_next) == mp_track_ring_rate(&cur));
 
-    mp_close();
-    return mp_open(new_path);
+    mp_lib_remember();
+    mp_gapless_old_duration = mp_get_duration_seconds();
+    fclose(mp_file);
+    mp_track_load(&mp_next);
+    mp_mp3_index_reset();
+    mp_next_state = MP_NEXT_NONE;
+
+    mp_mp3_vbr = 0;
+    if (mp_format == MP_FMT_MP3) mp_mp3_reset_decoder();  // synced in the lookahead
+
+    if (same_rate) {
+        // New frames queue up behind the old ones in the ring
+        mp_gapless_frames_left = audio_ring_count(&mp_ring);
+        mp_gapless_pending = 1;
+    } else {
+        // Old track has played out (see mp_gapless_update)
+        audio_ring_reset(&mp_ring);
+        audio_resample_init(&mp_resampler, mp_track_ring_rate(&mp_next), MP_OUTPUT_RATE, AUDIO_RESAMPLE_LINEAR);
+        mp_gapless_commit();
+    }
 }
 
+// Per-frame lookahead and switch, after the regular decoding
+static void mp_gapless_update(void) {
+    if (mp_paused || !mp_file || mp_gapless_pending) return;
+
+    uint32_t data_end = mp_data_offset + mp_data_size;
+    if (mp_next_state < MP_NEXT_READY) {
+        // Started near the end, then one step per frame
+        uint32_t lookahead = (uint32_t)mp_get_bytes_per_sec() * MP_GAPLESS_LOOKAHEAD_SEC;
+        if (mp_next_state != MP_NEXT_NONE || mp_file_pos + lookahead >= data_end) {
+            mp_gapless_prepare_step();
+        }
+        return;
+    }
+    if (mp_next_state != MP_NEXT_READY || mp_file_pos < data_end) return;
+
+    // All data read - switch once the decoder has nothing left either
+    if (audio_ring_space(&mp_ring) < MP_MAX_AUDIO_BUFFER) return;
+    if (mp_read_and_decode_audio() > 0) return;
+
+    // A different rate can't share the resampler - let the old track play out
+    mp_track_t cur;
+    mp_track_save(&cur);
+    if (mp_track_ring_rate(&mp_next) != mp_track_ring_rate(&cur) &&
+        audio_ring_count(&mp_ring) >= 64) {
+        return;
+    }
+
+    mp_gapless_switch();
+}
 
 // ============================================================================
 // Public API
 // ============================================================================
 
 void mp_init(void) {
-    mp_audio_ring = (uint8_t *)malloc(MP_AUDIO_RING_SIZE);
-    if (mp_audio_ring) {
-        memset(mp_audio_ring, 0, MP_AUDIO_RING_SIZE);
-    }
+    audio_ring_init(&mp_ring, MP_AUDIO_RING_FRAMES);
+    playlist_init(&mp_playlist);
 }
 
 void mp_set_audio_callback(mp_audio_batch_cb_t cb) {
@@ -1312,28 +1664,12 @@ void mp_set_audio_callback(mp_audio_batch_cb_t cb) {
 }
 
 static void mp_reset_state(void) {
-    mp_format = MP_FMT_UNKNOWN;
-    mp_sample_rate = 44100;
-    mp_channels = 2;
-    mp_bits_per_sample = 16;
-    mp_data_offset = 0;
-    mp_data_size = 0;
-    mp_file_size = 0;
-    mp_file_pos = 0;
+    mp_reset_format();
     mp_samples_played = 0;
 
-    mp_adpcm_block_align = 0;
-    mp_adpcm_samples_per_block = 0;
-    memset(mp_adpcm_sample1, 0, sizeof(mp_adpcm_sample1));
-    memset(mp_adpcm_sample2, 0, sizeof(mp_adpcm_sample2));
-    memset(mp_adpcm_delta, 0, sizeof(mp_adpcm_delta));
-    memset(mp_adpcm_coef_idx, 0, sizeof(mp_adpcm_coef_idx));
-
     mp_mp3_reset();
 
-    mp_aring_read = 0;
-    mp_aring_write = 0;
-    mp_aring_count = 0;
+    audio_ring_reset(&mp_ring);
 
     mp_next_track_request = 0;
 }
@@ -1370,14 +1706,10 @@ int mp_open(const char *path) {
     mp_reset_state();
 
     // v67: Ensure ring buffer is allocated (safety check for re-entry)
-    if (!mp_audio_ring) {
-        mp_audio_ring = (uint8_t *)malloc(MP_AUDIO_RING_SIZE);
-        if (!mp_audio_ring) {
-            fclose(mp_file);
-            mp_file = NULL;
-            return 0;  // Out of memory
-        }
-        memset(mp_audio_ring, 0, MP_AUDIO_RING_SIZE);
+    if (!mp_ring.buf && !audio_ring_init(&mp_ring, MP_AUDIO_RING_FRAMES)) {
+        fclose(mp_file);
+        mp_file = NULL;
+        return 0;  // Out of memory
     }
 
     // Detect and parse format
@@ -1393,7 +1725,10 @@ int mp_open(const char *path) {
         mp_mp3_bitrate = 128;  // Default fallback
         mp_mp3_bitrate_from_header = 0;  // Reset header detection flag
         mp_scan_mp3_header();  // This updates mp_mp3_bitrate and mp_sample_rate
+        mp_mp3_read_tag();     // Xing/VBRI: exact duration and seek TOC
     }
+    mp_mp3_index_reset();
+    mp_lib_lookup();
 
     // Scan playlist for A-Z and shuffle modes
     mp_scan_playlist();
@@ -1401,7 +1736,7 @@ int mp_open(const char *path) {
     mp_active = 1;
     mp_paused = 0;
     mp_ui_mode = MP_UI_PLAYING;
-    mp_resample_acc = 0;  // Reset resampler for new file
+    audio_resample_init(&mp_resampler, mp_sample_rate, MP_OUTPUT_RATE, AUDIO_RESAMPLE_LINEAR);
     mp_last_output_time = 0;  // Reset time tracking
     mp_audio_acc_us = 0;
     mp_samples_played = 0;
@@ -1415,7 +1750,7 @@ int mp_open(const char *path) {
 
     // v66: Pre-fill audio buffer before starting playback
     // This ensures we have enough data buffered to handle low FPS
-    for (int i = 0; i < 8 && mp_aring_count < MP_AUDIO_RING_SIZE * 3 / 4; i++) {
+    for (int i = 0; i < 8 && audio_ring_count(&mp_ring) < MP_AUDIO_RING_FRAMES * 3 / 4; i++) {
         mp_read_and_decode_audio();
     }
 
@@ -1423,6 +1758,9 @@ int mp_open(const char *path) {
 }
 
 void mp_close(void) {
+    mp_lib_remember();
+    mp_gapless_cancel();
+
     if (mp_file) {
         fclose(mp_file);
         mp_file = NULL;
@@ -1431,14 +1769,10 @@ void mp_close(void) {
     // v67: DON'T free audio ring buffer - just clear it!
     // Freeing caused re-entry hang because mp_open() doesn't re-allocate
     // The buffer is allocated once in mp_init() and reused
-    if (mp_audio_ring) {
-        memset(mp_audio_ring, 0, MP_AUDIO_RING_SIZE);
-    }
-    mp_aring_read = 0;
-    mp_aring_write = 0;
-    mp_aring_count = 0;
+    audio_ring_reset(&mp_ring);
 
     mp_mp3_close();
+    ml_flush();
     mp_active = 0;
     mp_paused = 0;
     mp_background_mode = 0;  // v67: Reset background mode on close
@@ -1476,19 +1810,15 @@ void mp_update_audio(void) {
 
     // v71: Safety checks
     if (!mp_file) return;
-    if (!mp_audio_ring) return;
-
-    // v71: Validate ring buffer state
-    if (mp_aring_read < 0 || mp_aring_read >= MP_AUDIO_RING_SIZE) mp_aring_read = 0;
-    if (mp_aring_write < 0 || mp_aring_write >= MP_AUDIO_RING_SIZE) mp_aring_write = 0;
-    if (mp_aring_count < 0) mp_aring_count = 0;
-    if (mp_aring_count > MP_AUDIO_RING_SIZE) mp_aring_count = MP_AUDIO_RING_SIZE;
+    if (!mp_ring.buf) return;
 
     // v66: Decode MULTIPLE chunks per frame to keep buffer full
     // One decode may not produce enough samples, so loop until buffer is healthy
-    for (int i = 0; i < 8 && !mp_paused && mp_aring_count < MP_AUDIO_RING_SIZE * 3 / 4; i++) {
+    for (int i = 0; i < 8 && !mp_paused && audio_ring_count(&mp_ring) < MP_AUDIO_RING_FRAMES * 3 / 4; i++) {
         mp_read_and_decode_audio();
     }
+    mp_gapless_update();
+    mp_mp3_scan_step();
 
     // Output audio
     if (!mp_paused) {
@@ -1497,26 +1827,22 @@ void mp_update_audio(void) {
 
     // Check for end of file
     if (!mp_paused && !mp_eof_pending &&
-        mp_file_pos >= mp_data_offset + mp_data_size && mp_aring_count < 256) {
+        mp_file_pos >= mp_data_offset + mp_data_size && audio_ring_count(&mp_ring) < 64) {
 
         mp_eof_pending = 1;
 
         switch (mp_play_mode) {
             case MP_PLAY_MODE_REPEAT:
-                if (mp_playlist_count > 1 && !mp_load_next_az()) {
+                if (playlist_count(&mp_playlist) > 1 && !mp_load_next_az()) {
                     mp_file_pos = mp_data_offset;
-                    mp_aring_read = 0;
-                    mp_aring_write = 0;
-                    mp_aring_count = 0;
+                    audio_ring_reset(&mp_ring);
                     mp_samples_played = 0;
                     mp_last_output_time = 0;
                     mp_audio_acc_us = 0;
                     if (mp_format == MP_FMT_MP3) mp_mp3_reset();
-                } else if (mp_playlist_count <= 1) {
+                } else if (playlist_count(&mp_playlist) <= 1) {
                     mp_file_pos = mp_data_offset;
-                    mp_aring_read = 0;
-                    mp_aring_write = 0;
-                    mp_aring_count = 0;
+                    audio_ring_reset(&mp_ring);
                     mp_samples_played = 0;
                     mp_last_output_time = 0;
                     mp_audio_acc_us = 0;
@@ -1552,7 +1878,7 @@ void mp_update_audio(void) {
     }
 
     // Safety pause if stuck at EOF
-    if (!mp_paused && mp_file_pos >= mp_data_offset + mp_data_size && mp_aring_count == 0) {
+    if (!mp_paused && mp_file_pos >= mp_data_offset + mp_data_size && audio_ring_count(&mp_ring) == 0) {
         mp_paused = 1;
         mp_eof_pending = 0;
     }
@@ -1563,7 +1889,83 @@ void mp_update_audio(void) {
 void mp_reset_audio_timing(void) {
     mp_last_output_time = 0;  // Next call will assume fresh start
     mp_audio_acc_us = 0;
-    mp_resample_acc = 0;
+}
+
+// Seek by delta_sec from the current position. Going back stops at the
+// start of the track, going forward past the end is ignored.
+static void mp_seek_relative(int delta_sec) {
+    int seeked = 0;
+
+    // After a gapless switch the file is already the next track, which
+    // hasn't been heard yet: seek in it from its start
+    uint64_t played = mp_gapless_pending ? 0 : mp_samples_played;
+
+    if (mp_format == MP_FMT_MP3 && mp_mp3_index_count > 0) {
+        // MP3: by frame number through the seek index (exact for VBR)
+        int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
+        int spf = mp_mp3_frame_samples(sr);
+        int64_t now = (int64_t)(played * sr / ((uint64_t)MP_OUTPUT_RATE * spf));
+        int64_t target = now + (int64_t)delta_sec * sr / spf;
+        if (target < 0) target = 0;
+
+        uint32_t frame = 0;
+        uint32_t offset = mp_mp3_index_find((uint32_t)target, &frame);
+        if (offset > 0 && (mp_mp3_total_frames == 0 || target < mp_mp3_total_frames)) {
+            mp_file_pos = offset;
+            mp_samples_played = (uint64_t)frame * spf * MP_OUTPUT_RATE / sr;
+            seeked = 1;
+        } else if (delta_sec < 0) {
+            mp_file_pos = mp_data_offset;
+            mp_samples_played = 0;
+            seeked = 1;
+        }
+    } else {
+        int bytes_per_sec = mp_get_bytes_per_sec();
+        uint32_t seek_bytes = bytes_per_sec * (delta_sec < 0 ? -delta_sec : delta_sec);
+        if (delta_sec < 0) {
+            if (mp_file_pos > mp_data_offset + seek_bytes) {
+                mp_file_pos -= seek_bytes;
+            } else {
+                mp_file_pos = mp_data_offset;
+            }
+        } else if (mp_file_pos + seek_bytes < mp_data_offset + mp_data_size) {
+            mp_file_pos += seek_bytes;
+        }
+
+        // Recalculate samples_played
+        // samples_played is in OUTPUT samples (22050 Hz), not source rate
+        uint32_t pos_in_data = mp_file_pos - mp_data_offset;
+        if (bytes_per_sec > 0) {
+            mp_samples_played = ((uint64_t)pos_in_data * 22050) / bytes_per_sec;
+            // v58: Workaround for 44.1/48kHz stereo MP3 (same as duration)
+            if (mp_format == MP_FMT_MP3) {
+                int ch = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
+                int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
+                if (ch == 2 && (sr == 44100 || sr == 48000)) {
+                    mp_samples_played = mp_samples_played / 2;
+                }
+            }
+        }
+        seeked = 1;
+    }
+
+    if (!seeked) return;
+    // The old track's tail is only in the ring, which the seek drops: show
+    // the track that is playing now
+    if (mp_gapless_pending) {
+        played = mp_samples_played;
+        mp_gapless_commit();
+        mp_samples_played = played;
+    }
+    // The lookahead was for the old position - mp_gapless_update prepares again
+    mp_gapless_cancel();
+    audio_ring_reset(&mp_ring);
+    mp_last_output_time = 0;
+    mp_audio_acc_us = 0;
+    mp_audio_mute_samples = MP_AUDIO_MUTE_AFTER_SEEK;  // v61: Mute to avoid crackle
+    if (mp_format == MP_FMT_MP3) {
+        mp_mp3_reset();
+    }
 }
 
 int mp_handle_input(int up, int down, int left, int right, int a, int b, int start, int l, int r) {
@@ -1600,139 +2002,32 @@ int mp_handle_input(int up, int down, int left, int right, int a, int b, int sta
     // v71: LEFT/RIGHT - seek 20 seconds
     #define MP_SEEK_SHORT 20
     if (prev_left && !left) {
-        // Seek back 20 seconds
-        int bytes_per_sec = mp_get_bytes_per_sec();
-        uint32_t seek_back = bytes_per_sec * MP_SEEK_SHORT;
-        if (mp_file_pos > mp_data_offset + seek_back) {
-            mp_file_pos -= seek_back;
-        } else {
-            mp_file_pos = mp_data_offset;
-        }
-        // Recalculate samples_played
-        uint32_t pos_in_data = mp_file_pos - mp_data_offset;
-        if (bytes_per_sec > 0) {
-            mp_samples_played = ((uint64_t)pos_in_data * 22050) / bytes_per_sec;
-            if (mp_format == MP_FMT_MP3) {
-                int ch = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
-                int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
-                if (ch == 2 && (sr == 44100 || sr == 48000)) {
-                    mp_samples_played = mp_samples_played / 2;
-                }
-            }
-        }
-        mp_aring_read = 0;
-        mp_aring_write = 0;
-        mp_aring_count = 0;
-        mp_last_output_time = 0;
-        mp_audio_acc_us = 0;
-        mp_audio_mute_samples = MP_AUDIO_MUTE_AFTER_SEEK;
-        if (mp_format == MP_FMT_MP3) {
-            mp_mp3_reset();
-        }
+        mp_seek_relative(-MP_SEEK_SHORT);
     }
 
     if (prev_right && !right) {
-        // Seek forward 20 seconds
-        int bytes_per_sec = mp_get_bytes_per_sec();
-        uint32_t seek_fwd = bytes_per_sec * MP_SEEK_SHORT;
-        if (mp_file_pos + seek_fwd < mp_data_offset + mp_data_size) {
-            mp_file_pos += seek_fwd;
-        }
-        uint32_t pos_in_data = mp_file_pos - mp_data_offset;
-        if (bytes_per_sec > 0) {
-            mp_samples_played = ((uint64_t)pos_in_data * 22050) / bytes_per_sec;
-            if (mp_format == MP_FMT_MP3) {
-                int ch = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
-                int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
-                if (ch == 2 && (sr == 44100 || sr == 48000)) {
-                    mp_samples_played = mp_samples_played / 2;
-                }
-            }
-        }
-        mp_aring_read = 0;
-        mp_aring_write = 0;
-        mp_aring_count = 0;
-        mp_last_output_time = 0;
-        mp_audio_acc_us = 0;
-        mp_audio_mute_samples = MP_AUDIO_MUTE_AFTER_SEEK;
-        if (mp_format == MP_FMT_MP3) {
-            mp_mp3_reset();
-        }
+        mp_seek_relative(MP_SEEK_SHORT);
     }
 
     // v73: UP/DOWN - seek 1 minute (UP=forward, DOWN=back)
     #define MP_SEEK_SECONDS 60
     if (prev_up && !up) {
-        // Seek forward (1 minute)
-        int bytes_per_sec = mp_get_bytes_per_sec();
-        uint32_t seek_fwd = bytes_per_sec * MP_SEEK_SECONDS;
-        if (mp_file_pos + seek_fwd < mp_data_offset + mp_data_size) {
-            mp_file_pos += seek_fwd;
-        }
-        // Recalculate samples_played based on new position
-        // samples_played is in OUTPUT samples (22050 Hz), not source rate
-        uint32_t pos_in_data = mp_file_pos - mp_data_offset;
-        if (bytes_per_sec > 0) {
-            mp_samples_played = ((uint64_t)pos_in_data * 22050) / bytes_per_sec;
-            // v58: Workaround for 44.1/48kHz stereo MP3 (same as duration)
-            if (mp_format == MP_FMT_MP3) {
-                int ch = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
-                int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
-                if (ch == 2 && (sr == 44100 || sr == 48000)) {
-                    mp_samples_played = mp_samples_played / 2;
-                }
-            }
-        }
-        mp_aring_read = 0;
-        mp_aring_write = 0;
-        mp_aring_count = 0;
-        mp_last_output_time = 0;
-        mp_audio_acc_us = 0;
-        mp_audio_mute_samples = MP_AUDIO_MUTE_AFTER_SEEK;  // v61: Mute to avoid crackle
-        if (mp_format == MP_FMT_MP3) {
-            mp_mp3_reset();
-        }
+        mp_seek_relative(MP_SEEK_SECONDS);
     }
 
     if (prev_down && !down) {
-        // Seek back (1 minute)
-        int bytes_per_sec = mp_get_bytes_per_sec();
-        uint32_t seek_back = bytes_per_sec * MP_SEEK_SECONDS;
-        if (mp_file_pos > mp_data_offset + seek_back) {
-            mp_file_pos -= seek_back;
-        } else {
-            mp_file_pos = mp_data_offset;
-        }
-        // Recalculate samples_played based on new position
-        uint32_t pos_in_data = mp_file_pos - mp_data_offset;
-        if (bytes_per_sec > 0) {
-            mp_samples_played = ((uint64_t)pos_in_data * 22050) / bytes_per_sec;
-            if (mp_format == MP_FMT_MP3) {
-                int ch = (mp_mp3_detected_channels > 0) ? mp_mp3_detected_channels : mp_channels;
-                int sr = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
-                if (ch == 2 && (sr == 44100 || sr == 48000)) {
-                    mp_samples_played = mp_samples_played / 2;
-                }
-            }
-        }
-        mp_aring_read = 0;
-        mp_aring_write = 0;
-        mp_aring_count = 0;
-        mp_last_output_time = 0;
-        mp_audio_acc_us = 0;
-        mp_audio_mute_samples = MP_AUDIO_MUTE_AFTER_SEEK;
-        if (mp_format == MP_FMT_MP3) {
-            mp_mp3_reset();
-        }
+        mp_seek_relative(-MP_SEEK_SECONDS);
     }
 
     // v71: L/R SHOULDER - previous/next track
     if (prev_l && !l) {
-        // Previous track
-        if (mp_playlist_count > 1) {
-            int prev_idx = (mp_playlist_current - 1 + mp_playlist_count) % mp_playlist_count;
+        // Previous track (back through the shuffle order in shuffle mode)
+        if (playlist_count(&mp_playlist) > 1) {
+            int prev_idx = (mp_play_mode == MP_PLAY_MODE_SHUFFLE)
+                ? playlist_shuffle_prev(&mp_playlist, mp_playlist_current)
+                : (mp_playlist_current - 1 + playlist_count(&mp_playlist)) % playlist_count(&mp_playlist);
             char new_path[MP_MAX_PATH];
-            snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, mp_playlist[prev_idx]);
+            snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, playlist_name(&mp_playlist, prev_idx));
             mp_close();
             mp_open(new_path);
         }
@@ -1740,10 +2035,12 @@ int mp_handle_input(int up, int down, int left, int right, int a, int b, int sta
 
     if (prev_r && !r) {
         // Next track
-        if (mp_playlist_count > 1) {
-            int next_idx = (mp_playlist_current + 1) % mp_playlist_count;
+        if (playlist_count(&mp_playlist) > 1) {
+            int next_idx = (mp_play_mode == MP_PLAY_MODE_SHUFFLE)
+                ? mp_shuffle_next()
+                : (mp_playlist_current + 1) % playlist_count(&mp_playlist);
             char new_path[MP_MAX_PATH];
-            snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, mp_playlist[next_idx]);
+            snprintf(new_path, MP_MAX_PATH, "%s/%s", mp_current_dir, playlist_name(&mp_playlist, next_idx));
             mp_close();
             mp_open(new_path);
         }
@@ -1756,37 +2053,23 @@ int mp_handle_input(int up, int down, int left, int right, int a, int b, int sta
     return 0;
 }
 
-static void mp_read_and_decode_audio(void) {
-    if (!mp_file) return;
+static int mp_read_and_decode_audio(void) {
+    if (!mp_file) return 0;
 
     switch (mp_format) {
         case MP_FMT_MP3:
-            mp_read_audio_mp3();
-            break;
+            return mp_read_audio_mp3();
         case MP_FMT_WAV_PCM:
-            mp_read_audio_pcm();
-            break;
+            return mp_read_audio_pcm();
         case MP_FMT_WAV_ADPCM:
         case MP_FMT_RAW_ADPCM:
-            mp_read_audio_adpcm();
-            break;
+            return mp_read_audio_adpcm();
     }
+    return 0;
 }
 
 static void mp_output_audio(void) {
-    if (!mp_audio_batch_cb || mp_aring_count == 0) return;
-
-    // v71: Safety checks for ring buffer
-    if (!mp_audio_ring) return;
-    if (mp_aring_read < 0 || mp_aring_read >= MP_AUDIO_RING_SIZE) {
-        mp_aring_read = 0;  // Reset if corrupted
-    }
-    if (mp_aring_write < 0 || mp_aring_write >= MP_AUDIO_RING_SIZE) {
-        mp_aring_write = 0;  // Reset if corrupted
-    }
-    if (mp_aring_count < 0 || mp_aring_count > MP_AUDIO_RING_SIZE) {
-        mp_aring_count = 0;  // Reset if corrupted
-    }
+    if (!mp_audio_batch_cb || !mp_ring.buf || audio_ring_count(&mp_ring) == 0) return;
 
     /*
      * v66: TIME-BASED AUDIO OUTPUT (no stretching)
@@ -1794,8 +2077,6 @@ static void mp_output_audio(void) {
      * At 12 FPS: ~1837 samples/frame. At 30 FPS: ~735 samples/frame.
      * NO STRETCHING - if buffer empty, just skip (natural catch-up next frame).
      */
-    #define MP_OUTPUT_RATE 22050
-
 #ifdef SF2000
     uint32_t now = os_get_tick_count();
 #else
@@ -1823,32 +2104,15 @@ static void mp_output_audio(void) {
     if (mp_format == MP_FMT_MP3 && mp_mp3_detected_samplerate > 0) {
         source_rate = mp_mp3_detected_samplerate;
     }
-
-    // Fixed-point resampling ratio: source_rate / output_rate (scaled by 65536)
-    uint32_t ratio_fp = ((uint32_t)source_rate << 16) / MP_OUTPUT_RATE;
-
-    int out = 0;
-    while (out < output_samples && mp_aring_count >= 4) {
-        // Read current sample from ring buffer
-        int16_t left = mp_audio_ring[mp_aring_read] | (mp_audio_ring[mp_aring_read + 1] << 8);
-        int16_t right = mp_audio_ring[mp_aring_read + 2] | (mp_audio_ring[mp_aring_read + 3] << 8);
-
-        // Output this sample
-        mp_audio_out_buffer[out * 2] = left;
-        mp_audio_out_buffer[out * 2 + 1] = right;
-        out++;
-
-        // Advance accumulator by ratio
-        mp_resample_acc += ratio_fp;
-
-        // Consume source samples based on accumulator overflow
-        while (mp_resample_acc >= 65536 && mp_aring_count >= 4) {
-            mp_resample_acc -= 65536;
-            mp_aring_read = (mp_aring_read + 4) % MP_AUDIO_RING_SIZE;
-            mp_aring_count -= 4;
-        }
+    if (mp_format == MP_FMT_MP3 && mp_mp3_half_rate) {
+        source_rate /= 2;
     }
 
+    // MP3 rate is only known once the first frame is decoded
+    audio_resample_set_rate(&mp_resampler, source_rate, MP_OUTPUT_RATE);
+    uint32_t tail_before = mp_ring.tail;
+    int out = audio_resample_run(&mp_resampler, &mp_ring, mp_audio_out_buffer, output_samples);
+
     // Output what we have (no stretching - natural frame-based sync)
     if (out > 0) {
         mp_samples_played += out;
@@ -1864,6 +2128,16 @@ static void mp_output_audio(void) {
 
         mp_audio_batch_cb(mp_audio_out_buffer, out);
     }
+
+    // Gapless switch: the new track starts once the old frames are consumed
+    if (mp_gapless_pending) {
+        uint32_t consumed = mp_ring.tail - tail_before;
+        if (consumed >= mp_gapless_frames_left) {
+            mp_gapless_commit();
+        } else {
+            mp_gapless_frames_left -= consumed;
+        }
+    }
 }
 
 // Draw progress bar inside the window panel
@@ -1875,7 +2149,7 @@ static void mp_draw_progress_bar(uint16_t *fb, int bar_x, int bar_y, int bar_w,
     if (mp_data_size > 0) {
         uint32_t pos = mp_file_pos - mp_data_offset;
         int progress_w = (int)((uint64_t)pos * (bar_w - 4) / mp_data_size);
-        if (progress_w > bar_w - 4) progress_w = bar_w - 4;
+        if (progress_w > bar_w - 4 || mp_gapless_pending) progress_w = bar_w - 4;
         if (progress_w > 0) {
             mp_fill_rect(fb, bar_x + 2, bar_y + 2, progress_w, bar_h - 4, col_fg);
         }
@@ -1905,9 +2179,11 @@ void mp_render(uint16_t *framebuffer) {
     if (!mp_active) return;
 
     // v66: Decode MULTIPLE chunks per frame to keep buffer full
-    for (int i = 0; i < 8 && !mp_paused && mp_aring_count < MP_AUDIO_RING_SIZE * 3 / 4; i++) {
+    for (int i = 0; i < 8 && !mp_paused && audio_ring_count(&mp_ring) < MP_AUDIO_RING_FRAMES * 3 / 4; i++) {
         mp_read_and_decode_audio();
     }
+    mp_gapless_update();
+    mp_mp3_scan_step();
 
     // Output audio
     if (!mp_paused) {
@@ -1917,7 +2193,7 @@ void mp_render(uint16_t *framebuffer) {
     // Check for end of file (with protection against repeated handling)
     // v57: Universal protection - always pause if something goes wrong
     if (!mp_paused && !mp_eof_pending &&
-        mp_file_pos >= mp_data_offset + mp_data_size && mp_aring_count < 256) {
+        mp_file_pos >= mp_data_offset + mp_data_size && audio_ring_count(&mp_ring) < 64) {
 
         mp_eof_pending = 1;  // Prevent repeated EOF handling
 
@@ -1925,22 +2201,18 @@ void mp_render(uint16_t *framebuffer) {
         switch (mp_play_mode) {
             case MP_PLAY_MODE_REPEAT:
                 // v59: Try to play next track, if no next track exists loop current
-                if (mp_playlist_count > 1 && !mp_load_next_az()) {
+                if (playlist_count(&mp_playlist) > 1 && !mp_load_next_az()) {
                     // Failed to load next - loop current track
                     mp_file_pos = mp_data_offset;
-                    mp_aring_read = 0;
-                    mp_aring_write = 0;
-                    mp_aring_count = 0;
+                    audio_ring_reset(&mp_ring);
                     mp_samples_played = 0;
                     mp_last_output_time = 0;
                     mp_audio_acc_us = 0;
                     if (mp_format == MP_FMT_MP3) mp_mp3_reset();
-                } else if (mp_playlist_count <= 1) {
+                } else if (playlist_count(&mp_playlist) <= 1) {
                     // Only one track - loop it
                     mp_file_pos = mp_data_offset;
-                    mp_aring_read = 0;
-                    mp_aring_write = 0;
-                    mp_aring_count = 0;
+                    audio_ring_reset(&mp_ring);
                     mp_samples_played = 0;
                     mp_last_output_time = 0;
                     mp_audio_acc_us = 0;
@@ -1979,7 +2251,7 @@ void mp_render(uint16_t *framebuffer) {
     }
 
     // v57: Additional safety - if we're somehow stuck at EOF without handling, force pause
-    if (!mp_paused && mp_file_pos >= mp_data_offset + mp_data_size && mp_aring_count == 0) {
+    if (!mp_paused && mp_file_pos >= mp_data_offset + mp_data_size && audio_ring_count(&mp_ring) == 0) {
         mp_paused = 1;
         mp_eof_pending = 0;
     }
@@ -2042,28 +2314,28 @@ void mp_render(uint16_t *framebuffer) {
     // Separator line
     mp_fill_rect(framebuffer, win_x + 6, win_y + 22, win_w - 12, 1, col_text);
 
-    // v57: Filename with scrolling for long names
+    // v57: Filename (or tag title) with scrolling for long names
     // v59: Proper font measurement and end pause
     {
         int title_area_width = win_w - 20;  // 10px padding on each side
-        int full_title_width = builtin_measure_text(mp_current_filename);
+        int full_title_width = builtin_measure_text(mp_display_title);
 
         if (full_title_width <= title_area_width) {
             // Title fits - no scrolling needed
             builtin_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, win_x + 10, win_y + 30,
-                          mp_current_filename, col_text);
+                          mp_display_title, col_text);
             mp_title_scroll_offset = 0;
             mp_title_scroll_delay = 0;
             mp_title_at_end = 0;
         } else {
             // Title doesn't fit - need to scroll
-            int title_len = strlen(mp_current_filename);
+            int title_len = strlen(mp_display_title);
 
             // v59: Calculate max scroll using font_measure_text
             // Find the first character position where the remaining text fits
             int max_scroll = 0;
             for (int i = 0; i < title_len; i++) {
-                int remaining_width = builtin_measure_text(mp_current_filename + i);
+                int remaining_width = builtin_measure_text(mp_display_title + i);
                 if (remaining_width <= title_area_width) {
                     max_scroll = i;
                     break;
@@ -2106,12 +2378,12 @@ void mp_render(uint16_t *framebuffer) {
             int display_idx = 0;
             int accum_width = 0;
             for (int c = start_char; c < title_len && display_idx < 127; c++) {
-                char ch[2] = {mp_current_filename[c], '\0'};
+                char ch[2] = {mp_display_title[c], '\0'};
                 int ch_width = builtin_measure_text(ch);
                 if (accum_width + ch_width > title_area_width) {
                     break;
                 }
-                display_name[display_idx++] = mp_current_filename[c];
+                display_name[display_idx++] = mp_display_title[c];
                 accum_width += ch_width;
             }
             display_name[display_idx] = '\0';
@@ -2160,8 +2432,8 @@ void mp_render(uint16_t *framebuffer) {
     mp_draw_progress_bar(framebuffer, bar_x, bar_y, bar_w, bar_h, bar_bg, col_accent, col_text);
 
     // Playlist info
-    if (mp_playlist_count > 1) {
-        snprintf(info, sizeof(info), "Track %d/%d", mp_playlist_current + 1, mp_playlist_count);
+    if (playlist_count(&mp_playlist) > 1) {
+        snprintf(info, sizeof(info), "Track %d/%d", mp_playlist_current + 1, playlist_count(&mp_playlist));
         builtin_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, win_x + 10, win_y + 145, info, col_dim);
     }
 
@@ -2193,6 +2465,17 @@ void mp_render(uint16_t *framebuffer) {
 }
 
 int mp_get_duration_seconds(void) {
+    if (mp_gapless_pending) return mp_gapless_old_duration;
+
+    // Exact for MP3 once the frame count is known (tag or finished scan)
+    if (mp_format == MP_FMT_MP3 && mp_mp3_total_frames > 0) {
+        int src = (mp_mp3_detected_samplerate > 0) ? mp_mp3_detected_samplerate : mp_sample_rate;
+        if (src > 0) return (int)((uint64_t)mp_mp3_total_frames * mp_mp3_frame_samples(src) / src);
+    }
+
+    // Known from an earlier scan or play of this file
+    if (mp_lib_duration > 0) return (int)mp_lib_duration;
+
     int sr = mp_sample_rate;
     if (mp_format == MP_FMT_MP3 && mp_mp3_detected_samplerate > 0) {
         sr = mp_mp3_detected_samplerate;
@@ -0,0 +1,147 @@
+/*
+ * name_index.c - Image lookup by game name
+ *
+ * See name_index.h.
+ */
+
+#include "name_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_INDEX_MIN_SLOTS 64
+#define NAME_INDEX_MIN_POOL  2048
+
+void name_index_init(name_index_t *ni) {
+    memset(ni, 0, sizeof(*ni));
+}
+
+void name_index_free(name_index_t *ni) {
+    free(ni->pool);
+    free(ni->slots);
+    name_index_init(ni);
+}
+
+void name_index_clear(name_index_t *ni) {
+    if (ni->slots) memset(ni->slots, 0, ni->slot_count * sizeof(name_slot_t));
+    ni->pool_used = 0;
+    ni->count = 0;
+}
+
+/* Length of name without its extension */
+static uint32_t base_len(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext ? (uint32_t)(ext - name) : (uint32_t)strlen(name);
+}
+
+static inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+/* FNV-1a of the lower-cased base */
+static uint32_t base_hash(const char *name, uint32_t len) {
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        h ^= (uint8_t)lower(name[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t name_index_hash(const char *name) {
+    return base_hash(name, base_len(name));
+}
+
+static int base_equal(const char *a, uint32_t a_len, const char *b) {
+    if (base_len(b) != a_len) return 0;
+    for (uint32_t i = 0; i < a_len; i++) {
+        if (lower(a[i]) != lower(b[i])) return 0;
+    }
+    return 1;
+}
+
+static int name_index_grow(name_index_t *ni) {
+    uint32_t count = ni->slot_count ? ni->slot_count * 2 : NAME_INDEX_MIN_SLOTS;
+    name_slot_t *slots = (name_slot_t *)calloc(count, sizeof(name_slot_t));
+    if (!slots) return 0;
+
+    /* Rehash: the stored hashes are reused, only the positions change */
+    for (uint32_t i = 0; i < ni->slot_count; i++) {
+        if (!ni->slots[i].name) continue;
+        uint32_t pos = ni->slots[i].hash & (count - 1);
+        while (slots[pos].name) pos = (pos + 1) & (count - 1);
+        slots[pos] = ni->slots[i];
+    }
+
+    free(ni->slots);
+    ni->slots = slots;
+    ni->slot_count = count;
+    return 1;
+}
+
+int name_index_add_ranked(name_index_t *ni, const char *file_name, uint32_t rank) {
+    /* Keep the load factor under 1/2 */
+    if ((ni->count + 1) * 2 > ni->slot_count && !name_index_grow(ni)) return 0;
+
+    uint32_t len = base_len(file_name);
+    uint32_t hash = base_hash(file_name, len);
+    uint32_t mask = ni->slot_count - 1;
+    uint32_t pos = hash & mask;
+
+    while (ni->slots[pos].name) {
+        if (ni->slots[pos].hash == hash &&
+            base_equal(file_name, len, ni->pool + ni->slots[pos].name)) {
+            if (rank >= ni->slots[pos].rank) return 1;
+            break;  /* better one: the old name stays in the pool unused */
+        }
+        pos = (pos + 1) & mask;
+    }
+    int replace = (ni->slots[pos].name != 0);
+
+    /* Offset 0 marks an empty slot, so the pool starts with one spare byte */
+    uint32_t need = strlen(file_name) + 1;
+    uint32_t start = ni->pool_used ? ni->pool_used : 1;
+    if (start + need > ni->pool_size) {
+        uint32_t size = ni->pool_size ? ni->pool_size : NAME_INDEX_MIN_POOL;
+        while (size < start + need) size *= 2;
+        char *p = (char *)realloc(ni->pool, size);
+        if (!p) return 0;
+        ni->pool = p;
+        ni->pool_size = size;
+    }
+    memcpy(ni->pool + start, file_name, need);
+    ni->pool_used = start + need;
+
+    ni->slots[pos].hash = hash;
+    ni->slots[pos].name = start;
+    ni->slots[pos].rank = rank;
+    if (!replace) ni->count++;
+    return 1;
+}
+
+int name_index_same(const char *a, const char *b) {
+    return base_equal(a, base_len(a), b);
+}
+
+const char *name_index_find(const name_index_t *ni, const char *name) {
+    if (ni->count == 0) return NULL;
+
+    uint32_t len = base_len(name);
+    uint32_t hash = base_hash(name, len);
+    uint32_t mask = ni->slot_count - 1;
+    uint32_t pos = hash & mask;
+
+    while (ni->slots[pos].name) {
+        const char *s = ni->pool + ni->slots[pos].name;
+        if (ni->slots[pos].hash == hash && base_equal(name, len, s)) return s;
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
+
+const char *name_index_next(const name_index_t *ni, uint32_t *pos) {
+    while (*pos < ni->slot_count) {
+        const name_slot_t *slot = &ni->slots[(*pos)++];
+        if (slot->name) return ni->pool + slot->name;
+    }
+    return NULL;
+}
@@ -0,0 +1,69 @@
+/*
+ * name_index.h - Image lookup by game name
+ *
+ * Matching games to their thumbnails and screenshots compares base names:
+ * "Sonic (USA).zip" goes with "sonic (usa).png". Comparing every game with
+ * every image is O(games x images), which for a few thousand of each is
+ * millions of string compares. The index is an open-addressing hash table
+ * keyed on the lower-cased base name (extension stripped), so each game
+ * resolves with one lookup.
+ *
+ * Names are kept back to back in one growable string pool and the table
+ * grows as needed, so there is no limit on the number of images.
+ */
+
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t hash;
+    uint32_t name;          /* offset in pool, 0 = empty slot */
+    uint32_t rank;
+} name_slot_t;
+
+typedef struct {
+    char *pool;             /* NUL-terminated file names, back to back */
+    uint32_t pool_used;
+    uint32_t pool_size;
+    name_slot_t *slots;
+    uint32_t slot_count;    /* power of two */
+    uint32_t count;
+} name_index_t;
+
+void name_index_init(name_index_t *ni);
+
+/* Release all memory */
+void name_index_free(name_index_t *ni);
+
+/* Drop all names but keep the memory for the next folder */
+void name_index_clear(name_index_t *ni);
+
+/* Add a file name. If another name with the same base is already in, the
+ * one with the lower rank is kept, the first one on a tie. Returns 0 if out
+ * of memory. */
+int name_index_add_ranked(name_index_t *ni, const char *file_name, uint32_t rank);
+
+static inline int name_index_add(name_index_t *ni, const char *file_name) {
+    return name_index_add_ranked(ni, file_name, 0);
+}
+
+/* File name whose base matches the base of name (case-insensitive), or
+ * NULL. Valid until the next add, clear or free. */
+const char *name_index_find(const name_index_t *ni, const char *name);
+
+/* Hash of the lower-cased base name of name (extension stripped) */
+uint32_t name_index_hash(const char *name);
+
+/* 1 if a and b have the same base name (case-insensitive) */
+int name_index_same(const char *a, const char *b);
+
+/* File names in table order: start with *pos = 0, NULL after the last */
+const char *name_index_next(const name_index_t *ni, uint32_t *pos);
+
+static inline uint32_t name_index_count(const name_index_t *ni) {
+    return ni->count;
+}
+
+#endif /* NAME_INDEX_H */
@@ -0,0 +1,212 @@
+/*
+ * playlist.c - Folder playlists for the media players
+ *
+ * See playlist.h.
+ */
+
+#include "playlist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SF2000
+#include "../../stockfw.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+#define PLAYLIST_MIN_ENTRIES 32
+#define PLAYLIST_MIN_POOL    2048
+
+void playlist_init(playlist_t *pl) {
+    memset(pl, 0, sizeof(*pl));
+    pl->rand_state = 12345;
+}
+
+static void playlist_drop_order(playlist_t *pl) {
+    free(pl->order);
+    free(pl->order_pos);
+    pl->order = NULL;
+    pl->order_pos = NULL;
+    pl->order_count = 0;
+}
+
+void playlist_free(playlist_t *pl) {
+    playlist_drop_order(pl);
+    free(pl->pool);
+    free(pl->offset);
+    playlist_init(pl);
+}
+
+void playlist_clear(playlist_t *pl) {
+    pl->count = 0;
+    pl->pool_used = 0;
+    pl->dir[0] = '\0';
+}
+
+int playlist_add(playlist_t *pl, const char *name) {
+    uint32_t len = strlen(name) + 1;
+
+    if (pl->count >= pl->capacity) {
+        int cap = pl->capacity ? pl->capacity * 2 : PLAYLIST_MIN_ENTRIES;
+        uint32_t *p = (uint32_t *)realloc(pl->offset, cap * sizeof(uint32_t));
+        if (!p) return 0;
+        pl->offset = p;
+        pl->capacity = cap;
+    }
+    if (pl->pool_used + len > pl->pool_size) {
+        uint32_t size = pl->pool_size ? pl->pool_size : PLAYLIST_MIN_POOL;
+        while (size < pl->pool_used + len) size *= 2;
+        char *p = (char *)realloc(pl->pool, size);
+        if (!p) return 0;
+        pl->pool = p;
+        pl->pool_size = size;
+    }
+
+    memcpy(pl->pool + pl->pool_used, name, len);
+    pl->offset[pl->count++] = pl->pool_used;
+    pl->pool_used += len;
+    return 1;
+}
+
+static int playlist_strcasecmp(const char *a, const char *b) {
+    while (*a && *b) {
+        char ca = *a, cb = *b;
+        if (ca >= 'A' && ca <= 'Z') ca += 32;
+        if (cb >= 'A' && cb <= 'Z') cb += 32;
+        if (ca != cb) return ca - cb;
+        a++; b++;
+    }
+    return *a - *b;
+}
+
+/* qsort has no context argument */
+static const char *playlist_sort_pool;
+
+static int playlist_cmp(const void *a, const void *b) {
+    return playlist_strcasecmp(playlist_sort_pool + *(const uint32_t *)a,
+                               playlist_sort_pool + *(const uint32_t *)b);
+}
+
+void playlist_sort(playlist_t *pl) {
+    if (pl->count < 2) return;
+    playlist_sort_pool = pl->pool;
+    qsort(pl->offset, pl->count, sizeof(uint32_t), playlist_cmp);
+}
+
+int playlist_find(const playlist_t *pl, const char *name) {
+    for (int i = 0; i < pl->count; i++) {
+        if (playlist_strcasecmp(playlist_name(pl, i), name) == 0) return i;
+    }
+    return -1;
+}
+
+int playlist_scan(playlist_t *pl, const char *dir, int (*filter)(const char *name)) {
+    int same_dir = (strcmp(pl->dir, dir) == 0);
+    playlist_clear(pl);
+    strncpy(pl->dir, dir, sizeof(pl->dir) - 1);
+    pl->dir[sizeof(pl->dir) - 1] = '\0';
+
+#ifdef SF2000
+    union {
+        struct {
+            uint8_t _1[0x10];
+            uint32_t type;
+        };
+        struct {
+            uint8_t _2[0x22];
+            char d_name[0x225];
+        };
+        uint8_t __[0x428];
+    } buffer;
+
+    int dir_fd = fs_opendir(dir);
+    if (dir_fd >= 0) {
+        while (fs_readdir(dir_fd, &buffer) >= 0) {
+            if (buffer.type == 0x4000) continue;  /* directory */
+            if (buffer.d_name[0] == '.' || !filter(buffer.d_name)) continue;
+            if (!playlist_add(pl, buffer.d_name)) break;
+        }
+        fs_closedir(dir_fd);
+    }
+#else
+    DIR *d = opendir(dir);
+    if (d) {
+        struct dirent *entry;
+        while ((entry = readdir(d)) != NULL) {
+            if (entry->d_type == DT_DIR) continue;
+            if (entry->d_name[0] == '.' || !filter(entry->d_name)) continue;
+            if (!playlist_add(pl, entry->d_name)) break;
+        }
+        closedir(d);
+    }
+#endif
+
+    playlist_sort(pl);
+
+    /* The permutation is of indices, so it stays valid while the count does */
+    if (!same_dir || pl->order_count != pl->count) playlist_drop_order(pl);
+    return pl->count;
+}
+
+static uint32_t playlist_rand(playlist_t *pl) {
+    pl->rand_state = pl->rand_state * 1103515245 + 12345;
+    return (pl->rand_state >> 16) & 0x7FFF;
+}
+
+/* New permutation; first (if >= 0) goes in front */
+static int playlist_shuffle(playlist_t *pl, int first) {
+    int n = pl->count;
+    if (pl->order_count != n || !pl->order) {
+        playlist_drop_order(pl);
+        pl->order = (int *)malloc(n * sizeof(int));
+        pl->order_pos = (int *)malloc(n * sizeof(int));
+        if (!pl->order || !pl->order_pos) {
+            playlist_drop_order(pl);
+            return 0;
+        }
+        pl->order_count = n;
+    }
+
+    for (int i = 0; i < n; i++) pl->order[i] = i;
+    int start = 0;
+    if (first >= 0 && first < n) {
+        pl->order[0] = first;
+        pl->order[first] = 0;
+        start = 1;
+    }
+    /* Fisher-Yates over the rest; two draws cover folders past 32767 files */
+    for (int i = n - 1; i > start; i--) {
+        uint32_t r = (playlist_rand(pl) << 15) | playlist_rand(pl);
+        int j = start + (int)(r % (uint32_t)(i - start + 1));
+        int t = pl->order[i];
+        pl->order[i] = pl->order[j];
+        pl->order[j] = t;
+    }
+    for (int i = 0; i < n; i++) pl->order_pos[pl->order[i]] = i;
+    return 1;
+}
+
+int playlist_shuffle_next(playlist_t *pl, int current) {
+    if (pl->count < 2) return -1;
+    if (current < 0 || current >= pl->count) current = -1;
+    if (!pl->order && !playlist_shuffle(pl, current)) return -1;
+    if (current < 0) return pl->order[0];
+
+    int p = pl->order_pos[current];
+    if (p + 1 < pl->count) return pl->order[p + 1];
+
+    /* Cycle done: draw the next one starting from here, so no back-to-back repeat */
+    if (!playlist_shuffle(pl, current)) return -1;
+    return pl->order[1];
+}
+
+int playlist_shuffle_prev(playlist_t *pl, int current) {
+    if (pl->count < 2) return -1;
+    if (current < 0 || current >= pl->count) current = -1;
+    if (!pl->order && !playlist_shuffle(pl, current)) return -1;
+    if (current < 0) return pl->order[pl->count - 1];
+
+    int p = pl->order_pos[current];
+    return pl->order[(p > 0) ? p - 1 : pl->count - 1];
+}
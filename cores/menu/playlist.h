@@ -0,0 +1,69 @@
+/*
+ * playlist.h - Folder playlists for the media players
+ *
+ * File names are stored back to back in one growable string pool and
+ * addressed through an offset array, so memory follows the folder contents
+ * and there is no fixed limit on the number of files. Sorting only moves
+ * offsets.
+ *
+ * Shuffle is a Fisher-Yates permutation of the entries with its inverse, so
+ * the next and previous shuffled tracks are O(1) lookups and every track
+ * plays once before any repeats. A new permutation is drawn when a cycle
+ * ends, starting from the track that just played.
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <stdint.h>
+
+typedef struct {
+    char *pool;             /* NUL-terminated names, back to back */
+    uint32_t pool_used;
+    uint32_t pool_size;
+    uint32_t *offset;       /* entry i starts at pool + offset[i] */
+    int count;
+    int capacity;
+    int *order;             /* shuffle permutation, NULL until first used */
+    int *order_pos;         /* inverse: where entry i is in order */
+    int order_count;        /* count the permutation was drawn for */
+    uint32_t rand_state;
+    char dir[256];          /* folder of the last scan */
+} playlist_t;
+
+void playlist_init(playlist_t *pl);
+
+/* Release all memory */
+void playlist_free(playlist_t *pl);
+
+/* Drop all entries but keep the memory for the next scan */
+void playlist_clear(playlist_t *pl);
+
+/* Append a name. Returns 1 on success, 0 if out of memory. */
+int playlist_add(playlist_t *pl, const char *name);
+
+/* Case-insensitive A-Z */
+void playlist_sort(playlist_t *pl);
+
+/* Sorted list of the files in dir accepted by filter (hidden files and
+ * folders are skipped). The shuffle order survives a rescan of the same
+ * folder with the same number of files. Returns the number of entries. */
+int playlist_scan(playlist_t *pl, const char *dir, int (*filter)(const char *name));
+
+/* Index of name (case-insensitive), or -1 */
+int playlist_find(const playlist_t *pl, const char *name);
+
+/* Entry after / before current in the shuffle order, -1 if fewer than two
+ * entries. current may be -1 (not in the list). */
+int playlist_shuffle_next(playlist_t *pl, int current);
+int playlist_shuffle_prev(playlist_t *pl, int current);
+
+static inline int playlist_count(const playlist_t *pl) {
+    return pl->count;
+}
+
+static inline const char *playlist_name(const playlist_t *pl, int i) {
+    return pl->pool + pl->offset[i];
+}
+
+#endif /* PLAYLIST_H */
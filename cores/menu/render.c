@@ -306,47 +306,6 @@ void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is
 
 // Thumbnail implementation
 
-void get_thumbnail_path(const char *game_path, char *thumb_path, size_t thumb_path_size) {
-    if (!game_path || !thumb_path || game_path[0] == '\0') {
-        thumb_path[0] = '\0';
-        return;
-    }
-    
-    // Find the last slash to get directory
-    const char *last_slash = strrchr(game_path, '/');
-    if (!last_slash) {
-        thumb_path[0] = '\0';
-        return;
-    }
-    
-    // Copy directory path
-    size_t dir_len = last_slash - game_path;
-    if (dir_len + 1 >= thumb_path_size) {
-        thumb_path[0] = '\0';
-        return;
-    }
-    
-    strncpy(thumb_path, game_path, dir_len);
-    thumb_path[dir_len] = '\0';
-    
-    // Add /.res/ subdirectory
-    strncat(thumb_path, "/.res/", thumb_path_size - strlen(thumb_path) - 1);
-    
-    // Get filename without extension
-    const char *filename = last_slash + 1;
-    const char *last_dot = strrchr(filename, '.');
-    
-    if (last_dot) {
-        size_t name_len = last_dot - filename;
-        strncat(thumb_path, filename, min(name_len, thumb_path_size - strlen(thumb_path) - 1));
-    } else {
-        strncat(thumb_path, filename, thumb_path_size - strlen(thumb_path) - 1);
-    }
-    
-    // Use raw RGB565 format - no parsing, fixed size, minimal memory
-    strncat(thumb_path, ".rgb565", thumb_path_size - strlen(thumb_path) - 1);
-}
-
 static uint16_t rgb24_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
     return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
 }
@@ -354,130 +313,41 @@ static uint16_t rgb24_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
 // Debug logging
 extern void xlog(const char *fmt, ...);
 
-int load_thumbnail(const char *rgb565_path, Thumbnail *thumb) {
-    if (!rgb565_path || !thumb) return 0;
+int load_thumbnail(const char *path, asset_format_t format, Thumbnail *thumb) {
+    if (!path || !thumb) return 0;
 
     // Initialize thumbnail
     thumb->data = NULL;
     thumb->width = 0;
     thumb->height = 0;
 
-    // v42: Try multiple formats
-    // 1. rgb565 from .res folder (original format, fastest)
-    // 2. webp/png/jpg from ROM folder (same folder as game file)
-
-    xlog("THUMB: input=%s\n", rgb565_path);
+    // v42: rgb565 from .res folder (original format, fastest)
+    // Other formats are converted. The path and format come from the asset
+    // resolver (assets.c), so this is a single open.
+    xlog("THUMB: input=%s\n", path);
 
-    // 1. Try raw RGB565 from .res folder
-    if (load_raw_rgb565(rgb565_path, thumb)) {
-        xlog("THUMB: rgb565 OK\n");
-        return 1;
+    if (format == ASSET_RGB565) {
+        return load_raw_rgb565(path, thumb);
     }
 
     // v72: Use universal buffer for converted thumbnails
     uint16_t *loaded_data = NULL;
     int w = 0, h = 0;
-    char try_path[520];
-
-    // Build .res folder base path (remove .rgb565 extension)
-    char res_base[512];
-    strncpy(res_base, rgb565_path, sizeof(res_base) - 1);
-    res_base[sizeof(res_base) - 1] = '\0';
-    size_t res_len = strlen(res_base);
-    if (res_len > 7 && strcmp(res_base + res_len - 7, ".rgb565") == 0) {
-        res_base[res_len - 7] = '\0';
-    }
-
-    // v72: 2. Try other formats in .res folder (PNG, JPG, WebP, BMP, GIF)
-    snprintf(try_path, sizeof(try_path), "%s.png", res_base);
-    if (load_png_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: .res png OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.jpg", res_base);
-    if (load_jpeg_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: .res jpg OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.webp", res_base);
-    if (load_webp_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: .res webp OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.bmp", res_base);
-    if (load_bmp_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: .res bmp OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.gif", res_base);
-    if (load_gif_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: .res gif OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    // 3. Build ROM folder path by removing "/.res/" from path
-    // rgb565_path: /roms/nes/.res/mario.rgb565
-    // we want:     /roms/nes/mario
-    char rom_path[512];
-    strncpy(rom_path, rgb565_path, sizeof(rom_path) - 1);
-    rom_path[sizeof(rom_path) - 1] = '\0';
-
-    // Find and remove /.res/ from path
-    char *res_ptr = strstr(rom_path, "/.res/");
-    if (!res_ptr) {
-        res_ptr = strstr(rom_path, "\\.res\\");  // Windows style
-    }
-    if (res_ptr) {
-        // Move everything after /.res/ to replace it
-        memmove(res_ptr + 1, res_ptr + 6, strlen(res_ptr + 6) + 1);
-    }
-
-    // Remove .rgb565 extension
-    size_t len = strlen(rom_path);
-    if (len > 7 && strcmp(rom_path + len - 7, ".rgb565") == 0) {
-        rom_path[len - 7] = '\0';
-    }
-
-    // 4. Try formats in ROM folder (WebP, PNG, JPG, BMP, GIF)
-    snprintf(try_path, sizeof(try_path), "%s.webp", rom_path);
-    if (load_webp_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: rom webp OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.png", rom_path);
-    if (load_png_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: rom png OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.jpg", rom_path);
-    if (load_jpeg_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: rom jpg OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.bmp", rom_path);
-    if (load_bmp_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: rom bmp OK %dx%d\n", w, h);
-        goto convert_success;
-    }
-
-    snprintf(try_path, sizeof(try_path), "%s.gif", rom_path);
-    if (load_gif_rgb565(try_path, &loaded_data, &w, &h)) {
-        xlog("THUMB: rom gif OK %dx%d\n", w, h);
-        goto convert_success;
+    int loaded = 0;
+
+    switch (format) {
+        case ASSET_PNG:  loaded = load_png_rgb565(path, &loaded_data, &w, &h); break;
+        case ASSET_JPEG: loaded = load_jpeg_rgb565(path, &loaded_data, &w, &h); break;
+        case ASSET_WEBP: loaded = load_webp_rgb565(path, &loaded_data, &w, &h); break;
+        case ASSET_BMP:  loaded = load_bmp_rgb565(path, &loaded_data, &w, &h); break;
+        case ASSET_GIF:  loaded = load_gif_rgb565(path, &loaded_data, &w, &h); break;
+        default: break;
+    }
+    if (!loaded) {
+        xlog("THUMB: load failed\n");
+        return 0;
     }
 
-    // Nothing found
-    xlog("THUMB: nothing found\n");
-    return 0;
-
-convert_success:
     // v42: Copy to universal buffer if it fits
     if ((size_t)(w * h) <= UNIVERSAL_MAX_PIXELS_RGB565) {
         memcpy(universal_buffer_u16, loaded_data, w * h * sizeof(uint16_t));
@@ -497,11 +367,6 @@ convert_success:
 // v42: load_raw_rgb565 uses universal_buffer
 
 int load_raw_rgb565(const char *path, Thumbnail *thumb) {
-    // Check if file exists
-    if (access(path, F_OK) != 0) {
-        return 0;
-    }
-    
     FILE *fp = fopen(path, "rb");
     if (!fp) {
         return 0;
@@ -510,8 +375,24 @@ int load_raw_rgb565(const char *path, Thumbnail *thumb) {
     fseek(fp, 0, SEEK_END);
     long file_size = ftell(fp);
     fseek(fp, 0, SEEK_SET);
-    
-    
+
+    // Pre-scaled thumbnails (thumb_gen.c) carry their size in a header
+    Rgb565Header header;
+    if (file_size > (long)sizeof(header) && fread(&header, sizeof(header), 1, fp) == 1 &&
+        header.magic == RGB565_MAGIC &&
+        (long)sizeof(header) + header.width * header.height * 2 + 1 == file_size &&
+        (size_t)(header.width * header.height) <= UNIVERSAL_MAX_PIXELS_RGB565) {
+        size_t bytes = header.width * header.height * 2;
+        int ok = (fread(universal_buffer_u16, 1, bytes, fp) == bytes);
+        fclose(fp);
+        if (!ok) return 0;
+        thumb->width = header.width;
+        thumb->height = header.height;
+        thumb->data = universal_buffer_u16;
+        return 1;
+    }
+    fseek(fp, 0, SEEK_SET);
+
     // Try common dimensions - including larger sizes (v42: added 320x240, 320x256, 400x300)
     int dimensions[][2] = {{64,64}, {128,128}, {160,160}, {200,200}, {250,200}, {200,250}, {320,240}, {320,256}, {400,300}};
     int num_dims = sizeof(dimensions) / sizeof(dimensions[0]);
@@ -546,6 +427,28 @@ int load_raw_rgb565(const char *path, Thumbnail *thumb) {
     return 0;
 }
 
+int save_raw_rgb565(const char *path, const uint16_t *data, int width, int height) {
+    Rgb565Header header;
+    header.magic = RGB565_MAGIC;
+    header.width = width;
+    header.height = height;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return 0;
+    }
+
+    size_t bytes = (size_t)width * height * 2;
+    uint8_t pad = 0;
+    int ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(data, 1, bytes, fp) == bytes &&
+              fwrite(&pad, 1, 1, fp) == 1);
+    if (fclose(fp) != 0) ok = 0;
+
+    if (!ok) remove(path);
+    return ok;
+}
+
 void free_thumbnail(Thumbnail *thumb) {
     if (thumb) {
         // No need to free static buffer, just reset pointer
@@ -555,25 +458,84 @@ void free_thumbnail(Thumbnail *thumb) {
     }
 }
 
+// Size a thumbnail is shown at: scaled down to fit the thumbnail area
+void render_thumbnail_fit(int width, int height, int *display_width, int *display_height) {
+    int w = width;
+    int h = height;
+
+    // Scale down if too large
+    if (w > THUMBNAIL_MAX_WIDTH) {
+        h = (h * THUMBNAIL_MAX_WIDTH) / w;
+        w = THUMBNAIL_MAX_WIDTH;
+    }
+
+    if (h > THUMBNAIL_MAX_HEIGHT) {
+        w = (w * THUMBNAIL_MAX_HEIGHT) / h;
+        h = THUMBNAIL_MAX_HEIGHT;
+    }
+
+    *display_width = w;
+    *display_height = h;
+}
+
+// v61: Pixel (x, y) of thumb scaled to display_width x display_height, with bilinear filtering
+static uint16_t thumbnail_sample(const Thumbnail *thumb, int x, int y, int display_width, int display_height) {
+    // Fixed-point source coordinates (8 fractional bits)
+    int src_x_fp = (x * thumb->width * 256) / display_width;
+    int src_y_fp = (y * thumb->height * 256) / display_height;
+
+    int src_x0 = src_x_fp >> 8;
+    int src_y0 = src_y_fp >> 8;
+    int frac_x = src_x_fp & 0xFF;
+    int frac_y = src_y_fp & 0xFF;
+
+    int src_x1 = (src_x0 + 1 < thumb->width) ? src_x0 + 1 : src_x0;
+    int src_y1 = (src_y0 + 1 < thumb->height) ? src_y0 + 1 : src_y0;
+
+    // Get 4 surrounding pixels
+    uint16_t p00 = thumb->data[src_y0 * thumb->width + src_x0];
+    uint16_t p10 = thumb->data[src_y0 * thumb->width + src_x1];
+    uint16_t p01 = thumb->data[src_y1 * thumb->width + src_x0];
+    uint16_t p11 = thumb->data[src_y1 * thumb->width + src_x1];
+
+    // Extract RGB components
+    int r00 = (p00 >> 11) & 0x1F, g00 = (p00 >> 5) & 0x3F, b00 = p00 & 0x1F;
+    int r10 = (p10 >> 11) & 0x1F, g10 = (p10 >> 5) & 0x3F, b10 = p10 & 0x1F;
+    int r01 = (p01 >> 11) & 0x1F, g01 = (p01 >> 5) & 0x3F, b01 = p01 & 0x1F;
+    int r11 = (p11 >> 11) & 0x1F, g11 = (p11 >> 5) & 0x3F, b11 = p11 & 0x1F;
+
+    // Bilinear interpolation
+    int inv_frac_x = 256 - frac_x;
+    int inv_frac_y = 256 - frac_y;
+
+    int r = (r00 * inv_frac_x * inv_frac_y + r10 * frac_x * inv_frac_y +
+             r01 * inv_frac_x * frac_y + r11 * frac_x * frac_y) >> 16;
+    int g = (g00 * inv_frac_x * inv_frac_y + g10 * frac_x * inv_frac_y +
+             g01 * inv_frac_x * frac_y + g11 * frac_x * frac_y) >> 16;
+    int b = (b00 * inv_frac_x * inv_frac_y + b10 * frac_x * inv_frac_y +
+             b01 * inv_frac_x * frac_y + b11 * frac_x * frac_y) >> 16;
+
+    return (r << 11) | (g << 5) | b;
+}
+
+void render_scale_thumbnail(const Thumbnail *thumb, uint16_t *dst, int display_width, int display_height) {
+    for (int y = 0; y < display_height; y++) {
+        for (int x = 0; x < display_width; x++) {
+            *dst++ = thumbnail_sample(thumb, x, y, display_width, display_height);
+        }
+    }
+}
+
 void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb) {
     if (!framebuffer || !thumb || !thumb->data) {
         return;
     }
     
     // Calculate scaled dimensions to fit in thumbnail area
-    int display_width = thumb->width;
-    int display_height = thumb->height;
-    
-    // Scale down if too large
-    if (display_width > THUMBNAIL_MAX_WIDTH) {
-        display_height = (display_height * THUMBNAIL_MAX_WIDTH) / display_width;
-        display_width = THUMBNAIL_MAX_WIDTH;
-    }
-    
-    if (display_height > THUMBNAIL_MAX_HEIGHT) {
-        display_width = (display_width * THUMBNAIL_MAX_HEIGHT) / display_height;
-        display_height = THUMBNAIL_MAX_HEIGHT;
-    }
+    int display_width, display_height;
+    render_thumbnail_fit(thumb->width, thumb->height, &display_width, &display_height);
+    // Already at display size (art cache): plain copy
+    int scaled = (display_width != thumb->width || display_height != thumb->height);
     
     // Center in thumbnail area (vertically) and align to right edge
     int start_x = SCREEN_WIDTH - display_width;  // Align to right edge of screen
@@ -604,42 +566,9 @@ void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb) {
             if (screen_x >= 0 && screen_x < SCREEN_WIDTH &&
                 screen_y >= 0 && screen_y < SCREEN_HEIGHT) {
 
-                // Fixed-point source coordinates (8 fractional bits)
-                int src_x_fp = (x * thumb->width * 256) / display_width;
-                int src_y_fp = (y * thumb->height * 256) / display_height;
-
-                int src_x0 = src_x_fp >> 8;
-                int src_y0 = src_y_fp >> 8;
-                int frac_x = src_x_fp & 0xFF;
-                int frac_y = src_y_fp & 0xFF;
-
-                int src_x1 = (src_x0 + 1 < thumb->width) ? src_x0 + 1 : src_x0;
-                int src_y1 = (src_y0 + 1 < thumb->height) ? src_y0 + 1 : src_y0;
-
-                // Get 4 surrounding pixels
-                uint16_t p00 = thumb->data[src_y0 * thumb->width + src_x0];
-                uint16_t p10 = thumb->data[src_y0 * thumb->width + src_x1];
-                uint16_t p01 = thumb->data[src_y1 * thumb->width + src_x0];
-                uint16_t p11 = thumb->data[src_y1 * thumb->width + src_x1];
-
-                // Extract RGB components
-                int r00 = (p00 >> 11) & 0x1F, g00 = (p00 >> 5) & 0x3F, b00 = p00 & 0x1F;
-                int r10 = (p10 >> 11) & 0x1F, g10 = (p10 >> 5) & 0x3F, b10 = p10 & 0x1F;
-                int r01 = (p01 >> 11) & 0x1F, g01 = (p01 >> 5) & 0x3F, b01 = p01 & 0x1F;
-                int r11 = (p11 >> 11) & 0x1F, g11 = (p11 >> 5) & 0x3F, b11 = p11 & 0x1F;
-
-                // Bilinear interpolation
-                int inv_frac_x = 256 - frac_x;
-                int inv_frac_y = 256 - frac_y;
-
-                int r = (r00 * inv_frac_x * inv_frac_y + r10 * frac_x * inv_frac_y +
-                         r01 * inv_frac_x * frac_y + r11 * frac_x * frac_y) >> 16;
-                int g = (g00 * inv_frac_x * inv_frac_y + g10 * frac_x * inv_frac_y +
-                         g01 * inv_frac_x * frac_y + g11 * frac_x * frac_y) >> 16;
-                int b = (b00 * inv_frac_x * inv_frac_y + b10 * frac_x * inv_frac_y +
-                         b01 * inv_frac_x * frac_y + b11 * frac_x * frac_y) >> 16;
-
-                uint16_t pixel = (r << 11) | (g << 5) | b;
+                uint16_t pixel = scaled ?
+                    thumbnail_sample(thumb, x, y, display_width, display_height) :
+                    thumb->data[y * thumb->width + x];
 
                 // Only draw non-black pixels, let dark gray background show through
                 if (pixel != 0x0000) {
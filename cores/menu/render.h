@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include "theme.h"
 #include "gfx_theme.h"
+#include "assets.h"
 
 // Screen dimensions
 #define SCREEN_WIDTH 320
@@ -86,20 +87,37 @@ typedef struct {
     int height;
 } Thumbnail;
 
-// Load thumbnail from PNG file
-int load_thumbnail(const char *png_path, Thumbnail *thumb);
+// Load thumbnail from a file found by the asset resolver (assets.h)
+int load_thumbnail(const char *path, asset_format_t format, Thumbnail *thumb);
+
+// Raw RGB565 files are headerless with the size guessed from the file
+// length, or start with this header (pre-scaled thumbnails). Those end with
+// one pad byte after the pixels: their length is odd, so a headerless file
+// (always even) is never taken for one, nor one for a headerless file.
+#define RGB565_MAGIC 0x35363552  // "R565"
+typedef struct {
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+} Rgb565Header;
 
 // Load raw RGB565 file (fallback)
 int load_raw_rgb565(const char *path, Thumbnail *thumb);
 
+// Write a raw RGB565 file with a header. Returns 1 on success.
+int save_raw_rgb565(const char *path, const uint16_t *data, int width, int height);
+
 // Free thumbnail memory
 void free_thumbnail(Thumbnail *thumb);
 
 // Draw thumbnail in the thumbnail area
 void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb);
 
-// Get thumbnail path for a given game file
-void get_thumbnail_path(const char *game_path, char *thumb_path, size_t thumb_path_size);
+// Size a width x height thumbnail is drawn at
+void render_thumbnail_fit(int width, int height, int *display_width, int *display_height);
+
+// Scale thumb to display_width x display_height into dst, as render_thumbnail would draw it
+void render_scale_thumbnail(const Thumbnail *thumb, uint16_t *dst, int display_width, int display_height);
 
 // GFX Theme background rendering
 // Clear screen with GFX theme background if active, otherwise use color
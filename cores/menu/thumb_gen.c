@@ -0,0 +1,386 @@
+/*
+ * thumb_gen.c - Pre-scaled .rgb565 thumbnails
+ *
+ * See thumb_gen.h.
+ */
+
+#include "thumb_gen.h"
+#include "thumb_pak.h"
+#include "name_index.h"
+#include "assets.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef SF2000
+#include "../../stockfw.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+#define TG_PARENT     "/mnt/sda1/frogui"
+#define TG_MAX_PATH   512
+#define TG_LIST_STEP  64    /* .res/ entries read per step */
+#define TG_SKIP_STEP  16    /* already converted or packed images checked per step */
+
+enum { TG_IDLE, TG_PLATFORMS, TG_LIST, TG_CONVERT, TG_CHECK, TG_PACK };
+
+/* Candidate images, best first (same order as the thumbnail lookup) */
+static const char *const tg_exts[] = { ".png", ".jpg", ".webp", ".bmp", ".gif", NULL };
+
+static struct {
+    int state;
+    int finished;
+    int converted;
+    int failed;
+    char roms[TG_MAX_PATH];
+    char resume[256];       /* platform folder to continue from, "" = first */
+    char folder[256];
+    char res[TG_MAX_PATH];
+    DIR *roms_dir;
+    DIR *res_dir;
+    name_index_t have;      /* .rgb565 files in res */
+    name_index_t todo;      /* other images in res, best format per name */
+    uint32_t pos;           /* in todo, then in have */
+    uint32_t count;         /* of have, when packing */
+    int folder_converted;   /* files written in this folder */
+} tg;
+
+static void tg_save_progress(void) {
+    mkdir(TG_PARENT, 0755);
+    FILE *fp = fopen(THUMB_GEN_PROGRESS_FILE, "w");
+    if (!fp) return;
+    fprintf(fp, "%s\n", tg.folder);
+    fclose(fp);
+}
+
+static void tg_load_progress(void) {
+    tg.resume[0] = '\0';
+    FILE *fp = fopen(THUMB_GEN_PROGRESS_FILE, "r");
+    if (!fp) return;
+    if (fgets(tg.resume, sizeof(tg.resume), fp)) {
+        tg.resume[strcspn(tg.resume, "\r\n")] = '\0';
+    }
+    fclose(fp);
+}
+
+static int tg_rank(const char *name) {
+    const char *ext = strrchr(name, '.');
+    if (!ext) return -1;
+    for (int i = 0; tg_exts[i]; i++) {
+        if (strcasecmp(ext, tg_exts[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static void tg_close(void) {
+    if (tg.roms_dir) closedir(tg.roms_dir);
+    if (tg.res_dir) closedir(tg.res_dir);
+    tg.roms_dir = NULL;
+    tg.res_dir = NULL;
+    name_index_free(&tg.have);
+    name_index_free(&tg.todo);
+    thumb_pak_abort();
+}
+
+void thumb_gen_start(const char *roms_path) {
+    if (tg.state != TG_IDLE) return;
+
+    strncpy(tg.roms, roms_path, sizeof(tg.roms) - 1);
+    tg.roms[sizeof(tg.roms) - 1] = '\0';
+    tg.folder[0] = '\0';
+    tg.finished = 0;
+    tg.converted = 0;
+    tg.failed = 0;
+    tg_load_progress();
+
+    tg.roms_dir = opendir(tg.roms);
+    tg.state = tg.roms_dir ? TG_PLATFORMS : TG_IDLE;
+}
+
+void thumb_gen_stop(void) {
+    tg_close();
+    tg.state = TG_IDLE;
+}
+
+/* Next platform folder with a .res/ to work on */
+static int tg_step_platforms(void) {
+    struct dirent *ent;
+
+    while ((ent = readdir(tg.roms_dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        if (ent->d_type != DT_DIR) continue;
+        if (strcasecmp(ent->d_name, "frogui") == 0 ||
+            strcasecmp(ent->d_name, "saves") == 0 ||
+            strcasecmp(ent->d_name, "save") == 0) continue;
+
+        /* Continuing a stopped run: skip the folders it already did */
+        if (tg.resume[0]) {
+            if (strcmp(ent->d_name, tg.resume) != 0) continue;
+            tg.resume[0] = '\0';
+        }
+
+        strncpy(tg.folder, ent->d_name, sizeof(tg.folder) - 1);
+        tg.folder[sizeof(tg.folder) - 1] = '\0';
+        tg_save_progress();
+
+        snprintf(tg.res, sizeof(tg.res), "%s/%s/.res", tg.roms, tg.folder);
+        tg.res_dir = opendir(tg.res);
+        if (!tg.res_dir) continue;
+
+        name_index_clear(&tg.have);
+        name_index_clear(&tg.todo);
+        tg.folder_converted = 0;
+        tg.state = TG_LIST;
+        return 1;
+    }
+
+    if (tg.resume[0]) {
+        /* The folder to continue from is gone: start over */
+        tg.resume[0] = '\0';
+        closedir(tg.roms_dir);
+        tg.roms_dir = opendir(tg.roms);
+        return tg.roms_dir != NULL;
+    }
+
+    /* Every folder done */
+    remove(THUMB_GEN_PROGRESS_FILE);
+    tg.folder[0] = '\0';
+    tg.finished = 1;
+    return 0;
+}
+
+static void tg_step_list(void) {
+    struct dirent *ent = NULL;
+    int n = TG_LIST_STEP;
+
+    while (n-- > 0 && (ent = readdir(tg.res_dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        if (asset_format_of(ent->d_name) == ASSET_RGB565) {
+            name_index_add(&tg.have, ent->d_name);
+        } else {
+            int rank = tg_rank(ent->d_name);
+            if (rank >= 0) name_index_add_ranked(&tg.todo, ent->d_name, rank);
+        }
+    }
+
+    if (!ent) {
+        closedir(tg.res_dir);
+        tg.res_dir = NULL;
+        tg.pos = 0;
+        tg.state = TG_CONVERT;
+    }
+}
+
+/* Write res/<name without extension>.rgb565, scaled as render_thumbnail draws
+ * it, and add it to have */
+static int tg_convert(const char *name) {
+    char src[TG_MAX_PATH], dst[TG_MAX_PATH], tmp[TG_MAX_PATH];
+    const char *ext = strrchr(name, '.');
+    int base_len = ext ? (int)(ext - name) : (int)strlen(name);
+
+    snprintf(src, sizeof(src), "%s/%s", tg.res, name);
+    snprintf(dst, sizeof(dst), "%s/%.*s.rgb565", tg.res, base_len, name);
+    snprintf(tmp, sizeof(tmp), "%s/%.*s.tmp", tg.res, base_len, name);
+
+    Thumbnail full;
+    if (!load_thumbnail(src, asset_format_of(name), &full)) return 0;
+
+    int w, h;
+    render_thumbnail_fit(full.width, full.height, &w, &h);
+    if (w <= 0 || h <= 0) return 0;
+
+    uint16_t *pixels = (uint16_t *)malloc((size_t)w * h * sizeof(uint16_t));
+    if (!pixels) return 0;
+    render_scale_thumbnail(&full, pixels, w, h);
+
+    /* Written under another name first, so a half-written file is never picked up */
+    int ok = save_raw_rgb565(tmp, pixels, w, h);
+    free(pixels);
+    if (ok) remove(dst);
+    if (ok && rename(tmp, dst) != 0) {
+        remove(tmp);
+        ok = 0;
+    }
+    if (ok) name_index_add(&tg.have, strrchr(dst, '/') + 1);
+    return ok;
+}
+
+/* 1 if res/name exists, with its size and mtime */
+static int tg_stat(const char *name, struct stat *st) {
+    char path[TG_MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", tg.res, name);
+    return stat(path, st) == 0;
+}
+
+/* 1 if the image name was changed after its .rgb565 (have_name) was written */
+static int tg_outdated(const char *name, const char *have_name) {
+    struct stat src, dst;
+    if (!tg_stat(name, &src) || !tg_stat(have_name, &dst)) return 0;
+    return src.st_mtime > dst.st_mtime;
+}
+
+/* 1 if res/name was written by tg_convert: it has the R565 header and the
+ * length that goes with it. Anything else was put there by hand. */
+static int tg_generated(const char *name) {
+    char path[TG_MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", tg.res, name);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    Rgb565Header header;
+    int ok = (fread(&header, sizeof(header), 1, fp) == 1 && header.magic == RGB565_MAGIC);
+    if (ok) {
+        fseek(fp, 0, SEEK_END);
+        ok = (ftell(fp) == (long)sizeof(header) + (long)header.width * header.height * 2 + 1);
+    }
+    fclose(fp);
+    return ok;
+}
+
+static void tg_begin_pack(void) {
+    tg.pos = 0;
+    tg.state = thumb_pak_begin(tg.res, tg.count, tg.count) ? TG_PACK : TG_PLATFORMS;
+}
+
+/* After converting: pack have into res/thumbs.pak, unless the pack there
+ * was built from these very files (checked in tg_step_check) */
+static void tg_check_pack(void) {
+    tg.count = name_index_count(&tg.have);
+    tg.pos = 0;
+    tg.state = TG_PLATFORMS;
+
+    if (tg.count == 0) return;
+    if (tg.folder_converted || thumb_pak_sources(tg.res) != (int)tg.count) {
+        tg_begin_pack();
+        return;
+    }
+    tg.state = TG_CHECK;
+}
+
+static void tg_step_check(void) {
+    int checked = 0;
+    const char *name;
+    struct stat st;
+
+    while ((name = name_index_next(&tg.have, &tg.pos)) != NULL) {
+        if (!tg_stat(name, &st) ||
+            !thumb_pak_holds(tg.res, name, (uint32_t)st.st_size, (uint32_t)st.st_mtime)) {
+            tg_begin_pack();
+            return;
+        }
+        if (++checked >= TG_SKIP_STEP) return;
+    }
+
+    /* Up to date */
+    thumb_pak_close();
+    tg.state = TG_PLATFORMS;
+}
+
+/* Add one .rgb565 to the pack, scaled as render_thumbnail draws it */
+static void tg_pack(const char *name) {
+    char src[TG_MAX_PATH];
+    struct stat st;
+    snprintf(src, sizeof(src), "%s/%s", tg.res, name);
+    if (stat(src, &st) != 0) return;
+
+    Thumbnail full;
+    if (!load_raw_rgb565(src, &full)) return;
+
+    int w, h;
+    render_thumbnail_fit(full.width, full.height, &w, &h);
+    if (w <= 0 || h <= 0) return;
+    if (w == full.width && h == full.height) {
+        thumb_pak_add(name, full.data, w, h, (uint32_t)st.st_size, (uint32_t)st.st_mtime);
+        return;
+    }
+
+    uint16_t *pixels = (uint16_t *)malloc((size_t)w * h * sizeof(uint16_t));
+    if (!pixels) return;
+    render_scale_thumbnail(&full, pixels, w, h);
+    thumb_pak_add(name, pixels, w, h, (uint32_t)st.st_size, (uint32_t)st.st_mtime);
+    free(pixels);
+}
+
+static void tg_step_pack(void) {
+    const char *name = name_index_next(&tg.have, &tg.pos);
+    if (name) {
+        tg_pack(name);
+        return;
+    }
+
+    thumb_pak_end();
+    tg.state = TG_PLATFORMS;
+}
+
+static int tg_step_convert(void) {
+    int skipped = 0;
+    const char *name;
+
+    while ((name = name_index_next(&tg.todo, &tg.pos)) != NULL) {
+        /* Already converted, unless the image was replaced since. An
+         * .rgb565 made by hand is never replaced, however old. */
+        const char *have_name = name_index_find(&tg.have, name);
+        if (have_name && (!tg_outdated(name, have_name) || !tg_generated(have_name))) {
+            if (++skipped >= TG_SKIP_STEP) return 1;
+            continue;
+        }
+        if (tg_convert(name)) {
+            tg.converted++;
+            tg.folder_converted++;
+        } else {
+            tg.failed++;
+        }
+        return 1;
+    }
+
+    tg_check_pack();
+    return 1;
+}
+
+int thumb_gen_step(void) {
+    switch (tg.state) {
+        case TG_PLATFORMS:
+            if (tg_step_platforms()) return 1;
+            break;
+        case TG_LIST:
+            tg_step_list();
+            return 1;
+        case TG_CONVERT:
+            return tg_step_convert();
+        case TG_CHECK:
+            tg_step_check();
+            return 1;
+        case TG_PACK:
+            tg_step_pack();
+            return 1;
+        default:
+            return 0;
+    }
+
+    thumb_gen_stop();
+    return 0;
+}
+
+int thumb_gen_running(void) {
+    return tg.state != TG_IDLE;
+}
+
+int thumb_gen_finished(void) {
+    return tg.finished;
+}
+
+const char *thumb_gen_folder(void) {
+    return tg.folder;
+}
+
+int thumb_gen_converted(void) {
+    return tg.converted;
+}
+
+int thumb_gen_failed(void) {
+    return tg.failed;
+}
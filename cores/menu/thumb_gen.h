@@ -0,0 +1,44 @@
+/*
+ * thumb_gen.h - Pre-scaled .rgb565 thumbnails
+ *
+ * A raw .rgb565 thumbnail is one read; a PNG, JPEG or WebP in .res/ has to
+ * be decoded at full size and scaled every time it is shown. This walks the
+ * platform folders under the ROMs folder and, for every image in a .res/
+ * without an .rgb565 of the same name, writes one already scaled to the
+ * size the menu draws thumbnails at. Then all of the folder's .rgb565
+ * thumbnails are packed into .res/thumbs.pak (see thumb_pak.h), unless the
+ * pack there was built from the same files (by size and mtime).
+ *
+ * The work is split into small steps for the job scheduler. Images that
+ * already have an .rgb565 are skipped unless they were changed after it was
+ * written, and the platform folder being worked on is recorded in
+ * THUMB_GEN_PROGRESS_FILE, so a stopped run picks up where it left off.
+ * Only .rgb565 files written here (with the R565 header, see render.h) are
+ * ever replaced; headerless ones are the user's and are left alone.
+ *
+ * FrogUI builds without the header support can't read the files written
+ * here and show no thumbnail for those games. To go back to one, delete the
+ * generated files first.
+ */
+
+#ifndef THUMB_GEN_H
+#define THUMB_GEN_H
+
+#define THUMB_GEN_PROGRESS_FILE "/mnt/sda1/frogui/thumbgen.txt"
+
+/* Start, or continue a stopped run, over the platform folders in roms_path */
+void thumb_gen_start(const char *roms_path);
+
+/* Do a little work. Returns 1 while there is more. */
+int thumb_gen_step(void);
+
+/* Stop; the next start continues from the current platform folder */
+void thumb_gen_stop(void);
+
+int thumb_gen_running(void);
+int thumb_gen_finished(void);       /* the last run went through every folder */
+const char *thumb_gen_folder(void); /* platform folder being worked on */
+int thumb_gen_converted(void);      /* files written by this run */
+int thumb_gen_failed(void);         /* images that couldn't be converted */
+
+#endif /* THUMB_GEN_H */
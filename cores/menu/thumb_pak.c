@@ -0,0 +1,330 @@
+/*
+ * thumb_pak.c - Packed thumbnails, one file per platform folder
+ *
+ * See thumb_pak.h.
+ */
+
+#include "thumb_pak.h"
+#include "name_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TP_MAGIC    0x4B415054   /* "TPAK" */
+#define TP_VERSION  2
+#define TP_MAX_PATH 512
+#define TP_MAX_DIM  1024         /* larger images are a broken pack */
+#define TP_MIN_NAMES 2048
+
+/*
+ * File layout: header, count index entries sorted by hash, the pixels of
+ * each image (width x height RGB565) at its entry's offset, then the source
+ * file names (NUL-terminated, back to back) at names_offset. Names are kept
+ * so images whose hashes collide are still told apart.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t sources;       /* .rgb565 files the pack was built from */
+    uint32_t names_offset;
+    uint32_t names_size;
+} tp_header_t;
+
+typedef struct {
+    uint32_t hash;          /* name_index_hash() of the image name */
+    uint32_t name;          /* offset in the names */
+    uint32_t offset;        /* of the pixels, from the start of the file */
+    uint32_t src_size;      /* source .rgb565 the pixels came from */
+    uint32_t src_mtime;
+    uint16_t width;
+    uint16_t height;
+} tp_entry_t;
+
+/* Pack being read */
+static struct {
+    char dir[TP_MAX_PATH];  /* .res/ it belongs to, "" = none */
+    FILE *fp;               /* NULL if dir has no usable pack */
+    tp_entry_t *index;
+    char *names;
+    uint32_t names_size;
+    uint32_t count;
+    const tp_entry_t *found;
+} tp_read;
+
+/* Pack being written */
+static struct {
+    FILE *fp;
+    char path[TP_MAX_PATH];
+    char tmp[TP_MAX_PATH];
+    tp_entry_t *index;
+    char *names;
+    uint32_t names_used;
+    uint32_t names_size;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t sources;
+    uint32_t offset;        /* where the next image goes */
+} tp_write;
+
+static int tp_header_ok(const tp_header_t *h) {
+    return h->magic == TP_MAGIC && h->version == TP_VERSION;
+}
+
+void thumb_pak_close(void) {
+    if (tp_read.fp) fclose(tp_read.fp);
+    free(tp_read.index);
+    free(tp_read.names);
+    memset(&tp_read, 0, sizeof(tp_read));
+}
+
+/* Read the index and names of the pack open in fp */
+static int tp_load(FILE *fp) {
+    tp_header_t h;
+
+    if (fread(&h, sizeof(h), 1, fp) != 1 || !tp_header_ok(&h)) return 0;
+    if (h.count == 0 || h.names_size == 0) return 0;
+
+    tp_read.index = (tp_entry_t *)malloc(h.count * sizeof(tp_entry_t));
+    tp_read.names = (char *)malloc(h.names_size);
+    if (!tp_read.index || !tp_read.names) return 0;
+    if (fread(tp_read.index, sizeof(tp_entry_t), h.count, fp) != h.count) return 0;
+    if (fseek(fp, h.names_offset, SEEK_SET) != 0 ||
+        fread(tp_read.names, 1, h.names_size, fp) != h.names_size) return 0;
+    tp_read.names[h.names_size - 1] = '\0';
+
+    for (uint32_t i = 0; i < h.count; i++) {
+        if (tp_read.index[i].name >= h.names_size) return 0;
+    }
+    tp_read.count = h.count;
+    tp_read.names_size = h.names_size;
+    return 1;
+}
+
+/* Open res_dir's pack and read its index. With no pack, res_dir is still
+ * remembered so it isn't looked for again. */
+static void tp_open(const char *res_dir, int len) {
+    char path[TP_MAX_PATH];
+
+    if (strncmp(tp_read.dir, res_dir, len) == 0 && tp_read.dir[len] == '\0') return;
+    thumb_pak_close();
+    if (len >= TP_MAX_PATH) return;
+    memcpy(tp_read.dir, res_dir, len);
+    tp_read.dir[len] = '\0';
+
+    snprintf(path, sizeof(path), "%s/%s", tp_read.dir, THUMB_PAK_NAME);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+
+    if (!tp_load(fp)) {
+        fclose(fp);
+        free(tp_read.index);
+        free(tp_read.names);
+        tp_read.index = NULL;
+        tp_read.names = NULL;
+        tp_read.count = 0;
+        return;
+    }
+    tp_read.fp = fp;
+}
+
+/* Entry of the open pack for name, NULL if it has none. The whole name
+ * has to match, extension included: Game.png must not be served the pixels
+ * of a Game.rgb565 that has since been deleted. */
+static const tp_entry_t *tp_lookup(const char *name) {
+    if (!tp_read.fp) return NULL;
+
+    /* First entry with the hash, then every entry sharing it */
+    uint32_t hash = name_index_hash(name);
+    uint32_t lo = 0, hi = tp_read.count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (tp_read.index[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    for (; lo < tp_read.count && tp_read.index[lo].hash == hash; lo++) {
+        const tp_entry_t *e = &tp_read.index[lo];
+        if (strcasecmp(tp_read.names + e->name, name) == 0) return e;
+    }
+    return NULL;
+}
+
+int thumb_pak_find(const char *thumb_path, int *width, int *height) {
+    tp_read.found = NULL;
+
+    /* Only images in a .res/ folder are packed */
+    const char *name = strrchr(thumb_path, '/');
+    if (!name) return 0;
+    int dir_len = (int)(name - thumb_path);
+    name++;
+    if (dir_len < 5 || strncmp(name - 5, ".res/", 5) != 0) return 0;
+
+    tp_open(thumb_path, dir_len);
+    const tp_entry_t *e = tp_lookup(name);
+    if (!e) return 0;
+    if (e->width == 0 || e->height == 0 || e->width > TP_MAX_DIM || e->height > TP_MAX_DIM) return 0;
+
+    tp_read.found = e;
+    *width = e->width;
+    *height = e->height;
+    return 1;
+}
+
+int thumb_pak_read(uint16_t *dst) {
+    const tp_entry_t *e = tp_read.found;
+    if (!e || !tp_read.fp) return 0;
+
+    size_t pixels = (size_t)e->width * e->height;
+    return fseek(tp_read.fp, e->offset, SEEK_SET) == 0 &&
+           fread(dst, sizeof(uint16_t), pixels, tp_read.fp) == pixels;
+}
+
+int thumb_pak_sources(const char *res_dir) {
+    char path[TP_MAX_PATH];
+    tp_header_t h;
+
+    snprintf(path, sizeof(path), "%s/%s", res_dir, THUMB_PAK_NAME);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+    int ok = (fread(&h, sizeof(h), 1, fp) == 1 && tp_header_ok(&h));
+    fclose(fp);
+    return ok ? (int)h.sources : -1;
+}
+
+int thumb_pak_holds(const char *res_dir, const char *name, uint32_t src_size, uint32_t src_mtime) {
+    tp_open(res_dir, (int)strlen(res_dir));
+    const tp_entry_t *e = tp_lookup(name);
+    return e && e->src_size == src_size && e->src_mtime == src_mtime;
+}
+
+void thumb_pak_abort(void) {
+    if (tp_write.fp) {
+        fclose(tp_write.fp);
+        remove(tp_write.tmp);
+    }
+    free(tp_write.index);
+    free(tp_write.names);
+    memset(&tp_write, 0, sizeof(tp_write));
+}
+
+int thumb_pak_begin(const char *res_dir, uint32_t capacity, uint32_t sources) {
+    thumb_pak_abort();
+    if (capacity == 0) return 0;
+
+    snprintf(tp_write.path, sizeof(tp_write.path), "%s/%s", res_dir, THUMB_PAK_NAME);
+    snprintf(tp_write.tmp, sizeof(tp_write.tmp), "%s/%s.tmp", res_dir, THUMB_PAK_NAME);
+
+    tp_write.index = (tp_entry_t *)calloc(capacity, sizeof(tp_entry_t));
+    if (!tp_write.index) return 0;
+
+    tp_write.fp = fopen(tp_write.tmp, "wb");
+    if (!tp_write.fp) {
+        thumb_pak_abort();
+        return 0;
+    }
+
+    /* Room for the header and the index, filled in by thumb_pak_end() */
+    tp_header_t h;
+    memset(&h, 0, sizeof(h));
+    if (fwrite(&h, sizeof(h), 1, tp_write.fp) != 1 ||
+        fwrite(tp_write.index, sizeof(tp_entry_t), capacity, tp_write.fp) != capacity) {
+        thumb_pak_abort();
+        return 0;
+    }
+
+    tp_write.capacity = capacity;
+    tp_write.sources = sources;
+    tp_write.offset = sizeof(h) + capacity * sizeof(tp_entry_t);
+    return 1;
+}
+
+/* Copy name to the names; offset of the copy, or UINT32_MAX if out of memory */
+static uint32_t tp_add_name(const char *name) {
+    uint32_t len = (uint32_t)strlen(name) + 1;
+    if (tp_write.names_used + len > tp_write.names_size) {
+        uint32_t size = tp_write.names_size ? tp_write.names_size : TP_MIN_NAMES;
+        while (tp_write.names_used + len > size) size *= 2;
+        char *p = (char *)realloc(tp_write.names, size);
+        if (!p) return UINT32_MAX;
+        tp_write.names = p;
+        tp_write.names_size = size;
+    }
+    uint32_t offset = tp_write.names_used;
+    memcpy(tp_write.names + offset, name, len);
+    tp_write.names_used += len;
+    return offset;
+}
+
+int thumb_pak_add(const char *name, const uint16_t *pixels, int width, int height,
+                  uint32_t src_size, uint32_t src_mtime) {
+    if (!tp_write.fp || tp_write.count >= tp_write.capacity) return 0;
+    if (width <= 0 || height <= 0 || width > TP_MAX_DIM || height > TP_MAX_DIM) return 0;
+
+    uint32_t name_offset = tp_add_name(name);
+    if (name_offset == UINT32_MAX) return 0;
+
+    size_t count = (size_t)width * height;
+    if (fwrite(pixels, sizeof(uint16_t), count, tp_write.fp) != count) {
+        thumb_pak_abort();
+        return 0;
+    }
+
+    tp_entry_t *e = &tp_write.index[tp_write.count++];
+    e->hash = name_index_hash(name);
+    e->name = name_offset;
+    e->offset = tp_write.offset;
+    e->src_size = src_size;
+    e->src_mtime = src_mtime;
+    e->width = (uint16_t)width;
+    e->height = (uint16_t)height;
+    tp_write.offset += (uint32_t)(count * sizeof(uint16_t));
+    return 1;
+}
+
+static int tp_entry_cmp(const void *a, const void *b) {
+    uint32_t ha = ((const tp_entry_t *)a)->hash;
+    uint32_t hb = ((const tp_entry_t *)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+int thumb_pak_end(void) {
+    if (!tp_write.fp) return 0;
+    if (tp_write.count == 0) {
+        thumb_pak_abort();
+        return 0;
+    }
+
+    /* Sorted for the binary search; entries sharing a hash are told apart
+     * by name */
+    qsort(tp_write.index, tp_write.count, sizeof(tp_entry_t), tp_entry_cmp);
+
+    tp_header_t h;
+    h.magic = TP_MAGIC;
+    h.version = TP_VERSION;
+    h.count = tp_write.count;
+    h.sources = tp_write.sources;
+    h.names_offset = tp_write.offset;
+    h.names_size = tp_write.names_used;
+
+    int ok = (fwrite(tp_write.names, 1, tp_write.names_used, tp_write.fp) == tp_write.names_used &&
+              fseek(tp_write.fp, 0, SEEK_SET) == 0 &&
+              fwrite(&h, sizeof(h), 1, tp_write.fp) == 1 &&
+              fwrite(tp_write.index, sizeof(tp_entry_t), tp_write.count, tp_write.fp) == tp_write.count);
+    if (fclose(tp_write.fp) != 0) ok = 0;
+    tp_write.fp = NULL;
+
+    /* The reader may have the old pack open */
+    thumb_pak_close();
+
+    /* Written under another name first, so a half-written pack is never used */
+    if (ok) {
+        remove(tp_write.path);
+        if (rename(tp_write.tmp, tp_write.path) != 0) ok = 0;
+    }
+    if (!ok) remove(tp_write.tmp);
+
+    free(tp_write.index);
+    free(tp_write.names);
+    memset(&tp_write, 0, sizeof(tp_write));
+    return ok;
+}
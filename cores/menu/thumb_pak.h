@@ -0,0 +1,56 @@
+/*
+ * thumb_pak.h - Packed thumbnails, one file per platform folder
+ *
+ * Even a pre-scaled .rgb565 thumbnail costs an open, a read and a close on
+ * the SD card's FAT filesystem. .res/thumbs.pak holds all of a folder's
+ * thumbnails: a header, an index sorted by the hash of the lower-cased base
+ * name (see name_index_hash), the RGB565 pixels of each image, then the
+ * image names. The pack of the folder being browsed stays open with its
+ * index in memory, so a thumbnail is one seek and one read.
+ *
+ * The pack only speeds up .rgb565 images the asset resolver already found
+ * in .res/, matched by full file name; a name it doesn't hold is read from
+ * its own file as before. It is written
+ * by thumb_gen, which records the size and mtime of every source .rgb565 and
+ * packs the folder again when one of them changes.
+ */
+
+#ifndef THUMB_PAK_H
+#define THUMB_PAK_H
+
+#include <stdint.h>
+
+#define THUMB_PAK_NAME "thumbs.pak"
+
+/* Look up the image at thumb_path (<dir>/.res/<name>.rgb565) in
+ * <dir>/.res/'s pack. Returns 1 and its size if the pack holds it. */
+int thumb_pak_find(const char *thumb_path, int *width, int *height);
+
+/* Read the image thumb_pak_find() last found into dst. Returns 1 on success. */
+int thumb_pak_read(uint16_t *dst);
+
+/* Close the open pack (the files may have changed) */
+void thumb_pak_close(void);
+
+/* Number of sources the pack in res_dir was built from, -1 if there is none */
+int thumb_pak_sources(const char *res_dir);
+
+/* 1 if the pack in res_dir holds name, made from a file of this size and mtime */
+int thumb_pak_holds(const char *res_dir, const char *name, uint32_t src_size, uint32_t src_mtime);
+
+/* Start writing the pack for res_dir, with room for up to capacity images.
+ * Returns 1 on success. */
+int thumb_pak_begin(const char *res_dir, uint32_t capacity, uint32_t sources);
+
+/* Append an image, made from a file of src_size bytes last changed at
+ * src_mtime, to the pack being written. Returns 1 on success. */
+int thumb_pak_add(const char *name, const uint16_t *pixels, int width, int height,
+                  uint32_t src_size, uint32_t src_mtime);
+
+/* Finish the pack and put it in place of the old one. Returns 1 on success. */
+int thumb_pak_end(void);
+
+/* Drop the pack being written */
+void thumb_pak_abort(void);
+
+#endif /* THUMB_PAK_H */
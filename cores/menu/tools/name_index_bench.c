@@ -0,0 +1,117 @@
+/*
+ * name_index_bench.c - Host benchmark of image matching by game name
+ *
+ * Matches GAMES game names against as many image names with the nested
+ * base-name compare the folder listing used before name_index, then with
+ * name_index (build plus one lookup per game), and checks that both find
+ * the same image for every game.
+ *
+ * Build and run on the host, from cores/menu:
+ *   cc -O2 -I. tools/name_index_bench.c name_index.c -o name_index_bench
+ *   ./name_index_bench
+ *
+ * Figures are wall-clock seconds, the best of RUNS runs.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "name_index.h"
+
+#define GAMES 5000
+#define RUNS  5
+
+static char games[GAMES][64];
+static char images[GAMES][64];
+static const char *nested_match[GAMES];
+static const char *index_match[GAMES];
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* The compare the folder listing ran for every game and image pair */
+static int filename_base_matches(const char *game_name, const char *image_name) {
+    int game_len = strlen(game_name);
+    const char *game_ext = strrchr(game_name, '.');
+    if (game_ext) game_len = game_ext - game_name;
+
+    int img_len = strlen(image_name);
+    const char *img_ext = strrchr(image_name, '.');
+    if (img_ext) img_len = img_ext - image_name;
+
+    if (game_len != img_len) return 0;
+    for (int i = 0; i < game_len; i++) {
+        char c1 = game_name[i], c2 = image_name[i];
+        if (c1 >= 'A' && c1 <= 'Z') c1 += 32;
+        if (c2 >= 'A' && c2 <= 'Z') c2 += 32;
+        if (c1 != c2) return 0;
+    }
+    return 1;
+}
+
+static int nested(void) {
+    int found = 0;
+    for (int g = 0; g < GAMES; g++) {
+        nested_match[g] = NULL;
+        for (int i = 0; i < GAMES; i++) {
+            if (filename_base_matches(games[g], images[i])) {
+                nested_match[g] = images[i];
+                found++;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+static int indexed(name_index_t *ni) {
+    int found = 0;
+    name_index_clear(ni);
+    for (int i = 0; i < GAMES; i++) name_index_add(ni, images[i]);
+    for (int g = 0; g < GAMES; g++) {
+        index_match[g] = name_index_find(ni, games[g]);
+        if (index_match[g]) found++;
+    }
+    return found;
+}
+
+int main(void) {
+    /* Every other game has an image, in scrambled order */
+    for (int i = 0; i < GAMES; i++) {
+        snprintf(games[i], sizeof(games[i]), "Game Title Number %05d (USA).zip", i);
+        snprintf(images[i], sizeof(images[i]), "game title number %05d (usa).png",
+                 (i * 7919) % (GAMES * 2));
+    }
+
+    name_index_t ni;
+    name_index_init(&ni);
+    double best_nested = 1e30, best_index = 1e30;
+    int n_nested = 0, n_index = 0;
+
+    for (int run = 0; run < RUNS; run++) {
+        double t0 = bench_now();
+        n_nested = nested();
+        double t1 = bench_now();
+        n_index = indexed(&ni);
+        double t2 = bench_now();
+        if (t1 - t0 < best_nested) best_nested = t1 - t0;
+        if (t2 - t1 < best_index) best_index = t2 - t1;
+    }
+
+    for (int g = 0; g < GAMES; g++) {
+        if ((nested_match[g] == NULL) != (index_match[g] == NULL) ||
+            (nested_match[g] && strcmp(nested_match[g], index_match[g]) != 0)) {
+            printf("%s: matches differ\n", games[g]);
+            return 1;
+        }
+    }
+
+    printf("%d games, %d images\n", GAMES, GAMES);
+    printf("nested compare %8.4f s, %d matched\n", best_nested, n_nested);
+    printf("name_index     %8.4f s, %d matched\n", best_index, n_index);
+    name_index_free(&ni);
+    return 0;
+}
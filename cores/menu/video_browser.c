@@ -6,6 +6,8 @@
 #include "video_browser.h"
 #include "render.h"
 #include "theme.h"
+#include "music_lib.h"
+#include "jobs.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -173,6 +175,12 @@ static int vb_matches_filter(const char *filename) {
     }
 }
 
+// Background job: one music file probed per step
+static int vb_lib_scan_job(void *ctx) {
+    (void)ctx;
+    return ml_scan_step() ? JOB_MORE : JOB_DONE;
+}
+
 // Scan directory for matching files and subdirectories
 static void vb_scan_directory(void) {
     vb_file_count = 0;
@@ -274,6 +282,12 @@ static void vb_scan_directory(void) {
 
     closedir(dir);
 #endif
+
+    // Fill in durations/titles for this folder in the background
+    if (vb_filter_mode == VB_FILTER_MUSIC) {
+        ml_scan_dir(vb_current_path);
+        jobs_add(vb_lib_scan_job, NULL);
+    }
 }
 
 void vb_init(void) {
@@ -327,6 +341,7 @@ void vb_open(void) {
 
 void vb_close(void) {
     vb_active = 0;
+    ml_flush();
 }
 
 int vb_wants_go_to_header(void) {
@@ -614,19 +629,39 @@ void vb_draw(uint16_t *framebuffer) {
         // Build display name
         char full_name[VB_MAX_NAME + 3];
         char display_name[VB_NAME_VISIBLE_CHARS + 1];
+        char duration[12] = "";
+        int visible = VB_NAME_VISIBLE_CHARS;
 
         if (vb_is_dir[idx]) {
             snprintf(full_name, sizeof(full_name), "[%s]", vb_files[idx]);
         } else {
             strncpy(full_name, vb_files[idx], VB_MAX_NAME);
             full_name[VB_MAX_NAME - 1] = '\0';
+
+            // Music: tag title and length from the library, once scanned
+            const ml_entry_t *me = NULL;
+            if (vb_filter_mode == VB_FILTER_MUSIC) {
+                me = ml_find(vb_current_path, vb_files[idx]);
+            }
+            if (me && me->title[0]) {
+                if (me->artist[0]) {
+                    snprintf(full_name, sizeof(full_name), "%s - %s", me->artist, me->title);
+                } else {
+                    snprintf(full_name, sizeof(full_name), "%s", me->title);
+                }
+            }
+            if (me && me->duration > 0) {
+                ml_format_duration(me->duration, duration, sizeof(duration));
+                // Name stops one char short of the right-aligned length
+                visible = (fb_w - 38 - vb_measure_str(duration)) / 6;
+            }
         }
 
         int name_len = strlen(full_name);
 
         // Scroll long names for selected item
-        if (idx == vb_selection && name_len > VB_NAME_VISIBLE_CHARS) {
-            int max_scroll = name_len - VB_NAME_VISIBLE_CHARS;
+        if (idx == vb_selection && name_len > visible) {
+            int max_scroll = name_len - visible;
 
             vb_name_scroll_timer++;
             if (vb_name_scroll_timer >= VB_NAME_SCROLL_DELAY) {
@@ -638,15 +673,19 @@ void vb_draw(uint16_t *framebuffer) {
             }
 
             int scroll_pos = (vb_name_scroll > max_scroll) ? max_scroll : vb_name_scroll;
-            strncpy(display_name, full_name + scroll_pos, VB_NAME_VISIBLE_CHARS);
-            display_name[VB_NAME_VISIBLE_CHARS] = '\0';
+            strncpy(display_name, full_name + scroll_pos, visible);
+            display_name[visible] = '\0';
         } else {
-            strncpy(display_name, full_name, VB_NAME_VISIBLE_CHARS);
-            display_name[VB_NAME_VISIBLE_CHARS] = '\0';
+            strncpy(display_name, full_name, visible);
+            display_name[visible] = '\0';
         }
 
         uint16_t col = vb_is_dir[idx] ? col_dir : col_text;
         vb_draw_str(framebuffer, fb_x + 10, y + 1, display_name, col);
+        if (duration[0]) {
+            int dur_w = vb_measure_str(duration);
+            vb_draw_str(framebuffer, fb_x + fb_w - 22 - dur_w, y + 1, duration, col);
+        }
     }
 
     // Scroll indicators
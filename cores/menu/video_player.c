@@ -13,6 +13,13 @@
 #include "music_player.h"  // v69: For pausing music during video playback
 #include "xvid/xvid.h"
 #include "libmad/libmad.h"
+#include "yuv2rgb.h"
+#include "avi_index.h"
+#include "avi_cache.h"
+#include "audio_ring.h"
+#include "audio_resample.h"
+#include "playlist.h"
+#include "adpcm.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,6 +34,7 @@
 #else
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #endif
 
 // Screen dimensions
@@ -40,9 +48,20 @@
 // Maximum frame data size
 #define VP_MAX_FRAME_SIZE (480 * 320 * 2)
 
+// idx1 entry flag: chunk is a keyframe
+#define VP_AVIIF_KEYFRAME 0x10
+
+// Above this many idx1 entries the chunk index is paged in from idx1 on demand
+#define VP_INDEX_PAGED_ENTRIES 131072
+
+// Seek: frames decoded (without output) from the keyframe up to the target.
+// Farther away, the seek lands on the keyframe itself.
+#define VP_SEEK_MAX_PREROLL_SEC 2
+
 // Audio settings
-#define VP_AUDIO_RING_SIZE (44100 * 4)  // ~1 second at 44kHz stereo
-#define VP_AUDIO_REFILL_THRESHOLD (VP_AUDIO_RING_SIZE / 2)
+#define VP_OUTPUT_RATE 22050  // core audio rate (retro_get_system_av_info)
+#define VP_AUDIO_RING_FRAMES (32 * 1024)  // stereo frames, power of two (~0.75s at 44kHz)
+#define VP_AUDIO_REFILL_THRESHOLD (VP_AUDIO_RING_FRAMES / 2)
 #define VP_MAX_AUDIO_BUFFER 4096
 
 // Audio format constants
@@ -110,35 +129,70 @@
 
 // AVI state
 static FILE *vp_file = NULL;
-static uint32_t *vp_frame_offsets = NULL;
-static uint32_t *vp_frame_sizes = NULL;
+static avi_index_t vp_video_index;     // video chunk offsets/sizes
+static uint8_t *vp_frame_keys = NULL;  // keyframe bitmap, 1 bit per frame
+static int vp_frame_keys_size = 0;     // bytes allocated
+static int vp_total_keyframes = 0;
 static int vp_total_frames = 0;
 static int vp_current_frame = 0;
 static int vp_video_width = 0;
 static int vp_video_height = 0;
 
 // Audio chunk index
-static uint32_t *vp_audio_offsets = NULL;
-static uint32_t *vp_audio_sizes = NULL;
+static avi_index_t vp_audio_index;
 static int vp_total_audio_chunks = 0;
+
+// OpenDML (AVI 2.0) super index: one segment per ix## standard index chunk.
+// Segment headers are read at open, their entries only when paged in.
+typedef struct {
+    uint64_t offset;      // file offset of the ix## chunk
+    uint64_t base;        // qwBaseOffset of its entries
+    uint32_t first;       // stream entry number of its first entry
+    uint32_t count;       // entries in use
+    uint32_t duration;    // dwDuration from the super index, in stream ticks
+} vp_odml_segment_t;
+typedef struct {
+    vp_odml_segment_t *seg;
+    int count;
+} vp_odml_index_t;
+static vp_odml_index_t vp_odml_video;
+static vp_odml_index_t vp_odml_audio;
+static int vp_keys_lazy = 0;  // keyframe bits arrive with paged ix## entries
+
+// idx1 location for paging the index back in (VP_INDEX_PAGED_ENTRIES)
+static long vp_idx1_start = 0;
+static uint32_t vp_idx1_entries = 0;
+static long vp_idx1_base = 0;
 static uint32_t vp_total_audio_bytes = 0;
 
 // XVID decoder state
 static void *vp_xvid_handle = NULL;
 static int vp_xvid_initialized = 0;
 
-// Frame buffers
+// Compressed frame buffer (decoded pictures stay inside xvid, see vp_conv)
+// Only used for chunks too large for a read-ahead window
 static uint8_t *vp_frame_buffer = NULL;
-static uint8_t *vp_yuv_buffer = NULL;
-static uint8_t *vp_yuv_y = NULL;
-static uint8_t *vp_yuv_u = NULL;
-static uint8_t *vp_yuv_v = NULL;
+
+// Read-ahead windows over movi - video and audio chunks are served as slices
+#define VP_STREAM_WINDOW  (128 * 1024)
+#define VP_STREAM_WINDOWS 2
+#define VP_STREAM_PAD     16   // xvid's bitstream reader looks a few bytes past the end
+typedef struct {
+    uint8_t *data;
+    uint64_t start;   // file offset of data[0]
+    uint32_t len;     // valid bytes, 0 = empty
+    uint32_t used;    // last use stamp for LRU
+} vp_stream_window_t;
+static vp_stream_window_t vp_stream[VP_STREAM_WINDOWS];
+static uint8_t *vp_stream_mem = NULL;
+static uint32_t vp_stream_stamp = 0;
 
 // MPEG-4 extradata (VOL header)
 #define VP_MAX_EXTRADATA_SIZE 256
 static uint8_t vp_mpeg4_extradata[VP_MAX_EXTRADATA_SIZE];
 static int vp_mpeg4_extradata_size = 0;
 static int vp_mpeg4_extradata_sent = 0;
+static int vp_xvid_discontinuity = 0;  // next decode follows a seek
 
 // Player state
 static int vp_active = 0;
@@ -152,20 +206,27 @@ static uint32_t vp_clip_fps = 30;
 static int vp_repeat_count = 1;
 static int vp_repeat_counter = 0;
 
-// YUV->RGB lookup tables
-static int16_t vp_yuv_rv_table[256];
-static int16_t vp_yuv_gu_table[256];
-static int16_t vp_yuv_gv_table[256];
-static int16_t vp_yuv_bu_table[256];
-static int vp_yuv_tables_initialized = 0;
-
-// 4x4 Bayer dithering matrix
-static const int8_t vp_bayer4x4[4][4] = {
-    { -8,  0, -6,  2 },
-    {  4, -4,  6, -2 },
-    { -5,  3, -7,  1 },
-    {  7, -1,  5, -3 }
-};
+// Frame scheduler - catches up with the wall clock when decoding falls behind
+#define VP_SCHED_SLACK_FRAMES     1     // lag tolerated before catching up (clock jitter)
+#define VP_SCHED_DROP_B_LAG_MS    200   // behind by this much: also drop B-frames
+#define VP_SCHED_KEYFRAME_LAG_MS  500   // behind by this much: jump to a due keyframe
+#define VP_SCHED_KEY_SCAN         64    // max chunks looked at per keyframe search
+#define VP_SCHED_MAX_CATCHUP      8     // max hidden frames decoded per render
+static uint32_t vp_sched_base_ms = 0;   // clock time when vp_sched_base_frame was due
+static int vp_sched_base_frame = 0;
+static int vp_sched_anchored = 0;       // 0 = re-anchor clock on next decoded frame
+static int vp_sched_decode_cost = 0;    // avg decode time without conversion (ms * 16)
+static int vp_sched_frame_cost = 0;     // avg decode + convert time (ms * 16)
+static int vp_stat_dropped = 0;         // frames never decoded
+static int vp_stat_late = 0;            // frames shown after they were due
+static int vp_stat_skipped = 0;         // frames decoded without color conversion
+
+// YUV->RGB565 converter for the active color mode / black level.
+// xvid converts into the framebuffer through it (XVID_CSP_FROGUI) and it
+// remembers the last picture for redraws (repeat frames, pause, menu).
+static yuv2rgb_t vp_conv;
+static int vp_conv_mode = -1;
+static int vp_conv_black_level = -1;
 
 // Audio state
 static int vp_has_audio = 0;
@@ -175,16 +236,24 @@ static int vp_audio_sample_rate = 0;
 static int vp_audio_bits = 0;
 static int vp_audio_bytes_per_sample = 0;
 
+// Audio stream timeline from strh/strf: a chunk lasts size / sample_size
+// AVI samples (or 1 if sample_size is 0, e.g. VBR MP3 with one frame per
+// chunk) of scale / rate seconds each
+static uint32_t vp_audio_scale = 0;
+static uint32_t vp_audio_rate = 0;
+static uint32_t vp_audio_sample_size = 0;
+static uint32_t vp_audio_avg_bytes = 0;   // nAvgBytesPerSec
+
 // Audio position
 static int vp_audio_chunk_idx = 0;
 static uint32_t vp_audio_chunk_pos = 0;
-static uint64_t vp_audio_samples_sent = 0;
+static uint64_t vp_audio_samples_sent = 0;  // at VP_OUTPUT_RATE
+
+// Audio ring buffer (decoded 16-bit stereo frames, all formats)
+static audio_ring_t vp_ring;
 
-// Audio ring buffer
-static uint8_t *vp_audio_ring = NULL;
-static int vp_aring_read = 0;
-static int vp_aring_write = 0;
-static int vp_aring_count = 0;
+// Resampler from the ring rate to VP_OUTPUT_RATE
+static audio_resample_t vp_resampler;
 
 // v61: Audio mute after seek to avoid crackle (increased from 2048)
 static int vp_audio_mute_samples = 0;
@@ -196,32 +265,18 @@ static int16_t vp_audio_out_buffer[VP_MAX_AUDIO_BUFFER * 2];
 // Audio callback
 static vp_audio_batch_cb_t vp_audio_batch_cb = NULL;
 
-// ADPCM state
+// ADPCM state (MS or IMA)
+static int vp_adpcm_kind = ADPCM_MS;
 static int vp_adpcm_block_align = 0;
 static int vp_adpcm_samples_per_block = 0;
-static int vp_adpcm_sample1[2] = {0, 0};
-static int vp_adpcm_sample2[2] = {0, 0};
-static int vp_adpcm_delta[2] = {0, 0};
-static int vp_adpcm_coef_idx[2] = {0, 0};
-
-// MS ADPCM tables
-static const int vp_adpcm_adapt_table[16] = {
-    230, 230, 230, 230, 307, 409, 512, 614,
-    768, 614, 512, 409, 307, 230, 230, 230
-};
-static const int vp_adpcm_coef1[7] = { 256, 512, 0, 192, 240, 460, 392 };
-static const int vp_adpcm_coef2[7] = { 0, -256, 0, 64, 0, -208, -232 };
-
-// ADPCM decode buffer
-#define VP_ADPCM_DECODE_BUF_SIZE 16384
-static int16_t vp_adpcm_decode_buf[VP_ADPCM_DECODE_BUF_SIZE];
-static uint8_t vp_adpcm_read_buf[8192];
+#define VP_ADPCM_MAX_BLOCK 8192
 
 // MP3 decoder state
 static void *vp_mp3_handle = NULL;
 static int vp_mp3_initialized = 0;
 static int vp_mp3_detected_samplerate = 0;
 static int vp_mp3_detected_channels = 0;
+static int vp_mp3_half_rate = 0;  // 44.1/48 kHz source: synthesize at half rate (no resampling)
 
 // MP3 input buffer
 #define VP_MP3_INPUT_BUF_SIZE 8192
@@ -295,32 +350,10 @@ static int vp_next_video_requested = 0;  // 1 = load next, 2 = load random
 static char vp_resume_path[VP_MAX_PATH] = {0};
 static int vp_resume_frame = 0;
 
-// Simple random for shuffle
-static uint32_t vp_shuffle_seed = 12345;
-static uint32_t vp_shuffle_rand(void) {
-    vp_shuffle_seed = vp_shuffle_seed * 1103515245 + 12345;
-    return (vp_shuffle_seed >> 16) & 0x7FFF;
-}
-
 // Playlist for A-Z and Shuffle modes
-#define VP_MAX_PLAYLIST 256
-#define VP_MAX_FILENAME 128
-static char vp_playlist[VP_MAX_PLAYLIST][VP_MAX_FILENAME];
-static int vp_playlist_count = 0;
+static playlist_t vp_playlist;
 static int vp_playlist_current = -1;
 
-// Case-insensitive string comparison
-static int vp_strcasecmp(const char *a, const char *b) {
-    while (*a && *b) {
-        char ca = *a, cb = *b;
-        if (ca >= 'A' && ca <= 'Z') ca += 32;
-        if (cb >= 'A' && cb <= 'Z') cb += 32;
-        if (ca != cb) return ca - cb;
-        a++; b++;
-    }
-    return *a - *b;
-}
-
 // Check if filename is a video file (case-insensitive)
 static int vp_is_video_file(const char *name) {
     int len = strlen(name);
@@ -339,118 +372,31 @@ static int vp_is_video_file(const char *name) {
     return 0;
 }
 
-// Bubble sort playlist case-insensitively
-static void vp_sort_playlist(void) {
-    for (int i = 0; i < vp_playlist_count - 1; i++) {
-        for (int j = 0; j < vp_playlist_count - i - 1; j++) {
-            if (vp_strcasecmp(vp_playlist[j], vp_playlist[j + 1]) > 0) {
-                char temp[VP_MAX_FILENAME];
-                strncpy(temp, vp_playlist[j], VP_MAX_FILENAME - 1);
-                strncpy(vp_playlist[j], vp_playlist[j + 1], VP_MAX_FILENAME - 1);
-                strncpy(vp_playlist[j + 1], temp, VP_MAX_FILENAME - 1);
-            }
-        }
-    }
-}
-
 // Scan directory and build playlist
 static void vp_scan_playlist(void) {
-    vp_playlist_count = 0;
     vp_playlist_current = -1;
-
     if (vp_current_dir[0] == '\0') return;
 
-    // Extract current filename from path
-    char current_filename[VP_MAX_FILENAME] = "";
+    // Current filename from path
     const char *slash = strrchr(vp_current_path, '/');
-    if (slash) {
-        strncpy(current_filename, slash + 1, VP_MAX_FILENAME - 1);
-        current_filename[VP_MAX_FILENAME - 1] = '\0';
-    }
-
-#ifdef SF2000
-    // SF2000 file system
-    union {
-        struct {
-            uint32_t type;
-        };
-        struct {
-            uint8_t _2[0x22];
-            char d_name[0x225];
-        };
-        uint8_t __[0x428];
-    } buffer;
+    const char *current_filename = slash ? slash + 1 : vp_current_path;
 
-    int dir_fd = fs_opendir(vp_current_dir);
-    if (dir_fd < 0) return;
-
-    while (vp_playlist_count < VP_MAX_PLAYLIST) {
-        memset(&buffer, 0, sizeof(buffer));
-        if (fs_readdir(dir_fd, &buffer) < 0) break;
-
-        // Skip . and ..
-        if (buffer.d_name[0] == '.') continue;
-
-        // Skip directories
-        if (S_ISDIR(buffer.type)) continue;
-
-        // Check if video file
-        if (!vp_is_video_file(buffer.d_name)) continue;
-
-        strncpy(vp_playlist[vp_playlist_count], buffer.d_name, VP_MAX_FILENAME - 1);
-        vp_playlist[vp_playlist_count][VP_MAX_FILENAME - 1] = '\0';
-        vp_playlist_count++;
-    }
-
-    fs_closedir(dir_fd);
-#else
-    // Standard POSIX
-    DIR *dir = opendir(vp_current_dir);
-    if (!dir) return;
-
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL && vp_playlist_count < VP_MAX_PLAYLIST) {
-        // Skip . and ..
-        if (entry->d_name[0] == '.') continue;
-
-        // Skip directories
-        if (entry->d_type == DT_DIR) continue;
-
-        // Check if video file
-        if (!vp_is_video_file(entry->d_name)) continue;
-
-        strncpy(vp_playlist[vp_playlist_count], entry->d_name, VP_MAX_FILENAME - 1);
-        vp_playlist[vp_playlist_count][VP_MAX_FILENAME - 1] = '\0';
-        vp_playlist_count++;
-    }
-
-    closedir(dir);
-#endif
-
-    // Sort playlist case-insensitively
-    vp_sort_playlist();
-
-    // Find current file in playlist
-    for (int i = 0; i < vp_playlist_count; i++) {
-        if (vp_strcasecmp(vp_playlist[i], current_filename) == 0) {
-            vp_playlist_current = i;
-            break;
-        }
-    }
+    playlist_scan(&vp_playlist, vp_current_dir, vp_is_video_file);
+    vp_playlist_current = playlist_find(&vp_playlist, current_filename);
 }
 
 // Load next video (A-Z order)
 static int vp_load_next_az(void) {
-    if (vp_playlist_count <= 1) return 0;
+    if (playlist_count(&vp_playlist) <= 1) return 0;
     if (vp_playlist_current < 0) vp_scan_playlist();
     if (vp_playlist_current < 0) return 0;
 
     // Get next index (wrap around)
-    int next_idx = (vp_playlist_current + 1) % vp_playlist_count;
+    int next_idx = (vp_playlist_current + 1) % playlist_count(&vp_playlist);
 
     // Build full path
     char new_path[VP_MAX_PATH];
-    snprintf(new_path, VP_MAX_PATH, "%s/%s", vp_current_dir, vp_playlist[next_idx]);
+    snprintf(new_path, VP_MAX_PATH, "%s/%s", vp_current_dir, playlist_name(&vp_playlist, next_idx));
 
     // Close current and open new
     vp_close();
@@ -459,21 +405,17 @@ static int vp_load_next_az(void) {
 
 // Load random video (Shuffle)
 static int vp_load_shuffle(void) {
-    if (vp_playlist_count <= 1) return 0;
+    if (playlist_count(&vp_playlist) <= 1) return 0;
     if (vp_playlist_current < 0) vp_scan_playlist();
-    if (vp_playlist_count <= 1) return 0;
+    if (playlist_count(&vp_playlist) <= 1) return 0;
 
-    // Pick random index different from current
-    int new_idx;
-    int attempts = 0;
-    do {
-        new_idx = vp_shuffle_rand() % vp_playlist_count;
-        attempts++;
-    } while (new_idx == vp_playlist_current && attempts < 20);
+    // Next in the shuffle order - no repeats until every video has played
+    int new_idx = playlist_shuffle_next(&vp_playlist, vp_playlist_current);
+    if (new_idx < 0) return 0;
 
     // Build full path
     char new_path[VP_MAX_PATH];
-    snprintf(new_path, VP_MAX_PATH, "%s/%s", vp_current_dir, vp_playlist[new_idx]);
+    snprintf(new_path, VP_MAX_PATH, "%s/%s", vp_current_dir, playlist_name(&vp_playlist, new_idx));
 
     // Close current and open new
     vp_close();
@@ -486,10 +428,6 @@ static uint8_t vp_gamma_g6[VP_COLOR_MODE_COUNT][64];
 static uint8_t vp_gamma_b5[VP_COLOR_MODE_COUNT][32];
 static int vp_gamma_tables_initialized = 0;
 
-// Two Y tables for TV/PC range selection
-static int16_t vp_yuv_y_table_tv[256];
-static int16_t vp_yuv_y_table_pc[256];
-
 // Input edge detection
 static int vp_prev_a = 0;
 static int vp_prev_b = 0;
@@ -650,30 +588,6 @@ static void vp_init_gamma_tables(void) {
     vp_gamma_tables_initialized = 1;
 }
 
-// Initialize YUV->RGB tables (TV and PC range)
-static void vp_init_yuv_tables(void) {
-    if (vp_yuv_tables_initialized) return;
-
-    for (int i = 0; i < 256; i++) {
-        // TV/Limited range (16-235 -> 0-255)
-        int y_limited = ((i - 16) * 298) >> 8;
-        if (y_limited < 0) y_limited = 0;
-        if (y_limited > 255) y_limited = 255;
-        vp_yuv_y_table_tv[i] = y_limited;
-
-        // PC/Full range (0-255 as-is)
-        vp_yuv_y_table_pc[i] = i;
-
-        // U/V contributions - BT.601 coefficients
-        int uv = i - 128;
-        vp_yuv_rv_table[i] = (1436 * uv) >> 10;
-        vp_yuv_gu_table[i] = (-352 * uv) >> 10;
-        vp_yuv_gv_table[i] = (-731 * uv) >> 10;
-        vp_yuv_bu_table[i] = (1815 * uv) >> 10;
-    }
-    vp_yuv_tables_initialized = 1;
-}
-
 // Drawing functions for menu
 static void vp_draw_char(int x, int y, char c, uint16_t col) {
     if (c < 32 || c > 127) c = '?';
@@ -961,6 +875,108 @@ static void vp_draw_icon(int type) {
     }
 }
 
+// Keyframe bitmap helpers - the bitmap grows with the number of frames
+static void vp_set_keyframe(int idx) {
+    int byte = idx >> 3;
+    if (byte >= vp_frame_keys_size) {
+        int new_size = vp_frame_keys_size ? vp_frame_keys_size : 1024;
+        while (new_size <= byte) new_size *= 2;
+        uint8_t *p = (uint8_t *)realloc(vp_frame_keys, new_size);
+        if (!p) return;
+        memset(p + vp_frame_keys_size, 0, new_size - vp_frame_keys_size);
+        vp_frame_keys = p;
+        vp_frame_keys_size = new_size;
+    }
+    vp_frame_keys[byte] |= (uint8_t)(1 << (idx & 7));
+    vp_total_keyframes++;
+}
+
+static inline int vp_test_keyframe(int idx) {
+    if ((idx >> 3) >= vp_frame_keys_size) return 0;
+    return (vp_frame_keys[idx >> 3] >> (idx & 7)) & 1;
+}
+
+// Chunk lookups in the compact index
+static inline int vp_frame_chunk(int idx, uint64_t *offset, uint32_t *size) {
+    return avi_index_get(&vp_video_index, idx, offset, size);
+}
+
+static inline int vp_audio_chunk(int idx, uint64_t *offset, uint32_t *size) {
+    return avi_index_get(&vp_audio_index, idx, offset, size);
+}
+
+// Seek to a 64-bit file position. long may be 32-bit, so positions past
+// 2 GB (OpenDML files up to the FAT32 4 GB limit) are reached in steps.
+static int vp_fseek64(uint64_t pos) {
+    if (pos <= 0x7FFFFFFF) return fseek(vp_file, (long)pos, SEEK_SET);
+    if (fseek(vp_file, 0x40000000L, SEEK_SET) != 0) return -1;
+    pos -= 0x40000000;
+    while (pos > 0x40000000) {
+        if (fseek(vp_file, 0x40000000L, SEEK_CUR) != 0) return -1;
+        pos -= 0x40000000;
+    }
+    return fseek(vp_file, (long)pos, SEEK_CUR);
+}
+
+// Free chunk indexes and keyframe bitmap
+static void vp_free_index(void) {
+    avi_index_free(&vp_video_index);
+    avi_index_free(&vp_audio_index);
+    if (vp_frame_keys) {
+        free(vp_frame_keys);
+        vp_frame_keys = NULL;
+    }
+    vp_frame_keys_size = 0;
+    vp_total_keyframes = 0;
+    if (vp_odml_video.seg) free(vp_odml_video.seg);
+    if (vp_odml_audio.seg) free(vp_odml_audio.seg);
+    vp_odml_video.seg = NULL;
+    vp_odml_video.count = 0;
+    vp_odml_audio.seg = NULL;
+    vp_odml_audio.count = 0;
+    vp_keys_lazy = 0;
+}
+
+// Read entries of one stream back from idx1 (paged index)
+// ctx is the index being paged; src is the idx1 entry number to start at
+static int vp_idx1_page(void *ctx, uint32_t src, int n, uint64_t *offset, uint32_t *size) {
+    int video = (ctx == &vp_video_index);
+    uint8_t buf[16 * 64];
+    int got = 0;
+
+    while (got < n && src < vp_idx1_entries) {
+        uint32_t batch = vp_idx1_entries - src;
+        if (batch > 64) batch = 64;
+        if (fseek(vp_file, vp_idx1_start + (long)src * 16, SEEK_SET) != 0) break;
+        if (fread(buf, 16, batch, vp_file) != batch) break;
+
+        for (uint32_t k = 0; k < batch && got < n; k++) {
+            uint8_t *entry = buf + k * 16;
+            int is_video = (entry[2]=='d' || entry[2]=='D') && (entry[3]=='c' || entry[3]=='C');
+            int is_audio = (entry[2]=='w' || entry[2]=='W') && (entry[3]=='b' || entry[3]=='B');
+            if (video ? is_video : is_audio) {
+                offset[got] = vp_idx1_base + vp_read_u32_le(entry + 8) + 8;
+                size[got] = vp_read_u32_le(entry + 12);
+                got++;
+            }
+        }
+        src += batch;
+    }
+    return got;
+}
+
+// Coding type of the first VOP in a chunk's leading bytes
+// Returns 0=I, 1=P, 2=B, 3=S or -1 if no VOP header found
+static int vp_vop_type(const uint8_t *buf, uint32_t size) {
+    // Skip VOS/VOL/user data headers up to the VOP start code 00 00 01 B6
+    for (uint32_t i = 0; i + 4 < size; i++) {
+        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1 && buf[i + 3] == 0xB6) {
+            return buf[i + 4] >> 6;
+        }
+    }
+    return -1;
+}
+
 // Check if data at offset is a valid AVI chunk header
 static int vp_check_chunk_header(long offset) {
     if (offset < 0 || !vp_file) return 0;
@@ -1027,6 +1043,18 @@ static int vp_parse_idx1(long movi_data_start) {
                 offset_base = movi_data_start;
             }
 
+            // Long files: keep only block anchors, page entries back in from idx1
+            int paged = (num_entries > VP_INDEX_PAGED_ENTRIES);
+            avi_index_init(&vp_video_index, paged);
+            avi_index_init(&vp_audio_index, paged);
+            if (paged) {
+                avi_index_set_pager(&vp_video_index, vp_idx1_page, &vp_video_index);
+                avi_index_set_pager(&vp_audio_index, vp_idx1_page, &vp_audio_index);
+            }
+            vp_idx1_start = idx_start;
+            vp_idx1_entries = num_entries;
+            vp_idx1_base = offset_base;
+
             // Parse all entries
             fseek(vp_file, idx_start, SEEK_SET);
 
@@ -1038,20 +1066,23 @@ static int vp_parse_idx1(long movi_data_start) {
                 uint32_t abs_offset = offset_base + offset + add_header;
 
                 if ((entry[2]=='d' || entry[2]=='D') && (entry[3]=='c' || entry[3]=='C')) {
-                    vp_frame_offsets[vp_total_frames] = abs_offset;
-                    vp_frame_sizes[vp_total_frames] = fsize;
+                    if (!avi_index_add(&vp_video_index, abs_offset, fsize, i)) break;
+                    if (vp_read_u32_le(entry + 4) & VP_AVIIF_KEYFRAME) {
+                        vp_set_keyframe(vp_total_frames);
+                    }
                     vp_total_frames++;
                 }
                 else if ((entry[2]=='w' || entry[2]=='W') && (entry[3]=='b' || entry[3]=='B')) {
                     if (vp_total_audio_chunks < VP_MAX_AUDIO_CHUNKS) {
-                        vp_audio_offsets[vp_total_audio_chunks] = abs_offset;
-                        vp_audio_sizes[vp_total_audio_chunks] = fsize;
+                        if (!avi_index_add(&vp_audio_index, abs_offset, fsize, i)) break;
                         vp_total_audio_bytes += fsize;
                         vp_total_audio_chunks++;
                     }
                 }
             }
 
+            avi_index_finish(&vp_video_index);
+            avi_index_finish(&vp_audio_index);
             return (vp_total_frames > 0) ? 1 : 0;
         }
 
@@ -1062,9 +1093,11 @@ static int vp_parse_idx1(long movi_data_start) {
 }
 
 // Scan movi list for frame offsets
+// No idx1 flags here - keyframes are found from the VOP coding type
 static void vp_scan_movi(long movi_start, long movi_end) {
     fseek(vp_file, movi_start, SEEK_SET);
     uint8_t header[8];
+    uint8_t vop[64];
 
     while (ftell(vp_file) < movi_end && vp_total_frames < VP_MAX_FRAMES) {
         if (fread(header, 1, 8, vp_file) != 8) break;
@@ -1073,14 +1106,17 @@ static void vp_scan_movi(long movi_start, long movi_end) {
         long data_pos = ftell(vp_file);
 
         if ((header[2] == 'd' || header[2] == 'D') && (header[3] == 'c' || header[3] == 'C')) {
-            vp_frame_offsets[vp_total_frames] = data_pos;
-            vp_frame_sizes[vp_total_frames] = size;
+            if (!avi_index_add(&vp_video_index, data_pos, size, 0)) break;
+            uint32_t peek = (size < sizeof(vop)) ? size : sizeof(vop);
+            if (fread(vop, 1, peek, vp_file) == peek && vp_vop_type(vop, peek) == 0) {
+                vp_set_keyframe(vp_total_frames);
+            }
+            fseek(vp_file, data_pos, SEEK_SET);
             vp_total_frames++;
         }
         else if ((header[2] == 'w' || header[2] == 'W') && (header[3] == 'b' || header[3] == 'B')) {
             if (vp_total_audio_chunks < VP_MAX_AUDIO_CHUNKS) {
-                vp_audio_offsets[vp_total_audio_chunks] = data_pos;
-                vp_audio_sizes[vp_total_audio_chunks] = size;
+                if (!avi_index_add(&vp_audio_index, data_pos, size, 0)) break;
                 vp_total_audio_bytes += size;
                 vp_total_audio_chunks++;
             }
@@ -1088,6 +1124,315 @@ static void vp_scan_movi(long movi_start, long movi_end) {
 
         fseek(vp_file, size + (size & 1), SEEK_CUR);
     }
+
+    avi_index_finish(&vp_video_index);
+    avi_index_finish(&vp_audio_index);
+}
+
+// ============== INDEX CACHE ==============
+// Scanning movi of an AVI without idx1 costs one seek per chunk - keep the
+// result next to the other FrogUI data and load it in one read next time
+
+#define VP_CACHE_VERSION 3
+#define VP_CACHE_SECTIONS (2 + 2 * AVI_INDEX_PARTS)
+
+// Parsed stream headers stored with the index
+typedef struct {
+    uint32_t us_per_frame;
+    uint32_t clip_fps;
+    int32_t repeat_count;
+    int32_t video_width;
+    int32_t video_height;
+    int32_t total_frames;
+    int32_t total_keyframes;
+    int32_t total_audio_chunks;
+    uint32_t total_audio_bytes;
+    int32_t has_audio;
+    int32_t audio_format;
+    int32_t audio_channels;
+    int32_t audio_sample_rate;
+    int32_t audio_bits;
+    int32_t audio_bytes_per_sample;
+    int32_t adpcm_kind;
+    int32_t adpcm_block_align;
+    int32_t adpcm_samples_per_block;
+    uint32_t audio_scale;
+    uint32_t audio_rate;
+    uint32_t audio_sample_size;
+    uint32_t audio_avg_bytes;
+    int32_t extradata_size;
+    uint8_t extradata[VP_MAX_EXTRADATA_SIZE];
+} vp_cache_header_t;
+
+static void vp_cache_save(void) {
+    vp_cache_header_t h;
+    avi_cache_section_t sec[VP_CACHE_SECTIONS];
+    const void *data[AVI_INDEX_PARTS];
+    uint32_t size[AVI_INDEX_PARTS];
+
+    memset(&h, 0, sizeof(h));
+    h.us_per_frame = vp_us_per_frame;
+    h.clip_fps = vp_clip_fps;
+    h.repeat_count = vp_repeat_count;
+    h.video_width = vp_video_width;
+    h.video_height = vp_video_height;
+    h.total_frames = vp_total_frames;
+    h.total_keyframes = vp_total_keyframes;
+    h.total_audio_chunks = vp_total_audio_chunks;
+    h.total_audio_bytes = vp_total_audio_bytes;
+    h.has_audio = vp_has_audio;
+    h.audio_format = vp_audio_format;
+    h.audio_channels = vp_audio_channels;
+    h.audio_sample_rate = vp_audio_sample_rate;
+    h.audio_bits = vp_audio_bits;
+    h.audio_bytes_per_sample = vp_audio_bytes_per_sample;
+    h.adpcm_kind = vp_adpcm_kind;
+    h.adpcm_block_align = vp_adpcm_block_align;
+    h.adpcm_samples_per_block = vp_adpcm_samples_per_block;
+    h.audio_scale = vp_audio_scale;
+    h.audio_rate = vp_audio_rate;
+    h.audio_sample_size = vp_audio_sample_size;
+    h.audio_avg_bytes = vp_audio_avg_bytes;
+    h.extradata_size = vp_mpeg4_extradata_size;
+    memcpy(h.extradata, vp_mpeg4_extradata, vp_mpeg4_extradata_size);
+
+    sec[0].data = &h;
+    sec[0].size = sizeof(h);
+    int keys = (vp_total_frames + 7) >> 3;
+    sec[1].data = vp_frame_keys;
+    sec[1].size = (keys < vp_frame_keys_size) ? keys : vp_frame_keys_size;
+
+    avi_index_parts(&vp_video_index, data, size);
+    for (int i = 0; i < AVI_INDEX_PARTS; i++) {
+        sec[2 + i].data = data[i];
+        sec[2 + i].size = size[i];
+    }
+    avi_index_parts(&vp_audio_index, data, size);
+    for (int i = 0; i < AVI_INDEX_PARTS; i++) {
+        sec[2 + AVI_INDEX_PARTS + i].data = data[i];
+        sec[2 + AVI_INDEX_PARTS + i].size = size[i];
+    }
+
+    avi_cache_save(vp_current_path, AVI_CACHE_KIND_PLAYER, VP_CACHE_VERSION,
+                   sec, VP_CACHE_SECTIONS);
+}
+
+// Returns 1 if headers and index were restored from the cache
+static int vp_cache_load(void) {
+    avi_cache_section_t sec[VP_CACHE_SECTIONS];
+    const void *data[AVI_INDEX_PARTS];
+    uint32_t size[AVI_INDEX_PARTS];
+    vp_cache_header_t h;
+
+    void *buf = avi_cache_load(vp_current_path, AVI_CACHE_KIND_PLAYER, VP_CACHE_VERSION,
+                               sec, VP_CACHE_SECTIONS);
+    if (!buf) return 0;
+    if (sec[0].size != sizeof(h)) {
+        free(buf);
+        return 0;
+    }
+    memcpy(&h, sec[0].data, sizeof(h));
+    if (h.total_frames <= 0 || h.extradata_size < 0 ||
+        h.extradata_size > VP_MAX_EXTRADATA_SIZE) {
+        free(buf);
+        return 0;
+    }
+
+    int ok = 1;
+    for (int i = 0; i < AVI_INDEX_PARTS; i++) {
+        data[i] = sec[2 + i].data;
+        size[i] = sec[2 + i].size;
+    }
+    ok = ok && avi_index_from_parts(&vp_video_index, data, size);
+    for (int i = 0; i < AVI_INDEX_PARTS; i++) {
+        data[i] = sec[2 + AVI_INDEX_PARTS + i].data;
+        size[i] = sec[2 + AVI_INDEX_PARTS + i].size;
+    }
+    ok = ok && avi_index_from_parts(&vp_audio_index, data, size);
+    ok = ok && vp_video_index.count == h.total_frames &&
+         vp_audio_index.count == h.total_audio_chunks;
+    if (ok && sec[1].size > 0) {
+        vp_frame_keys = (uint8_t *)malloc(sec[1].size);
+        if (vp_frame_keys) {
+            memcpy(vp_frame_keys, sec[1].data, sec[1].size);
+            vp_frame_keys_size = sec[1].size;
+        } else {
+            ok = 0;
+        }
+    }
+    free(buf);
+    if (!ok) {
+        vp_free_index();
+        return 0;
+    }
+
+    vp_us_per_frame = h.us_per_frame;
+    vp_clip_fps = h.clip_fps;
+    vp_repeat_count = h.repeat_count;
+    vp_video_width = h.video_width;
+    vp_video_height = h.video_height;
+    vp_total_frames = h.total_frames;
+    vp_total_keyframes = h.total_keyframes;
+    vp_total_audio_chunks = h.total_audio_chunks;
+    vp_total_audio_bytes = h.total_audio_bytes;
+    vp_has_audio = h.has_audio;
+    vp_audio_format = h.audio_format;
+    vp_audio_channels = h.audio_channels;
+    vp_audio_sample_rate = h.audio_sample_rate;
+    vp_audio_bits = h.audio_bits;
+    vp_audio_bytes_per_sample = h.audio_bytes_per_sample;
+    vp_adpcm_kind = h.adpcm_kind;
+    vp_adpcm_block_align = h.adpcm_block_align;
+    vp_adpcm_samples_per_block = h.adpcm_samples_per_block;
+    vp_audio_scale = h.audio_scale;
+    vp_audio_rate = h.audio_rate;
+    vp_audio_sample_size = h.audio_sample_size;
+    vp_audio_avg_bytes = h.audio_avg_bytes;
+    vp_mpeg4_extradata_size = h.extradata_size;
+    memcpy(vp_mpeg4_extradata, h.extradata, h.extradata_size);
+    return 1;
+}
+
+// ============== OPENDML INDEX ==============
+
+// Read an indx super index (AVI_INDEX_OF_INDEXES) - positioned at its data
+static void vp_odml_read_indx(vp_odml_index_t *odml, uint32_t size) {
+    uint8_t hdr[24];
+    if (size < 24 || fread(hdr, 1, 24, vp_file) != 24) return;
+
+    uint16_t longs_per_entry = vp_read_u16_le(hdr);
+    uint8_t index_type = hdr[3];
+    uint32_t entries = vp_read_u32_le(hdr + 4);
+    if (longs_per_entry != 4 || index_type != 0) return;  // not a super index
+    if (entries > (size - 24) / 16) entries = (size - 24) / 16;
+    if (entries == 0) return;
+
+    odml->seg = (vp_odml_segment_t *)malloc(entries * sizeof(vp_odml_segment_t));
+    if (!odml->seg) return;
+
+    uint8_t e[16];
+    int n = 0;
+    for (uint32_t i = 0; i < entries; i++) {
+        if (fread(e, 1, 16, vp_file) != 16) break;
+        uint64_t offset = vp_read_u32_le(e) | ((uint64_t)vp_read_u32_le(e + 4) << 32);
+        if (offset == 0) continue;  // unused slot
+        odml->seg[n].offset = offset;
+        odml->seg[n].base = 0;
+        odml->seg[n].first = 0;
+        odml->seg[n].count = 0;
+        odml->seg[n].duration = vp_read_u32_le(e + 12);
+        n++;
+    }
+    odml->count = n;
+}
+
+// Read the header of every ix## chunk (entry count + base offset only)
+// Returns number of entries in the stream, or -1 on a bad ix## chunk
+static int vp_odml_scan_segments(vp_odml_index_t *odml) {
+    uint32_t total = 0;
+    uint8_t hdr[32];
+
+    for (int i = 0; i < odml->count; i++) {
+        vp_odml_segment_t *seg = &odml->seg[i];
+        if (vp_fseek64(seg->offset) != 0) return -1;
+        if (fread(hdr, 1, 32, vp_file) != 32) return -1;
+
+        // 'ix##' size | wLongsPerEntry bIndexSubType bIndexType nEntriesInUse dwChunkId qwBaseOffset
+        if (hdr[0] != 'i' || hdr[1] != 'x') return -1;
+        if (vp_read_u16_le(hdr + 8) != 2 || hdr[11] != 1) return -1;  // AVI_INDEX_OF_CHUNKS
+        if (vp_read_u32_le(hdr + 4) < 24) return -1;
+
+        uint32_t count = vp_read_u32_le(hdr + 12);
+        uint32_t max_count = (vp_read_u32_le(hdr + 4) - 24) / 8;
+        if (count > max_count) count = max_count;
+
+        seg->base = vp_read_u32_le(hdr + 20) | ((uint64_t)vp_read_u32_le(hdr + 24) << 32);
+        seg->first = total;
+        seg->count = count;
+        total += count;
+    }
+    return (int)total;
+}
+
+// Pager: read entries of a stream straight from its ix## chunks
+// ctx is the index being paged; src is the stream entry number to start at
+static int vp_odml_page(void *ctx, uint32_t src, int n, uint64_t *offset, uint32_t *size) {
+    int video = (ctx == &vp_video_index);
+    vp_odml_index_t *odml = video ? &vp_odml_video : &vp_odml_audio;
+    uint8_t buf[8 * 64];
+    int got = 0;
+
+    // Segment holding src (binary search over first entries)
+    int lo = 0, hi = odml->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (odml->seg[mid].first <= src) lo = mid; else hi = mid - 1;
+    }
+
+    for (int s = lo; s < odml->count && got < n; s++) {
+        vp_odml_segment_t *seg = &odml->seg[s];
+        if (src < seg->first || src >= seg->first + seg->count) continue;
+
+        uint32_t k = src - seg->first;
+        uint32_t batch = seg->count - k;
+        if (batch > (uint32_t)(n - got)) batch = n - got;
+        if (vp_fseek64(seg->offset + 32 + (uint64_t)k * 8) != 0) break;
+        if (fread(buf, 8, batch, vp_file) != batch) break;
+
+        for (uint32_t j = 0; j < batch; j++) {
+            uint32_t dw_size = vp_read_u32_le(buf + j * 8 + 4);
+            // dwOffset points at the chunk data; bit 31 of dwSize marks a delta frame
+            offset[got] = seg->base + vp_read_u32_le(buf + j * 8);
+            size[got] = dw_size & 0x7FFFFFFF;
+            if (video && !(dw_size & 0x80000000) && !vp_test_keyframe(src)) {
+                vp_set_keyframe(src);
+            }
+            got++;
+            src++;
+        }
+    }
+    return got;
+}
+
+// Build paged stream indexes from the super indexes - no ix## entries read yet
+static int vp_odml_build(void) {
+    int frames = vp_odml_scan_segments(&vp_odml_video);
+    if (frames <= 0) return 0;
+    int chunks = 0;
+    if (vp_odml_audio.count > 0) {
+        chunks = vp_odml_scan_segments(&vp_odml_audio);
+        if (chunks < 0) return 0;
+    }
+    if (frames > VP_MAX_FRAMES) frames = VP_MAX_FRAMES;
+    if (chunks > VP_MAX_AUDIO_CHUNKS) chunks = VP_MAX_AUDIO_CHUNKS;
+
+    avi_index_init(&vp_video_index, 1);
+    avi_index_init(&vp_audio_index, 1);
+    avi_index_set_pager(&vp_video_index, vp_odml_page, &vp_video_index);
+    avi_index_set_pager(&vp_audio_index, vp_odml_page, &vp_audio_index);
+    if (!avi_index_add_paged(&vp_video_index, frames, 0)) return 0;
+    if (!avi_index_add_paged(&vp_audio_index, chunks, 0)) return 0;
+
+    // Fixed-size audio samples: a segment's duration gives its bytes, so a
+    // byte seek only pages the ix## it lands in (some muxers leave it 0)
+    int seeds = (chunks > 0 && vp_audio_sample_size > 0);
+    for (int i = 0; seeds && i < vp_odml_audio.count; i++) {
+        if (vp_odml_audio.seg[i].count > 0 && vp_odml_audio.seg[i].duration == 0) seeds = 0;
+    }
+    if (seeds) {
+        uint64_t before = 0;
+        for (int i = 0; i < vp_odml_audio.count; i++) {
+            if (!avi_index_seed(&vp_audio_index, vp_odml_audio.seg[i].first, before)) break;
+            before += (uint64_t)vp_odml_audio.seg[i].duration * vp_audio_sample_size;
+        }
+        avi_index_seed(&vp_audio_index, vp_odml_audio.seg[vp_odml_audio.count - 1].first +
+                       vp_odml_audio.seg[vp_odml_audio.count - 1].count, before);
+    }
+
+    vp_total_frames = frames;
+    vp_total_audio_chunks = chunks;
+    vp_keys_lazy = 1;
+    return 1;
 }
 
 // Parse AVI file structure
@@ -1099,8 +1444,10 @@ static int vp_parse_avi(void) {
     uint8_t buf[64];
     int found_idx1 = 0;
     int strl_type = 0;
+    uint32_t strh_scale = 0, strh_rate = 0, strh_sample_size = 0;
 
     vp_total_frames = 0;
+    vp_free_index();
     vp_total_audio_chunks = 0;
     vp_total_audio_bytes = 0;
     vp_video_width = 320;
@@ -1111,8 +1458,13 @@ static int vp_parse_avi(void) {
     vp_clip_fps = 30;
     vp_has_audio = 0;
     vp_audio_format = 0;
+    vp_adpcm_kind = ADPCM_MS;
     vp_adpcm_block_align = 0;
     vp_adpcm_samples_per_block = 0;
+    vp_audio_scale = 0;
+    vp_audio_rate = 0;
+    vp_audio_sample_size = 0;
+    vp_audio_avg_bytes = 0;
 
     if (!vp_check4(vp_file, "RIFF")) return 0;
     if (vp_read32(vp_file, &chunk_size) != 0) return 0;
@@ -1170,6 +1522,11 @@ static int vp_parse_avi(void) {
                                         if (buf[0] == 'a' && buf[1] == 'u' &&
                                             buf[2] == 'd' && buf[3] == 's') {
                                             strl_type = 2;
+                                            if (shsize >= 48) {
+                                                strh_scale = vp_read_u32_le(buf + 20);
+                                                strh_rate = vp_read_u32_le(buf + 24);
+                                                strh_sample_size = vp_read_u32_le(buf + 44);
+                                            }
                                         }
                                         else if (buf[0] == 'v' && buf[1] == 'i' &&
                                             buf[2] == 'd' && buf[3] == 's') {
@@ -1197,16 +1554,16 @@ static int vp_parse_avi(void) {
                                                 vp_audio_format = VP_AUDIO_FMT_PCM;
                                                 vp_audio_bytes_per_sample = (vp_audio_bits / 8) * vp_audio_channels;
                                             }
-                                            else if (fmt == 2 && vp_audio_channels > 0 && vp_audio_sample_rate > 0) {
-                                                // MS ADPCM audio
+                                            else if (adpcm_kind_from_tag(fmt) >= 0 && vp_audio_channels > 0 && vp_audio_sample_rate > 0) {
+                                                // MS ADPCM or IMA ADPCM audio
                                                 vp_has_audio = 1;
                                                 vp_audio_format = VP_AUDIO_FMT_ADPCM;
+                                                vp_adpcm_kind = adpcm_kind_from_tag(fmt);
                                                 vp_audio_bytes_per_sample = 2 * vp_audio_channels;
                                                 if (shsize >= 20) {
                                                     vp_adpcm_samples_per_block = vp_read_u16_le(buf + 18);
                                                 } else {
-                                                    int header = (vp_audio_channels == 1) ? 7 : 14;
-                                                    vp_adpcm_samples_per_block = 2 + (vp_adpcm_block_align - header) * 2 / vp_audio_channels;
+                                                    vp_adpcm_samples_per_block = adpcm_block_frames(vp_adpcm_kind, vp_adpcm_block_align, vp_audio_channels);
                                                 }
                                             }
                                             else if (fmt == 0x55 && vp_audio_channels > 0 && vp_audio_sample_rate > 0) {
@@ -1215,6 +1572,12 @@ static int vp_parse_avi(void) {
                                                 vp_audio_format = VP_AUDIO_FMT_MP3;
                                                 vp_audio_bytes_per_sample = 4;  // Stereo 16-bit output
                                             }
+                                            if (vp_has_audio) {
+                                                vp_audio_scale = strh_scale;
+                                                vp_audio_rate = strh_rate;
+                                                vp_audio_sample_size = strh_sample_size;
+                                                vp_audio_avg_bytes = vp_read_u32_le(buf + 8);
+                                            }
                                             if (shsize > 64) fseek(vp_file, shsize - 64, SEEK_CUR);
                                         }
                                     }
@@ -1237,6 +1600,17 @@ static int vp_parse_avi(void) {
                                         fseek(vp_file, shsize, SEEK_CUR);
                                     }
                                 }
+                                else if (htag[0] == 'i' && htag[1] == 'n' &&
+                                         htag[2] == 'd' && htag[3] == 'x') {
+                                    // OpenDML super index of this stream
+                                    long indx_end = ftell(vp_file) + shsize + (shsize & 1);
+                                    if (strl_type == 1 && vp_odml_video.count == 0) {
+                                        vp_odml_read_indx(&vp_odml_video, shsize);
+                                    } else if (strl_type == 2 && vp_odml_audio.count == 0) {
+                                        vp_odml_read_indx(&vp_odml_audio, shsize);
+                                    }
+                                    fseek(vp_file, indx_end, SEEK_SET);
+                                }
                                 else {
                                     fseek(vp_file, shsize + (shsize & 1), SEEK_CUR);
                                 }
@@ -1254,10 +1628,26 @@ static int vp_parse_avi(void) {
                      list_type[2] == 'v' && list_type[3] == 'i') {
                 movi_start = ftell(vp_file);
                 movi_end = movi_start + chunk_size - 4;
+
+                // OpenDML: indx covers this movi and all RIFF AVIX parts, idx1 only the first 1 GB
+                if (vp_odml_video.count > 0 && (!vp_has_audio || vp_odml_audio.count > 0)) {
+                    if (vp_odml_build()) break;
+                    vp_free_index();
+                }
+
                 fseek(vp_file, movi_end, SEEK_SET);
                 found_idx1 = vp_parse_idx1(movi_start);
                 if (!found_idx1) {
-                    vp_scan_movi(movi_start, movi_end);
+                    // idx1 may have been partially read - start over
+                    vp_total_frames = 0;
+                    vp_total_audio_chunks = 0;
+                    vp_total_audio_bytes = 0;
+                    vp_free_index();
+                    // Only a scanned index is worth a sidecar
+                    if (!vp_cache_load()) {
+                        vp_scan_movi(movi_start, movi_end);
+                        if (vp_total_frames > 0) vp_cache_save();
+                    }
                 }
                 break;
             }
@@ -1273,6 +1663,61 @@ static int vp_parse_avi(void) {
     return (vp_total_frames > 0) ? 1 : 0;
 }
 
+// ============== READ-AHEAD STREAM ==============
+
+// Allocate the windows (once per file)
+static int vp_stream_open(void) {
+    vp_stream_mem = (uint8_t *)malloc(VP_STREAM_WINDOWS * (VP_STREAM_WINDOW + VP_STREAM_PAD));
+    if (!vp_stream_mem) return 0;
+    for (int i = 0; i < VP_STREAM_WINDOWS; i++) {
+        vp_stream[i].data = vp_stream_mem + i * (VP_STREAM_WINDOW + VP_STREAM_PAD);
+        vp_stream[i].start = 0;
+        vp_stream[i].len = 0;
+        vp_stream[i].used = 0;
+    }
+    vp_stream_stamp = 0;
+    return 1;
+}
+
+static void vp_stream_close(void) {
+    if (vp_stream_mem) {
+        free(vp_stream_mem);
+        vp_stream_mem = NULL;
+    }
+    for (int i = 0; i < VP_STREAM_WINDOWS; i++) {
+        vp_stream[i].data = NULL;
+        vp_stream[i].len = 0;
+    }
+}
+
+// File bytes [offset, offset + size) as a slice of a read-ahead window.
+// Audio reads run ahead of video, so each ends up hitting its own window;
+// a miss refills the least recently used one with one big sequential read.
+// The slice stays valid until the next vp_stream_get() call.
+// Returns NULL if the range is larger than a window or can't be read.
+static const uint8_t *vp_stream_get(uint64_t offset, uint32_t size) {
+    if (!vp_stream_mem || size > VP_STREAM_WINDOW) return NULL;
+
+    vp_stream_stamp++;
+    vp_stream_window_t *lru = &vp_stream[0];
+    for (int i = 0; i < VP_STREAM_WINDOWS; i++) {
+        vp_stream_window_t *w = &vp_stream[i];
+        if (w->len > 0 && offset >= w->start && offset - w->start + size <= w->len) {
+            w->used = vp_stream_stamp;
+            return w->data + (offset - w->start);
+        }
+        if (w->used < lru->used) lru = w;
+    }
+
+    lru->len = 0;
+    lru->used = vp_stream_stamp;
+    if (vp_fseek64(offset) != 0) return NULL;
+    lru->start = offset;
+    lru->len = fread(lru->data, 1, VP_STREAM_WINDOW, vp_file);
+    if (lru->len < size) return NULL;
+    return lru->data;
+}
+
 // Initialize XVID decoder
 static int vp_init_xvid(void) {
     if (vp_xvid_initialized) return 1;
@@ -1295,24 +1740,6 @@ static int vp_init_xvid(void) {
     if (ret < 0) return 0;
 
     vp_xvid_handle = xcreate.handle;
-
-    int w = vp_video_width > 0 ? vp_video_width : 320;
-    int h = vp_video_height > 0 ? vp_video_height : 240;
-    int y_size = w * h;
-    int uv_size = (w / 2) * (h / 2);
-
-    vp_yuv_buffer = (uint8_t *)malloc(y_size + 2 * uv_size);
-    if (!vp_yuv_buffer) {
-        xvid_decore(vp_xvid_handle, XVID_DEC_DESTROY, NULL, NULL);
-        vp_xvid_handle = NULL;
-        return 0;
-    }
-
-    memset(vp_yuv_buffer, 0, y_size + 2 * uv_size);
-    vp_yuv_y = vp_yuv_buffer;
-    vp_yuv_u = vp_yuv_buffer + y_size;
-    vp_yuv_v = vp_yuv_buffer + y_size + uv_size;
-
     vp_xvid_initialized = 1;
     return 1;
 }
@@ -1322,27 +1749,56 @@ static void vp_close_xvid(void) {
         xvid_decore(vp_xvid_handle, XVID_DEC_DESTROY, NULL, NULL);
         vp_xvid_handle = NULL;
     }
-    if (vp_yuv_buffer) {
-        free(vp_yuv_buffer);
-        vp_yuv_buffer = NULL;
-        vp_yuv_y = NULL;
-        vp_yuv_u = NULL;
-        vp_yuv_v = NULL;
-    }
+    // Remembered picture lived inside the decoder
+    yuv2rgb_forget(&vp_conv);
     vp_xvid_initialized = 0;
 }
 
+// Rebuild converter tables when color mode or black level changes
+static void vp_update_converter(void) {
+    if (vp_conv_mode == vp_color_mode && vp_conv_black_level == vp_xvid_black_level) return;
+    if (!vp_gamma_tables_initialized) vp_init_gamma_tables();
+
+    // v60: Check if dithering is enabled for this color mode
+    int use_dither = (vp_color_mode == VP_COLOR_MODE_DITHERED ||
+                      vp_color_mode == VP_COLOR_MODE_DITHER2 ||
+                      vp_color_mode == VP_COLOR_MODE_NIGHT_DITHER ||
+                      vp_color_mode == VP_COLOR_MODE_NIGHT_DITHER2 ||
+                      vp_color_mode == VP_COLOR_MODE_NORMAL);
+
+    // Select Y range based on xvid black level setting (like pmp123)
+    yuv2rgb_setup(&vp_conv, vp_gamma_r5[vp_color_mode], vp_gamma_g6[vp_color_mode],
+                  vp_gamma_b5[vp_color_mode], use_dither,
+                  (vp_xvid_black_level == VP_XVID_BLACK_TV) ? YUV2RGB_RANGE_TV : YUV2RGB_RANGE_PC);
+    vp_conv_mode = vp_color_mode;
+    vp_conv_black_level = vp_xvid_black_level;
+}
+
+// Redraw last decoded picture with dithering and color mode
+static void vp_yuv_to_rgb565(uint16_t *dst) {
+    vp_update_converter();
+    yuv2rgb_redraw(&vp_conv, dst);
+}
+
 // Decode a single frame
-static int vp_decode_frame(int idx) {
+// dst: framebuffer to convert into, or NULL to only keep the picture for vp_yuv_to_rgb565()
+// Returns 1 if a new picture was output
+static int vp_decode_frame(int idx, uint16_t *dst) {
     if (!vp_file || idx >= vp_total_frames) return 0;
 
-    uint32_t offset = vp_frame_offsets[idx];
-    uint32_t size = vp_frame_sizes[idx];
+    uint64_t offset;
+    uint32_t size;
+    if (!vp_frame_chunk(idx, &offset, &size)) return 0;
 
     if (size > VP_MAX_FRAME_SIZE || size == 0) return 0;
 
-    if (fseek(vp_file, offset, SEEK_SET) != 0) return 0;
-    if (fread(vp_frame_buffer, 1, size, vp_file) != size) return 0;
+    const uint8_t *data = vp_stream_get(offset, size);
+    if (!data) {
+        // Chunk larger than a window - read it on its own
+        if (vp_fseek64(offset) != 0) return 0;
+        if (fread(vp_frame_buffer, 1, size, vp_file) != size) return 0;
+        data = vp_frame_buffer;
+    }
 
     if (!vp_xvid_initialized) {
         if (!vp_init_xvid()) return 0;
@@ -1363,10 +1819,9 @@ static int vp_decode_frame(int idx) {
         vp_mpeg4_extradata_sent = 1;
     }
 
-    int w = vp_video_width > 0 ? vp_video_width : 320;
-    int h = vp_video_height > 0 ? vp_video_height : 240;
+    vp_update_converter();
 
-    uint8_t *bitstream = vp_frame_buffer;
+    const uint8_t *bitstream = data;
     int remaining = size;
     int ret = 0;
     int loops = 0;
@@ -1379,26 +1834,26 @@ static int vp_decode_frame(int idx) {
 
         xframe.version = XVID_VERSION;
         xstats.version = XVID_VERSION;
-        xframe.bitstream = bitstream;
+        xframe.bitstream = (void *)bitstream;
         xframe.length = remaining;
-        xframe.output.csp = XVID_CSP_PLANAR;
-        xframe.output.plane[0] = vp_yuv_y;
-        xframe.output.plane[1] = vp_yuv_u;
-        xframe.output.plane[2] = vp_yuv_v;
-        xframe.output.stride[0] = w;
-        xframe.output.stride[1] = w / 2;
-        xframe.output.stride[2] = w / 2;
+        if (vp_xvid_discontinuity) {
+            // Don't let xvid output the pre-seek reference picture first
+            xframe.general |= XVID_DISCONTINUITY;
+            vp_xvid_discontinuity = 0;
+        }
+        xframe.output.csp = XVID_CSP_FROGUI;
+        xframe.output.plane[0] = dst;
+        xframe.output.plane[1] = &vp_conv;
+        xframe.output.stride[0] = SCREEN_WIDTH * sizeof(uint16_t);
 
         ret = xvid_decore(vp_xvid_handle, XVID_DEC_DECODE, &xframe, &xstats);
 
         if (xstats.type == XVID_TYPE_VOL) {
             if (xstats.data.vol.width > 0) {
                 vp_video_width = xstats.data.vol.width;
-                w = vp_video_width;
             }
             if (xstats.data.vol.height > 0) {
                 vp_video_height = xstats.data.vol.height;
-                h = vp_video_height;
             }
         }
 
@@ -1410,168 +1865,209 @@ static int vp_decode_frame(int idx) {
         loops++;
     } while (xstats.type <= 0 && ret > 0 && remaining > 4 && loops < 10);
 
-    return 1;
+    return (xstats.type > 0) ? 1 : 0;
 }
 
-// Convert YUV420P to RGB565 with dithering and color mode
-static void vp_yuv_to_rgb565(uint16_t *dst) {
-    if (!vp_yuv_tables_initialized) vp_init_yuv_tables();
-    if (!vp_gamma_tables_initialized) vp_init_gamma_tables();
-
-    int w = vp_video_width > 0 ? vp_video_width : 320;
-    int h = vp_video_height > 0 ? vp_video_height : 240;
+// ============== FRAME SCHEDULER ==============
 
-    // Center video on screen
-    int off_x = (SCREEN_WIDTH - w) / 2;
-    int off_y = (SCREEN_HEIGHT - h) / 2;
-    if (off_x < 0) off_x = 0;
-    if (off_y < 0) off_y = 0;
-
-    // Clear framebuffer (black background)
-    memset(dst, 0, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
+// Millisecond clock for frame timing
+static uint32_t vp_clock_ms(void) {
+#ifdef SF2000
+    return os_get_tick_count();
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+#endif
+}
 
-    // Select Y table based on xvid black level setting (like pmp123)
-    const int16_t *y_table = (vp_xvid_black_level == VP_XVID_BLACK_TV) ?
-                              vp_yuv_y_table_tv : vp_yuv_y_table_pc;
+// Running average in ms * 16 (1/8 weight for the new sample)
+static void vp_sched_measure(int *avg, uint32_t ms) {
+    *avg += ((int)(ms << 4) - *avg) / 8;
+}
 
-    // v60: Get color mode gamma tables
-    const uint8_t *gamma_r = vp_gamma_r5[vp_color_mode];
-    const uint8_t *gamma_g = vp_gamma_g6[vp_color_mode];
-    const uint8_t *gamma_b = vp_gamma_b5[vp_color_mode];
+// Coding type of the first VOP in a video chunk without decoding it
+// Returns 0=I, 1=P, 2=B, 3=S or -1 if no VOP header in the first bytes
+static int vp_peek_vop_type(int idx) {
+    uint64_t offset;
+    uint32_t size;
+    if (!vp_frame_chunk(idx, &offset, &size)) return -1;
+    if (size > 64) size = 64;
+    if (size < 5) return -1;
 
-    // v60: Check if dithering is enabled for this color mode
-    int use_dither = (vp_color_mode == VP_COLOR_MODE_DITHERED ||
-                      vp_color_mode == VP_COLOR_MODE_DITHER2 ||
-                      vp_color_mode == VP_COLOR_MODE_NIGHT_DITHER ||
-                      vp_color_mode == VP_COLOR_MODE_NIGHT_DITHER2 ||
-                      vp_color_mode == VP_COLOR_MODE_NORMAL);
+    const uint8_t *buf = vp_stream_get(offset, size);
+    if (!buf) return -1;
 
-    for (int j = 0; j < h && (off_y + j) < SCREEN_HEIGHT; j++) {
-        uint8_t *y_row = vp_yuv_y + j * w;
-        uint8_t *u_row = vp_yuv_u + (j >> 1) * (w / 2);
-        uint8_t *v_row = vp_yuv_v + (j >> 1) * (w / 2);
-        uint16_t *dst_row = dst + (off_y + j) * SCREEN_WIDTH + off_x;
-
-        for (int i = 0; i < w && (off_x + i) < SCREEN_WIDTH; i++) {
-            int y = y_table[y_row[i]];
-            int u_idx = u_row[i >> 1];
-            int v_idx = v_row[i >> 1];
-
-            int r = y + vp_yuv_rv_table[v_idx];
-            int g = y + vp_yuv_gu_table[u_idx] + vp_yuv_gv_table[v_idx];
-            int b = y + vp_yuv_bu_table[u_idx];
-
-            if (r < 0) r = 0; else if (r > 255) r = 255;
-            if (g < 0) g = 0; else if (g > 255) g = 255;
-            if (b < 0) b = 0; else if (b > 255) b = 255;
-
-            // Bayer dithering (optional based on color mode)
-            if (use_dither) {
-                int dither = vp_bayer4x4[j & 3][i & 3];
-                r = r + dither;
-                g = g + dither;
-                b = b + dither;
-                if (r < 0) r = 0; else if (r > 255) r = 255;
-                if (g < 0) g = 0; else if (g > 255) g = 255;
-                if (b < 0) b = 0; else if (b > 255) b = 255;
-            }
+    return vp_vop_type(buf, size);
+}
 
-            // v60: Apply color mode gamma correction
-            int r5 = r >> 3;
-            int g6 = g >> 2;
-            int b5 = b >> 3;
-            dst_row[i] = (gamma_r[r5] << 11) | (gamma_g[g6] << 5) | gamma_b[b5];
-        }
+static int vp_is_keyframe(int idx) {
+    if (vp_keys_lazy) {
+        // Paging the entry in sets its keyframe bit
+        uint64_t offset;
+        uint32_t size;
+        if (!vp_frame_chunk(idx, &offset, &size)) return 0;
+        return vp_test_keyframe(idx);
     }
+    // idx1 without any keyframe flag set - ask the bitstream
+    if (vp_total_keyframes == 0) return vp_peek_vop_type(idx) == 0;
+    return vp_test_keyframe(idx);
 }
 
-// ============== AUDIO FUNCTIONS ==============
-
-// Decode one MS ADPCM sample
-static inline int16_t vp_decode_adpcm_sample(int nibble, int ch) {
-    int unsigned_nibble = nibble & 0xF;
-    int pred = ((vp_adpcm_sample1[ch] * vp_adpcm_coef1[vp_adpcm_coef_idx[ch]]) +
-                (vp_adpcm_sample2[ch] * vp_adpcm_coef2[vp_adpcm_coef_idx[ch]])) >> 8;
-    int signed_nibble = (nibble & 0x8) ? (nibble - 16) : nibble;
-    int sample = pred + signed_nibble * vp_adpcm_delta[ch];
-    sample = vp_clamp16(sample);
-    vp_adpcm_sample2[ch] = vp_adpcm_sample1[ch];
-    vp_adpcm_sample1[ch] = sample;
-    vp_adpcm_delta[ch] = (vp_adpcm_adapt_table[unsigned_nibble] * vp_adpcm_delta[ch]) >> 8;
-    if (vp_adpcm_delta[ch] < 16) vp_adpcm_delta[ch] = 16;
-    return sample;
+// Nearest keyframe at or before idx (0 if none).
+// OpenDML indexes are paged in as the walk goes, so there it only looks
+// VP_SEEK_MAX_PREROLL_SEC back, then as far forward; with no keyframe in
+// either window idx itself is returned and decoded directly.
+static int vp_find_keyframe(int idx) {
+    if (vp_keys_lazy) {
+        int limit = (vp_clip_fps > 0 ? (int)vp_clip_fps : 30) * VP_SEEK_MAX_PREROLL_SEC;
+        for (int i = idx; i >= 0 && i >= idx - limit; i--) {
+            if (vp_is_keyframe(i)) return i;
+        }
+        if (idx <= limit) return 0;  // the first frame starts the stream
+        for (int i = idx + 1; i < vp_total_frames && i <= idx + limit; i++) {
+            if (vp_is_keyframe(i)) return i;
+        }
+        return idx;
+    }
+    if (vp_total_keyframes == 0) return idx;  // unknown - decode target directly (pre-idx behavior)
+    if ((idx >> 3) >= vp_frame_keys_size) idx = vp_frame_keys_size * 8 - 1;
+    while (idx > 0) {
+        // Whole empty bitmap bytes at once
+        if ((idx & 7) == 7 && vp_frame_keys[idx >> 3] == 0) {
+            idx -= 8;
+            continue;
+        }
+        if (vp_test_keyframe(idx)) return idx;
+        idx--;
+    }
+    return 0;
 }
 
-// Decode one MS ADPCM block (mono)
-static int vp_decode_adpcm_block_mono(uint8_t *src, int src_size, int16_t *dst, int max_samples) {
-    if (src_size < 7) return 0;
+// Forget the clock anchor (after seek, pause, menu, loop)
+static void vp_sched_reset(void) {
+    vp_sched_anchored = 0;
+}
+
+// Decode the frame due for this render into dst.
+// When behind the clock, catches up in steps: frames that won't be shown are
+// decoded without color conversion, then B-frames are dropped undecoded, then
+// everything up to the last keyframe that is already due is skipped.
+// Returns 1 if a new picture was written to dst
+static int vp_sched_decode(uint16_t *dst) {
+    uint32_t now = vp_clock_ms();
+    int fps = vp_clip_fps > 0 ? (int)vp_clip_fps : 30;
+
+    if (!vp_sched_anchored) {
+        vp_sched_base_ms = now;
+        vp_sched_base_frame = vp_current_frame;
+        vp_sched_anchored = 1;
+    }
+
+    int due = vp_sched_base_frame + (int)((uint64_t)(now - vp_sched_base_ms) * fps / 1000);
+    if (due >= vp_total_frames) due = vp_total_frames - 1;
+    int lag = due - vp_current_frame;
+
+    if (lag < 0) {
+        // Ahead of the clock (display cadence is faster) - follow the cadence
+        vp_sched_base_ms = now;
+        vp_sched_base_frame = vp_current_frame;
+    } else if (lag > VP_SCHED_SLACK_FRAMES) {
+        int lag_ms = lag * 1000 / fps;
+        int budget_ms = vp_repeat_count * 1000 / fps;
+
+        // Far behind: jump to the last keyframe that is already due
+        if (lag_ms >= VP_SCHED_KEYFRAME_LAG_MS) {
+            int last = due;
+            if (last > vp_current_frame + VP_SCHED_KEY_SCAN) last = vp_current_frame + VP_SCHED_KEY_SCAN;
+            int key = -1;
+            for (int i = vp_current_frame + 1; i <= last; i++) {
+                if (vp_is_keyframe(i)) key = i;
+            }
+            if (key > 0) {
+                vp_stat_dropped += key - vp_current_frame;
+                vp_current_frame = key;
+            }
+        }
 
-    vp_adpcm_coef_idx[0] = src[0];
-    if (vp_adpcm_coef_idx[0] > 6) vp_adpcm_coef_idx[0] = 0;
-    vp_adpcm_delta[0] = (int16_t)(src[1] | (src[2] << 8));
-    vp_adpcm_sample1[0] = (int16_t)(src[3] | (src[4] << 8));
-    vp_adpcm_sample2[0] = (int16_t)(src[5] | (src[6] << 8));
+        // Decode overdue frames without showing them, as long as the budget allows
+        int extra = 0;
+        while (vp_current_frame < due && extra < VP_SCHED_MAX_CATCHUP) {
+            uint32_t spent = vp_clock_ms() - now;
+            if (extra > 0 && (int)(spent << 4) + vp_sched_decode_cost > (budget_ms << 4)) break;
 
-    int out_idx = 0;
-    if (out_idx < max_samples) dst[out_idx++] = vp_adpcm_sample2[0];
-    if (out_idx < max_samples) dst[out_idx++] = vp_adpcm_sample1[0];
+            if (lag_ms >= VP_SCHED_DROP_B_LAG_MS && vp_peek_vop_type(vp_current_frame) == 2) {
+                // Nothing references a B-frame - drop it undecoded
+                vp_stat_dropped++;
+            } else {
+                uint32_t t0 = vp_clock_ms();
+                vp_decode_frame(vp_current_frame, NULL);
+                vp_sched_measure(&vp_sched_decode_cost, vp_clock_ms() - t0);
+                vp_stat_skipped++;
+            }
+            vp_current_frame++;
+            extra++;
+        }
 
-    for (int i = 7; i < src_size && out_idx < max_samples; i++) {
-        dst[out_idx++] = vp_decode_adpcm_sample((src[i] >> 4) & 0xF, 0);
-        if (out_idx < max_samples)
-            dst[out_idx++] = vp_decode_adpcm_sample(src[i] & 0xF, 0);
+        if (vp_current_frame < due) vp_stat_late++;
     }
 
-    return out_idx;
+    uint32_t t0 = vp_clock_ms();
+    int drawn = vp_decode_frame(vp_current_frame, dst);
+    vp_sched_measure(&vp_sched_frame_cost, vp_clock_ms() - t0);
+    return drawn;
 }
 
-// Decode one MS ADPCM block (stereo)
-static int vp_decode_adpcm_block_stereo(uint8_t *src, int src_size, int16_t *dst, int max_samples) {
-    if (src_size < 14) return 0;
-
-    vp_adpcm_coef_idx[0] = src[0];
-    vp_adpcm_coef_idx[1] = src[1];
-    if (vp_adpcm_coef_idx[0] > 6) vp_adpcm_coef_idx[0] = 0;
-    if (vp_adpcm_coef_idx[1] > 6) vp_adpcm_coef_idx[1] = 0;
-
-    vp_adpcm_delta[0] = (int16_t)(src[2] | (src[3] << 8));
-    vp_adpcm_delta[1] = (int16_t)(src[4] | (src[5] << 8));
-    vp_adpcm_sample1[0] = (int16_t)(src[6] | (src[7] << 8));
-    vp_adpcm_sample1[1] = (int16_t)(src[8] | (src[9] << 8));
-    vp_adpcm_sample2[0] = (int16_t)(src[10] | (src[11] << 8));
-    vp_adpcm_sample2[1] = (int16_t)(src[12] | (src[13] << 8));
+// Dropped / late / skipped counters and decode cost (vp_show_debug)
+static void vp_draw_debug(void) {
+    int x = 2, y = SCREEN_HEIGHT - 10;
+    vp_draw_str(x, y, "D:", 0xFFE0); x += 12;
+    vp_draw_num(x, y, vp_stat_dropped, 0xFFFF); x += vp_num_width(vp_stat_dropped) + 6;
+    vp_draw_str(x, y, "L:", 0xFFE0); x += 12;
+    vp_draw_num(x, y, vp_stat_late, 0xFFFF); x += vp_num_width(vp_stat_late) + 6;
+    vp_draw_str(x, y, "S:", 0xFFE0); x += 12;
+    vp_draw_num(x, y, vp_stat_skipped, 0xFFFF); x += vp_num_width(vp_stat_skipped) + 6;
+    vp_draw_num(x, y, vp_sched_frame_cost >> 4, 0xFFFF); x += vp_num_width(vp_sched_frame_cost >> 4);
+    vp_draw_str(x, y, "ms", 0x7BEF);
+}
 
-    int out_idx = 0;
-    if (out_idx + 1 < max_samples) {
-        dst[out_idx++] = vp_adpcm_sample2[0];
-        dst[out_idx++] = vp_adpcm_sample2[1];
-    }
-    if (out_idx + 1 < max_samples) {
-        dst[out_idx++] = vp_adpcm_sample1[0];
-        dst[out_idx++] = vp_adpcm_sample1[1];
-    }
+// ============== AUDIO FUNCTIONS ==============
 
-    for (int i = 14; i < src_size && out_idx + 1 < max_samples; i++) {
-        dst[out_idx++] = vp_decode_adpcm_sample((src[i] >> 4) & 0xF, 0);
-        dst[out_idx++] = vp_decode_adpcm_sample(src[i] & 0xF, 1);
+// Step the audio read position back by bytes, across chunks if needed
+static void vp_unread_audio(uint32_t bytes) {
+    while (bytes > 0) {
+        if (vp_audio_chunk_pos == 0) {
+            uint64_t chunk_offset;
+            uint32_t chunk_size;
+            if (vp_audio_chunk_idx == 0 ||
+                !vp_audio_chunk(vp_audio_chunk_idx - 1, &chunk_offset, &chunk_size)) return;
+            vp_audio_chunk_idx--;
+            vp_audio_chunk_pos = chunk_size;
+        }
+        uint32_t n = (bytes < vp_audio_chunk_pos) ? bytes : vp_audio_chunk_pos;
+        vp_audio_chunk_pos -= n;
+        bytes -= n;
     }
-
-    return out_idx;
 }
 
-// Read raw PCM from disk into ring buffer
-static int vp_read_audio_disk_pcm(uint8_t *buf, int bytes_needed) {
+// Read raw PCM from disk, whole frames of frame_bytes only: a partial frame
+// at the end is left for the next read, so channels never swap
+static int vp_read_audio_disk_pcm(uint8_t *buf, int bytes_needed, int frame_bytes) {
     int bytes_read = 0;
     while (bytes_read < bytes_needed && vp_audio_chunk_idx < vp_total_audio_chunks) {
-        uint32_t chunk_size = vp_audio_sizes[vp_audio_chunk_idx];
+        uint64_t chunk_offset;
+        uint32_t chunk_size;
+        if (!vp_audio_chunk(vp_audio_chunk_idx, &chunk_offset, &chunk_size)) break;
         uint32_t remaining = chunk_size - vp_audio_chunk_pos;
         uint32_t to_read = bytes_needed - bytes_read;
         if (to_read > remaining) to_read = remaining;
 
-        uint32_t file_pos = vp_audio_offsets[vp_audio_chunk_idx] + vp_audio_chunk_pos;
-        if (fseek(vp_file, file_pos, SEEK_SET) != 0) break;
+        uint64_t file_pos = chunk_offset + vp_audio_chunk_pos;
+        const uint8_t *src = vp_stream_get(file_pos, to_read);
+        if (!src) break;
 
-        size_t got = fread(buf + bytes_read, 1, to_read, vp_file);
+        uint32_t got = to_read;
+        memcpy(buf + bytes_read, src, got);
         bytes_read += got;
         vp_audio_chunk_pos += got;
 
@@ -1579,36 +2075,44 @@ static int vp_read_audio_disk_pcm(uint8_t *buf, int bytes_needed) {
             vp_audio_chunk_idx++;
             vp_audio_chunk_pos = 0;
         }
-        if (got < to_read) break;
     }
-    return bytes_read;
+
+    int partial = bytes_read % frame_bytes;
+    vp_unread_audio(partial);
+    return bytes_read - partial;
 }
 
 // Read and decode ADPCM
 static int vp_read_audio_disk_adpcm(void) {
     if (vp_adpcm_block_align <= 0 || vp_audio_chunk_idx >= vp_total_audio_chunks) return 0;
+    if (vp_audio_channels < 1 || vp_audio_channels > 2) return 0;
 
-    int total_decoded_bytes = 0;
-    int free_space = VP_AUDIO_RING_SIZE - vp_aring_count;
+    // Blocks are decoded straight into the ring, so wait for room for a whole one
+    int max_block = (vp_adpcm_block_align > VP_ADPCM_MAX_BLOCK) ? VP_ADPCM_MAX_BLOCK : vp_adpcm_block_align;
+    uint32_t block_frames = adpcm_block_frames(vp_adpcm_kind, max_block, vp_audio_channels);
 
-    while (free_space > 512 && vp_audio_chunk_idx < vp_total_audio_chunks) {
-        uint32_t chunk_size = vp_audio_sizes[vp_audio_chunk_idx];
+    int total_decoded_frames = 0;
+
+    while (audio_ring_space(&vp_ring) >= block_frames && vp_audio_chunk_idx < vp_total_audio_chunks) {
+        uint64_t chunk_offset;
+        uint32_t chunk_size;
+        if (!vp_audio_chunk(vp_audio_chunk_idx, &chunk_offset, &chunk_size)) break;
         uint32_t remaining = chunk_size - vp_audio_chunk_pos;
 
         int block_size = vp_adpcm_block_align;
         if (block_size > (int)remaining) block_size = remaining;
-        if (block_size > (int)sizeof(vp_adpcm_read_buf)) block_size = sizeof(vp_adpcm_read_buf);
+        if (block_size > VP_ADPCM_MAX_BLOCK) block_size = VP_ADPCM_MAX_BLOCK;
         if (block_size < 7) {
             vp_audio_chunk_idx++;
             vp_audio_chunk_pos = 0;
             continue;
         }
 
-        uint32_t file_pos = vp_audio_offsets[vp_audio_chunk_idx] + vp_audio_chunk_pos;
-        if (fseek(vp_file, file_pos, SEEK_SET) != 0) break;
+        uint64_t file_pos = chunk_offset + vp_audio_chunk_pos;
+        const uint8_t *block = vp_stream_get(file_pos, block_size);
+        if (!block) break;
 
-        size_t got = fread(vp_adpcm_read_buf, 1, block_size, vp_file);
-        if (got < 7) break;
+        int got = block_size;
 
         vp_audio_chunk_pos += got;
         if (vp_audio_chunk_pos >= chunk_size) {
@@ -1616,38 +2120,12 @@ static int vp_read_audio_disk_adpcm(void) {
             vp_audio_chunk_pos = 0;
         }
 
-        int samples;
-        if (vp_audio_channels == 1) {
-            samples = vp_decode_adpcm_block_mono(vp_adpcm_read_buf, got, vp_adpcm_decode_buf, VP_ADPCM_DECODE_BUF_SIZE);
-        } else {
-            samples = vp_decode_adpcm_block_stereo(vp_adpcm_read_buf, got, vp_adpcm_decode_buf, VP_ADPCM_DECODE_BUF_SIZE);
-        }
-
-        if (samples <= 0) continue;
-
-        int decoded_bytes = samples * 2;
-        if (decoded_bytes > free_space) decoded_bytes = free_space;
-
-        uint8_t *src = (uint8_t *)vp_adpcm_decode_buf;
-        int written = 0;
-        while (written < decoded_bytes) {
-            int before_wrap = VP_AUDIO_RING_SIZE - vp_aring_write;
-            int to_write = decoded_bytes - written;
-            if (to_write > before_wrap) to_write = before_wrap;
-
-            memcpy(vp_audio_ring + vp_aring_write, src + written, to_write);
-            vp_aring_write = (vp_aring_write + to_write) % VP_AUDIO_RING_SIZE;
-            written += to_write;
-        }
-
-        vp_aring_count += decoded_bytes;
-        free_space -= decoded_bytes;
-        total_decoded_bytes += decoded_bytes;
+        total_decoded_frames += adpcm_decode_block(vp_adpcm_kind, block, got, vp_audio_channels, &vp_ring);
 
-        if (total_decoded_bytes > 4096) break;
+        if (total_decoded_frames > 1024) break;
     }
 
-    return total_decoded_bytes;
+    return total_decoded_frames;
 }
 
 // Initialize MP3 decoder
@@ -1685,7 +2163,9 @@ static int vp_mp3_fill_input_buffer(void) {
     if (space <= 0) return vp_mp3_input_len;
 
     while (space > 0 && vp_audio_chunk_idx < vp_total_audio_chunks) {
-        uint32_t chunk_size = vp_audio_sizes[vp_audio_chunk_idx];
+        uint64_t chunk_offset;
+        uint32_t chunk_size;
+        if (!vp_audio_chunk(vp_audio_chunk_idx, &chunk_offset, &chunk_size)) break;
         uint32_t remaining = chunk_size - vp_audio_chunk_pos;
 
         if (remaining == 0) {
@@ -1696,11 +2176,12 @@ static int vp_mp3_fill_input_buffer(void) {
 
         int to_read = (space < (int)remaining) ? space : (int)remaining;
 
-        uint32_t file_pos = vp_audio_offsets[vp_audio_chunk_idx] + vp_audio_chunk_pos;
-        if (fseek(vp_file, file_pos, SEEK_SET) != 0) break;
+        uint64_t file_pos = chunk_offset + vp_audio_chunk_pos;
+        const uint8_t *src = vp_stream_get(file_pos, to_read);
+        if (!src) break;
 
-        size_t got = fread(vp_mp3_input_buf + vp_mp3_input_len, 1, to_read, vp_file);
-        if (got == 0) break;
+        int got = to_read;
+        memcpy(vp_mp3_input_buf + vp_mp3_input_len, src, got);
 
         vp_mp3_input_len += got;
         vp_audio_chunk_pos += got;
@@ -1723,11 +2204,10 @@ static int vp_read_audio_disk_mp3(void) {
     vp_mp3_init();
     if (!vp_mp3_handle) return 0;
 
-    int total_decoded_bytes = 0;
-    int free_space = VP_AUDIO_RING_SIZE - vp_aring_count;
+    int total_decoded_frames = 0;
     int consecutive_errors = 0;
 
-    while (free_space > 512 && consecutive_errors < 100) {
+    while (audio_ring_space(&vp_ring) > 128 && consecutive_errors < 100) {
         if (vp_mp3_input_remaining < 2048) {
             if (vp_mp3_fill_input_buffer() <= 0) break;
         }
@@ -1741,11 +2221,12 @@ static int vp_read_audio_disk_mp3(void) {
         int result = mad_decode(vp_mp3_handle,
                                 (char *)vp_mp3_input_buf, vp_mp3_input_len,
                                 (char *)vp_mp3_decode_buf, out_buf_size,
-                                &bytes_read, &bytes_done, 16, 0);
+                                &bytes_read, &bytes_done, 16, vp_mp3_half_rate);
 
         if (result == MAD_OK) {
             consecutive_errors = 0;
             if (vp_mp3_detected_samplerate == 0) {
+                // Rate of the synthesized output, already halved in half-rate mode
                 int sr = 0, ch = 0;
                 if (mad_get_info(vp_mp3_handle, &sr, &ch)) {
                     vp_mp3_detected_samplerate = sr;
@@ -1782,52 +2263,15 @@ static int vp_read_audio_disk_mp3(void) {
 
         int actual_channels = (vp_mp3_detected_channels > 0) ? vp_mp3_detected_channels : vp_audio_channels;
         if (actual_channels == 1) {
-            int mono_samples = bytes_done / 2;
-            int stereo_bytes = mono_samples * 4;
-
-            if (stereo_bytes > free_space) {
-                mono_samples = free_space / 4;
-                stereo_bytes = mono_samples * 4;
-            }
-
-            int16_t *mono_src = (int16_t *)vp_mp3_decode_buf;
-            for (int i = 0; i < mono_samples; i++) {
-                int16_t sample = mono_src[i];
-                vp_audio_ring[vp_aring_write] = sample & 0xFF;
-                vp_audio_ring[vp_aring_write + 1] = (sample >> 8) & 0xFF;
-                vp_audio_ring[vp_aring_write + 2] = sample & 0xFF;
-                vp_audio_ring[vp_aring_write + 3] = (sample >> 8) & 0xFF;
-                vp_aring_write = (vp_aring_write + 4) % VP_AUDIO_RING_SIZE;
-            }
-
-            vp_aring_count += stereo_bytes;
-            free_space -= stereo_bytes;
-            total_decoded_bytes += stereo_bytes;
+            total_decoded_frames += audio_ring_write_mono(&vp_ring, vp_mp3_decode_buf, bytes_done / 2);
         } else {
-            int decoded_bytes = bytes_done;
-            if (decoded_bytes > free_space) decoded_bytes = free_space;
-
-            uint8_t *src = (uint8_t *)vp_mp3_decode_buf;
-            int written = 0;
-            while (written < decoded_bytes) {
-                int before_wrap = VP_AUDIO_RING_SIZE - vp_aring_write;
-                int to_write = decoded_bytes - written;
-                if (to_write > before_wrap) to_write = before_wrap;
-
-                memcpy(vp_audio_ring + vp_aring_write, src + written, to_write);
-                vp_aring_write = (vp_aring_write + to_write) % VP_AUDIO_RING_SIZE;
-                written += to_write;
-            }
-
-            vp_aring_count += decoded_bytes;
-            free_space -= decoded_bytes;
-            total_decoded_bytes += decoded_bytes;
+            total_decoded_frames += audio_ring_write(&vp_ring, vp_mp3_decode_buf, bytes_done / 4);
         }
 
-        if (total_decoded_bytes > 4096) break;
+        if (total_decoded_frames > 1024) break;
     }
 
-    return total_decoded_bytes;
+    return total_decoded_frames;
 }
 
 // Refill audio ring buffer
@@ -1840,96 +2284,70 @@ static void vp_refill_audio_ring(void) {
         vp_read_audio_disk_mp3();
     } else {
         // PCM
-        int free_space = VP_AUDIO_RING_SIZE - vp_aring_count;
-        while (free_space > 0 && vp_audio_chunk_idx < vp_total_audio_chunks) {
-            int before_wrap = VP_AUDIO_RING_SIZE - vp_aring_write;
-            int to_read = (free_space < before_wrap) ? free_space : before_wrap;
-            if (to_read > 4096) to_read = 4096;
-
-            int got = vp_read_audio_disk_pcm(vp_audio_ring + vp_aring_write, to_read);
-            if (got <= 0) break;
-
-            vp_aring_write = (vp_aring_write + got) % VP_AUDIO_RING_SIZE;
-            vp_aring_count += got;
-            free_space -= got;
+        int frame_bytes = vp_audio_bytes_per_sample;
+        if (frame_bytes <= 0) return;
+        audio_ring_span_t span;
+        uint8_t temp[4096];
+
+        while (audio_ring_space(&vp_ring) > 0 && vp_audio_chunk_idx < vp_total_audio_chunks) {
+            audio_ring_write_span(&vp_ring, &span, sizeof(temp) / frame_bytes);
+            uint32_t frames = span.n[0];
+
+            if (vp_audio_bits == 16 && vp_audio_channels == 2) {
+                // Already the ring format - read straight into it
+                int got = vp_read_audio_disk_pcm((uint8_t *)span.p[0], frames * 4, 4);
+                if (got < 4) break;
+                audio_ring_commit_write(&vp_ring, got / 4);
+                continue;
+            }
+
+            int got = vp_read_audio_disk_pcm(temp, frames * frame_bytes, frame_bytes);
+            frames = got / frame_bytes;
+            if (frames == 0) break;
+
+            const uint8_t *src = temp;
+            int16_t *dst = span.p[0];
+            for (uint32_t i = 0; i < frames; i++, src += frame_bytes, dst += 2) {
+                if (vp_audio_bits == 8) {
+                    dst[0] = (int16_t)((src[0] - 128) << 8);
+                    dst[1] = (vp_audio_channels > 1) ? (int16_t)((src[1] - 128) << 8) : dst[0];
+                } else {
+                    dst[0] = (int16_t)(src[0] | (src[1] << 8));
+                    dst[1] = (vp_audio_channels > 1) ? (int16_t)(src[2] | (src[3] << 8)) : dst[0];
+                }
+            }
+            audio_ring_commit_write(&vp_ring, frames);
         }
     }
 }
 
-// Read from audio ring buffer
-static int vp_read_audio_ring(uint8_t *buf, int bytes_needed) {
-    int bytes_read = 0;
-    while (bytes_read < bytes_needed && vp_aring_count > 0) {
-        int before_wrap = VP_AUDIO_RING_SIZE - vp_aring_read;
-        int avail = (vp_aring_count < before_wrap) ? vp_aring_count : before_wrap;
-        int to_read = bytes_needed - bytes_read;
-        if (to_read > avail) to_read = avail;
-
-        memcpy(buf + bytes_read, vp_audio_ring + vp_aring_read, to_read);
-        vp_aring_read = (vp_aring_read + to_read) % VP_AUDIO_RING_SIZE;
-        vp_aring_count -= to_read;
-        bytes_read += to_read;
+// Sample rate of the audio ring (MP3 may be synthesized at half rate)
+static int vp_audio_ring_rate(void) {
+    if (vp_audio_format == VP_AUDIO_FMT_MP3) {
+        if (vp_mp3_detected_samplerate > 0) return vp_mp3_detected_samplerate;
+        return vp_audio_sample_rate >> vp_mp3_half_rate;
     }
-    return bytes_read;
+    return vp_audio_sample_rate;
 }
 
 // Play audio synced to current frame
 static void vp_play_audio_for_frame(void) {
     if (!vp_has_audio || !vp_audio_batch_cb || vp_audio_bytes_per_sample == 0) return;
 
-    if (vp_aring_count < VP_AUDIO_REFILL_THRESHOLD) {
+    if (audio_ring_count(&vp_ring) < VP_AUDIO_REFILL_THRESHOLD) {
         vp_refill_audio_ring();
     }
 
-    int effective_rate = vp_audio_sample_rate;
-    if (vp_audio_format == VP_AUDIO_FMT_MP3 && vp_mp3_detected_samplerate > 0) {
-        effective_rate = vp_mp3_detected_samplerate;
-    }
-
-    int sync_offset = effective_rate / 10;
-    uint64_t expected = (uint64_t)vp_current_frame * effective_rate / vp_clip_fps + sync_offset;
+    int sync_offset = VP_OUTPUT_RATE / 10;
+    uint64_t expected = (uint64_t)vp_current_frame * VP_OUTPUT_RATE / vp_clip_fps + sync_offset;
     int64_t to_send = expected - vp_audio_samples_sent;
 
     if (to_send <= 0) return;
     if (to_send > VP_MAX_AUDIO_BUFFER) to_send = VP_MAX_AUDIO_BUFFER;
 
-    int bytes_needed = to_send * vp_audio_bytes_per_sample;
-    uint8_t temp[VP_MAX_AUDIO_BUFFER * 4];
-    if (bytes_needed > (int)sizeof(temp)) {
-        bytes_needed = sizeof(temp);
-        to_send = bytes_needed / vp_audio_bytes_per_sample;
-    }
-
-    int got_bytes = vp_read_audio_ring(temp, bytes_needed);
-    int got_samples = got_bytes / vp_audio_bytes_per_sample;
-    if (got_samples <= 0) return;
-
-    int out = 0;
-    int effective_bits = (vp_audio_format == VP_AUDIO_FMT_ADPCM || vp_audio_format == VP_AUDIO_FMT_MP3) ? 16 : vp_audio_bits;
-    int effective_channels = (vp_audio_format == VP_AUDIO_FMT_MP3) ? 2 : vp_audio_channels;
-
-    if (effective_channels == 1 && effective_bits == 16) {
-        int16_t *src = (int16_t *)temp;
-        for (int i = 0; i < got_samples && out < VP_MAX_AUDIO_BUFFER; i++) {
-            vp_audio_out_buffer[out * 2] = src[i];
-            vp_audio_out_buffer[out * 2 + 1] = src[i];
-            out++;
-        }
-    } else if (effective_channels == 2 && effective_bits == 16) {
-        int16_t *src = (int16_t *)temp;
-        for (int i = 0; i < got_samples && out < VP_MAX_AUDIO_BUFFER; i++) {
-            vp_audio_out_buffer[out * 2] = src[i * 2];
-            vp_audio_out_buffer[out * 2 + 1] = src[i * 2 + 1];
-            out++;
-        }
-    } else if (effective_bits == 8) {
-        for (int i = 0; i < got_samples && out < VP_MAX_AUDIO_BUFFER; i++) {
-            int16_t s = ((int16_t)temp[i * effective_channels] - 128) << 8;
-            vp_audio_out_buffer[out * 2] = s;
-            vp_audio_out_buffer[out * 2 + 1] = s;
-            out++;
-        }
-    }
+    // MP3 rate is only known once the first frame is decoded
+    audio_resample_set_rate(&vp_resampler, vp_audio_ring_rate(), VP_OUTPUT_RATE);
+    int out = audio_resample_run(&vp_resampler, &vp_ring, vp_audio_out_buffer, (int)to_send);
 
     if (out > 0) {
         // v60: Mute first samples after seek to avoid audio crackle
@@ -1953,60 +2371,70 @@ static void vp_seek_to_frame(int target_frame) {
     if (target_frame < 0) target_frame = 0;
     if (target_frame > max_seek_frame) target_frame = max_seek_frame;
 
+    // Reference pictures are needed - start decoding at the preceding keyframe.
+    // If it is too far back (or only found ahead), land on the keyframe itself
+    // to keep seeks fast.
+    int key_frame = vp_find_keyframe(target_frame);
+    if (key_frame > target_frame ||
+        target_frame - key_frame > (int)vp_clip_fps * VP_SEEK_MAX_PREROLL_SEC) {
+        target_frame = key_frame;
+    }
+
     vp_current_frame = target_frame;
     vp_repeat_counter = 0;
+    vp_sched_reset();
 
     if (vp_has_audio && vp_audio_bytes_per_sample > 0) {
-        int effective_rate = vp_audio_sample_rate;
-        if (vp_audio_format == VP_AUDIO_FMT_MP3 && vp_mp3_detected_samplerate > 0) {
-            effective_rate = vp_mp3_detected_samplerate;
-        }
+        int effective_rate = vp_audio_ring_rate();
         uint64_t time_samples = (uint64_t)target_frame * effective_rate / vp_clip_fps;
 
-        vp_audio_chunk_idx = 0;
+        vp_audio_chunk_idx = vp_total_audio_chunks;  // past the end unless found below
         vp_audio_chunk_pos = 0;
+        uint64_t start;
 
         if (vp_audio_format == VP_AUDIO_FMT_MP3) {
-            int samples_per_mp3_frame = (effective_rate >= 32000) ? 1152 : 576;
-            vp_audio_chunk_idx = time_samples / samples_per_mp3_frame;
-            if (vp_audio_chunk_idx >= vp_total_audio_chunks) {
-                vp_audio_chunk_idx = vp_total_audio_chunks - 1;
+            if (vp_audio_sample_size != 0 && vp_audio_avg_bytes > 0) {
+                // CBR: the byte position is the clock; restart at the start of its chunk
+                uint64_t target_bytes = time_samples * vp_audio_avg_bytes / effective_rate;
+                int chunk = avi_index_find_byte(&vp_audio_index, target_bytes, &start);
+                if (chunk >= 0) {
+                    vp_audio_chunk_idx = chunk;
+                    time_samples = start * effective_rate / vp_audio_avg_bytes;
+                }
+            } else if (vp_total_audio_chunks > 0) {
+                // VBR: every chunk is one AVI sample (an MP3 frame) of scale/rate seconds
+                uint64_t num = vp_audio_rate, den = (uint64_t)vp_audio_scale * effective_rate;
+                if (num == 0 || den == 0) {
+                    num = 1;
+                    den = (effective_rate >= 32000) ? 1152 : 576;
+                }
+                uint64_t chunk = time_samples * num / den;
+                if (chunk >= (uint64_t)vp_total_audio_chunks) chunk = vp_total_audio_chunks - 1;
+                vp_audio_chunk_idx = (int)chunk;
+                time_samples = chunk * den / num;
             }
-            vp_audio_chunk_pos = 0;
-            time_samples = (uint64_t)vp_audio_chunk_idx * samples_per_mp3_frame;
         } else if (vp_audio_format == VP_AUDIO_FMT_ADPCM && vp_adpcm_samples_per_block > 0 && vp_adpcm_block_align > 0) {
             uint64_t target_blocks = time_samples / vp_adpcm_samples_per_block;
             uint64_t target_bytes = target_blocks * vp_adpcm_block_align;
-            uint64_t bytes_so_far = 0;
-
-            while (vp_audio_chunk_idx < vp_total_audio_chunks) {
-                if (bytes_so_far + vp_audio_sizes[vp_audio_chunk_idx] > target_bytes) {
-                    uint32_t pos_in_chunk = target_bytes - bytes_so_far;
-                    pos_in_chunk = (pos_in_chunk / vp_adpcm_block_align) * vp_adpcm_block_align;
-                    vp_audio_chunk_pos = pos_in_chunk;
-                    break;
-                }
-                bytes_so_far += vp_audio_sizes[vp_audio_chunk_idx];
-                vp_audio_chunk_idx++;
+            int chunk = avi_index_find_byte(&vp_audio_index, target_bytes, &start);
+            if (chunk >= 0) {
+                uint32_t pos_in_chunk = target_bytes - start;
+                pos_in_chunk = (pos_in_chunk / vp_adpcm_block_align) * vp_adpcm_block_align;
+                vp_audio_chunk_idx = chunk;
+                vp_audio_chunk_pos = pos_in_chunk;
             }
         } else {
             uint64_t target_bytes = time_samples * vp_audio_bytes_per_sample;
-            uint64_t bytes_so_far = 0;
-
-            while (vp_audio_chunk_idx < vp_total_audio_chunks) {
-                if (bytes_so_far + vp_audio_sizes[vp_audio_chunk_idx] > target_bytes) {
-                    vp_audio_chunk_pos = target_bytes - bytes_so_far;
-                    break;
-                }
-                bytes_so_far += vp_audio_sizes[vp_audio_chunk_idx];
-                vp_audio_chunk_idx++;
+            int chunk = avi_index_find_byte(&vp_audio_index, target_bytes, &start);
+            if (chunk >= 0) {
+                vp_audio_chunk_idx = chunk;
+                vp_audio_chunk_pos = target_bytes - start;
             }
         }
 
-        vp_audio_samples_sent = time_samples;
-        vp_aring_read = 0;
-        vp_aring_write = 0;
-        vp_aring_count = 0;
+        vp_audio_samples_sent = effective_rate > 0 ? time_samples * VP_OUTPUT_RATE / effective_rate : 0;
+        audio_ring_reset(&vp_ring);
+        audio_resample_reset(&vp_resampler);
 
         // v60: Mute first samples after seek to avoid audio crackle
         vp_audio_mute_samples = VP_AUDIO_MUTE_AFTER_SEEK;
@@ -2018,7 +2446,11 @@ static void vp_seek_to_frame(int target_frame) {
         }
     }
 
-    vp_decode_frame(target_frame);
+    // Decode forward without output; only the target picture is kept for display
+    vp_xvid_discontinuity = 1;
+    for (int i = key_frame; i <= target_frame; i++) {
+        vp_decode_frame(i, NULL);
+    }
 }
 
 // ============== SETTINGS SAVE/LOAD ==============
@@ -2337,40 +2769,12 @@ int vp_open(const char *path) {
         return 0;
     }
 
-    // Allocate frame index arrays
-    vp_frame_offsets = (uint32_t *)malloc(VP_MAX_FRAMES * sizeof(uint32_t));
-    vp_frame_sizes = (uint32_t *)malloc(VP_MAX_FRAMES * sizeof(uint32_t));
-    if (!vp_frame_offsets || !vp_frame_sizes) {
-        if (vp_frame_offsets) { free(vp_frame_offsets); vp_frame_offsets = NULL; }
-        if (vp_frame_sizes) { free(vp_frame_sizes); vp_frame_sizes = NULL; }
-        free(vp_frame_buffer);
-        vp_frame_buffer = NULL;
-        fclose(vp_file);
-        vp_file = NULL;
-        return 0;
-    }
+    // Chunk indexes and keyframe bitmap grow while parsing (vp_free_index)
 
-    // Allocate audio chunk arrays
-    vp_audio_offsets = (uint32_t *)malloc(VP_MAX_AUDIO_CHUNKS * sizeof(uint32_t));
-    vp_audio_sizes = (uint32_t *)malloc(VP_MAX_AUDIO_CHUNKS * sizeof(uint32_t));
-    if (!vp_audio_offsets || !vp_audio_sizes) {
-        if (vp_audio_offsets) { free(vp_audio_offsets); vp_audio_offsets = NULL; }
-        if (vp_audio_sizes) { free(vp_audio_sizes); vp_audio_sizes = NULL; }
-        free(vp_frame_offsets); vp_frame_offsets = NULL;
-        free(vp_frame_sizes); vp_frame_sizes = NULL;
-        free(vp_frame_buffer); vp_frame_buffer = NULL;
-        fclose(vp_file);
-        vp_file = NULL;
-        return 0;
-    }
-
-    // Allocate audio ring buffer
-    vp_audio_ring = (uint8_t *)malloc(VP_AUDIO_RING_SIZE);
-    if (!vp_audio_ring) {
-        free(vp_audio_offsets); vp_audio_offsets = NULL;
-        free(vp_audio_sizes); vp_audio_sizes = NULL;
-        free(vp_frame_offsets); vp_frame_offsets = NULL;
-        free(vp_frame_sizes); vp_frame_sizes = NULL;
+    // Allocate audio ring buffer and read-ahead windows
+    if (!audio_ring_init(&vp_ring, VP_AUDIO_RING_FRAMES) || !vp_stream_open()) {
+        audio_ring_free(&vp_ring);
+        vp_stream_close();
         free(vp_frame_buffer); vp_frame_buffer = NULL;
         fclose(vp_file);
         vp_file = NULL;
@@ -2379,11 +2783,9 @@ int vp_open(const char *path) {
 
     // Parse AVI structure
     if (!vp_parse_avi()) {
-        free(vp_audio_ring); vp_audio_ring = NULL;
-        free(vp_audio_offsets); vp_audio_offsets = NULL;
-        free(vp_audio_sizes); vp_audio_sizes = NULL;
-        free(vp_frame_offsets); vp_frame_offsets = NULL;
-        free(vp_frame_sizes); vp_frame_sizes = NULL;
+        vp_stream_close();
+        audio_ring_free(&vp_ring);
+        vp_free_index();
         free(vp_frame_buffer); vp_frame_buffer = NULL;
         fclose(vp_file);
         vp_file = NULL;
@@ -2393,6 +2795,12 @@ int vp_open(const char *path) {
     // Reset state
     vp_current_frame = 0;
     vp_repeat_counter = 0;
+    vp_sched_reset();
+    vp_sched_decode_cost = 0;
+    vp_sched_frame_cost = 0;
+    vp_stat_dropped = 0;
+    vp_stat_late = 0;
+    vp_stat_skipped = 0;
     vp_paused = 0;
     vp_active = 1;
     vp_menu_active = 0;
@@ -2403,11 +2811,12 @@ int vp_open(const char *path) {
     vp_audio_chunk_idx = 0;
     vp_audio_chunk_pos = 0;
     vp_audio_samples_sent = 0;
-    vp_aring_read = 0;
-    vp_aring_write = 0;
-    vp_aring_count = 0;
+    audio_ring_reset(&vp_ring);
     vp_mp3_detected_samplerate = 0;
     vp_mp3_detected_channels = 0;
+    vp_mp3_half_rate = (vp_audio_format == VP_AUDIO_FMT_MP3 &&
+                        vp_audio_sample_rate >= 2 * VP_OUTPUT_RATE);
+    audio_resample_init(&vp_resampler, vp_audio_ring_rate(), VP_OUTPUT_RATE, AUDIO_RESAMPLE_LINEAR);
     vp_mp3_input_len = 0;
     vp_mp3_input_remaining = 0;
 
@@ -2415,7 +2824,7 @@ int vp_open(const char *path) {
     vp_refill_audio_ring();
 
     // Decode first frame
-    vp_decode_frame(0);
+    vp_decode_frame(0, NULL);
 
     // v61: Resume playback if same file was played before
     if (vp_resume_path[0] != '\0' && strcmp(path, vp_resume_path) == 0) {
@@ -2443,35 +2852,16 @@ void vp_close(void) {
         vp_mp3_initialized = 0;
     }
 
-    if (vp_audio_ring) {
-        free(vp_audio_ring);
-        vp_audio_ring = NULL;
-    }
+    audio_ring_free(&vp_ring);
+
+    vp_stream_close();
 
     if (vp_frame_buffer) {
         free(vp_frame_buffer);
         vp_frame_buffer = NULL;
     }
 
-    if (vp_frame_offsets) {
-        free(vp_frame_offsets);
-        vp_frame_offsets = NULL;
-    }
-
-    if (vp_frame_sizes) {
-        free(vp_frame_sizes);
-        vp_frame_sizes = NULL;
-    }
-
-    if (vp_audio_offsets) {
-        free(vp_audio_offsets);
-        vp_audio_offsets = NULL;
-    }
-
-    if (vp_audio_sizes) {
-        free(vp_audio_sizes);
-        vp_audio_sizes = NULL;
-    }
+    vp_free_index();
 
     if (vp_file) {
         fclose(vp_file);
@@ -2720,12 +3110,14 @@ void vp_render(uint16_t *framebuffer) {
 
     vp_fb = framebuffer;  // Cache for drawing functions
 
-    // Frame timing - EXACT copy from pmp123
+    int drawn = 0;  // set when xvid converted a new picture straight into framebuffer
+
+    // Frame timing - repeat cadence from pmp123, scheduler catches up when decoding is slow
     if (!vp_paused && !vp_menu_active) {
         // Decode new frame only when repeat_counter == 0
         if (vp_repeat_counter == 0) {
             if (vp_current_frame < vp_total_frames) {
-                vp_decode_frame(vp_current_frame);
+                drawn = vp_sched_decode(framebuffer);
             }
         }
         // else: same frame displayed again, framebuffer already has it
@@ -2747,14 +3139,14 @@ void vp_render(uint16_t *framebuffer) {
                 vp_audio_chunk_idx = 0;
                 vp_audio_chunk_pos = 0;
                 vp_audio_samples_sent = 0;
-                vp_aring_read = 0;
-                vp_aring_write = 0;
-                vp_aring_count = 0;
+                audio_ring_reset(&vp_ring);
+                audio_resample_reset(&vp_resampler);
                 if (vp_audio_format == VP_AUDIO_FMT_MP3) {
                     vp_mp3_reset();
                 }
                 vp_mpeg4_extradata_sent = 0;
                 vp_repeat_counter = 0;
+                vp_sched_reset();
                 vp_refill_audio_ring();
             } else if (vp_play_mode == VP_PLAY_MODE_ONCE) {
                 // Stop at end - pause
@@ -2762,7 +3154,8 @@ void vp_render(uint16_t *framebuffer) {
                 vp_current_frame = vp_total_frames - 1;
             } else if (vp_play_mode == VP_PLAY_MODE_AZ) {
                 // Load next video alphabetically
-                if (vp_playlist_count <= 0) vp_scan_playlist();
+                drawn = 0;
+                if (playlist_count(&vp_playlist) <= 0) vp_scan_playlist();
                 if (!vp_load_next_az()) {
                     // Failed to load next - pause at end
                     vp_paused = 1;
@@ -2770,7 +3163,8 @@ void vp_render(uint16_t *framebuffer) {
                 }
             } else if (vp_play_mode == VP_PLAY_MODE_SHUFFLE) {
                 // Load random video
-                if (vp_playlist_count <= 0) vp_scan_playlist();
+                drawn = 0;
+                if (playlist_count(&vp_playlist) <= 0) vp_scan_playlist();
                 if (!vp_load_shuffle()) {
                     // Failed to load random - pause at end
                     vp_paused = 1;
@@ -2778,10 +3172,15 @@ void vp_render(uint16_t *framebuffer) {
                 }
             }
         }
+    } else {
+        // Clock keeps running while paused - start over when playback resumes
+        vp_sched_reset();
     }
 
-    // Convert YUV to RGB565 and write to framebuffer
-    vp_yuv_to_rgb565(framebuffer);
+    // Redraw picture under the overlays unless the decoder just wrote it
+    if (!drawn) {
+        vp_yuv_to_rgb565(framebuffer);
+    }
 
     // Draw time display (top left)
     int total_secs = (vp_clip_fps > 0) ? (vp_current_frame / vp_clip_fps) : 0;
@@ -2805,6 +3204,10 @@ void vp_render(uint16_t *framebuffer) {
     if (dur_sec < 10) { vp_draw_str(tx, 2, "0", 0x7BEF); tx += 6; }
     vp_draw_num(tx, 2, dur_sec, 0x7BEF);
 
+    if (vp_show_debug) {
+        vp_draw_debug();
+    }
+
     // Draw pause indicator
     if (vp_paused && !vp_menu_active) {
         vp_draw_str(140, 2, "PAUSED", 0xF800);
@@ -35,6 +35,7 @@
 #include "../utils/mem_align.h"
 #include "../motion/sad.h"
 #include "../utils/emms.h"
+#include "../../yuv2rgb.h"		/* XVID_CSP_FROGUI */
 
 #include "font.h"		/* XXX: remove later */
 
@@ -746,6 +747,12 @@ image_output(IMAGE * image,
 			width, height, (csp & XVID_CSP_VFLIP));
 		return 0;
 
+	case XVID_CSP_FROGUI :	/* converts from the edged reference image, no planar copy */
+		yuv2rgb_output((yuv2rgb_t *)dst[1], (uint16_t *)dst[0],
+			image->y, image->u, image->v, edged_width, edged_width2,
+			width, height);
+		return 0;
+
 	case XVID_CSP_INTERNAL :
 		dst[0] = image->y;
 		dst[1] = image->u;
@@ -124,6 +124,8 @@ extern "C" {
 #define XVID_CSP_SLICE    (1<<12) /* decoder only: 4:2:0 planar, per slice rendering */
 #define XVID_CSP_INTERNAL (1<<13) /* decoder only: 4:2:0 planar, returns ptrs to internal buffers */
 #define XVID_CSP_NULL     (1<<14) /* decoder only: dont output anything */
+#define XVID_CSP_FROGUI   (1<<17) /* decoder only: FrogUI 320x240 rgb565 through yuv2rgb tables;
+                                     plane[0]=framebuffer (NULL: only remember picture), plane[1]=yuv2rgb_t */
 #define XVID_CSP_VFLIP    (1<<31) /* vertical flip mask */
 
 /* xvid_image_t
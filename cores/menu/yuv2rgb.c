@@ -0,0 +1,269 @@
+/*
+ * yuv2rgb.c - YUV420 to RGB565 converter engine for FrogUI
+ *
+ * Same BT.601 math as the per-pixel pmp123 converter, restructured:
+ * - one chroma fetch per 2x2 luma quad
+ * - chroma terms folded into the base pointer of each clamp table
+ * - gamma/lift of the color mode folded into the clamp tables
+ * - dither and TV range as compile-time constants of the inner loop
+ */
+
+#include "yuv2rgb.h"
+#include <string.h>
+
+/* 4x4 Bayer dithering matrix - same as pmp123 */
+static const int8_t yuv2rgb_bayer4x4[4][4] = {
+    { -8,  0, -6,  2 },
+    {  4, -4,  6, -2 },
+    { -5,  3, -7,  1 },
+    {  7, -1,  5, -3 }
+};
+
+/* U/V contributions - BT.601 coefficients (x1024) */
+static int16_t yuv2rgb_rv[256];
+static int16_t yuv2rgb_gu[256];
+static int16_t yuv2rgb_gv[256];
+static int16_t yuv2rgb_bu[256];
+static int yuv2rgb_chroma_ready = 0;
+
+static void yuv2rgb_init_chroma(void) {
+    if (yuv2rgb_chroma_ready) return;
+
+    for (int i = 0; i < 256; i++) {
+        int uv = i - 128;
+        yuv2rgb_rv[i] = (1436 * uv) >> 10;   /* 1.402 */
+        yuv2rgb_gu[i] = (-352 * uv) >> 10;   /* -0.344 */
+        yuv2rgb_gv[i] = (-731 * uv) >> 10;   /* -0.714 */
+        yuv2rgb_bu[i] = (1815 * uv) >> 10;   /* 1.772 */
+    }
+    yuv2rgb_chroma_ready = 1;
+}
+
+void yuv2rgb_setup(yuv2rgb_t *ctx, const uint8_t *gamma_r5, const uint8_t *gamma_g6,
+                   const uint8_t *gamma_b5, int dither, int range) {
+    yuv2rgb_init_chroma();
+
+    for (int i = 0; i < YUV2RGB_LUT_SIZE; i++) {
+        int c = i - YUV2RGB_LUT_BIAS;
+        if (c < 0) c = 0; else if (c > 255) c = 255;
+
+        int r5 = c >> 3;
+        int g6 = c >> 2;
+        int b5 = c >> 3;
+        if (gamma_r5) r5 = gamma_r5[r5];
+        if (gamma_g6) g6 = gamma_g6[g6];
+        if (gamma_b5) b5 = gamma_b5[b5];
+
+        ctx->lut_r[i] = (uint16_t)(r5 << 11);
+        ctx->lut_g[i] = (uint16_t)(g6 << 5);
+        ctx->lut_b[i] = (uint16_t)b5;
+    }
+
+    for (int i = 0; i < 256; i++) {
+        /* TV/Limited range (16-235 -> 0-255) */
+        int y = ((i - 16) * 298) >> 8;
+        if (y < 0) y = 0;
+        if (y > 255) y = 255;
+        ctx->lut_y[i] = (uint8_t)y;
+    }
+
+    ctx->dither = dither ? 1 : 0;
+    ctx->range = (range == YUV2RGB_RANGE_PC) ? YUV2RGB_RANGE_PC : YUV2RGB_RANGE_TV;
+    ctx->ready = 1;
+}
+
+/* Convert one 2-row band (or a single row when pair == 0).
+ * pair/dither/tv are constants at every call site, so each instantiation
+ * compiles to its own branch-free loop. */
+static inline __attribute__((always_inline))
+void yuv2rgb_band(const yuv2rgb_t *ctx, uint16_t *o0, uint16_t *o1,
+                  const uint8_t *y0, const uint8_t *y1,
+                  const uint8_t *us, const uint8_t *vs,
+                  int w, int row, const int pair, const int dither, const int tv) {
+    const uint16_t *lr = ctx->lut_r + YUV2RGB_LUT_BIAS;
+    const uint16_t *lg = ctx->lut_g + YUV2RGB_LUT_BIAS;
+    const uint16_t *lb = ctx->lut_b + YUV2RGB_LUT_BIAS;
+    const uint8_t *ly = ctx->lut_y;
+    const int8_t *d0 = yuv2rgb_bayer4x4[row & 3];
+    const int8_t *d1 = yuv2rgb_bayer4x4[(row + 1) & 3];
+    int w2 = w & ~1;
+    int i;
+
+    for (i = 0; i < w2; i += 2) {
+        int u = us[i >> 1];
+        int v = vs[i >> 1];
+        const uint16_t *rp = lr + yuv2rgb_rv[v];
+        const uint16_t *gp = lg + yuv2rgb_gu[u] + yuv2rgb_gv[v];
+        const uint16_t *bp = lb + yuv2rgb_bu[u];
+
+        int a = y0[i];
+        int b = y0[i + 1];
+        if (tv) { a = ly[a]; b = ly[b]; }
+        if (dither) { a += d0[i & 3]; b += d0[(i & 3) + 1]; }
+        o0[i]     = rp[a] | gp[a] | bp[a];
+        o0[i + 1] = rp[b] | gp[b] | bp[b];
+
+        if (pair) {
+            int c = y1[i];
+            int d = y1[i + 1];
+            if (tv) { c = ly[c]; d = ly[d]; }
+            if (dither) { c += d1[i & 3]; d += d1[(i & 3) + 1]; }
+            o1[i]     = rp[c] | gp[c] | bp[c];
+            o1[i + 1] = rp[d] | gp[d] | bp[d];
+        }
+    }
+
+    /* Odd width: last column shares the next chroma sample */
+    if (i < w) {
+        int u = us[i >> 1];
+        int v = vs[i >> 1];
+        const uint16_t *rp = lr + yuv2rgb_rv[v];
+        const uint16_t *gp = lg + yuv2rgb_gu[u] + yuv2rgb_gv[v];
+        const uint16_t *bp = lb + yuv2rgb_bu[u];
+
+        int a = y0[i];
+        if (tv) a = ly[a];
+        if (dither) a += d0[i & 3];
+        o0[i] = rp[a] | gp[a] | bp[a];
+
+        if (pair) {
+            int c = y1[i];
+            if (tv) c = ly[c];
+            if (dither) c += d1[i & 3];
+            o1[i] = rp[c] | gp[c] | bp[c];
+        }
+    }
+}
+
+static inline __attribute__((always_inline))
+void yuv2rgb_picture(const yuv2rgb_t *ctx, uint16_t *dst,
+                     const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                     int y_stride, int uv_stride, int w, int h,
+                     const int dither, const int tv) {
+    int j;
+
+    for (j = 0; j + 1 < h; j += 2) {
+        const uint8_t *y0 = y + j * y_stride;
+        uint16_t *o0 = dst + j * YUV2RGB_SCREEN_WIDTH;
+        yuv2rgb_band(ctx, o0, o0 + YUV2RGB_SCREEN_WIDTH, y0, y0 + y_stride,
+                     u + (j >> 1) * uv_stride, v + (j >> 1) * uv_stride,
+                     w, j, 1, dither, tv);
+    }
+    /* Odd height: last row alone */
+    if (j < h) {
+        yuv2rgb_band(ctx, dst + j * YUV2RGB_SCREEN_WIDTH, NULL, y + j * y_stride, NULL,
+                     u + (j >> 1) * uv_stride, v + (j >> 1) * uv_stride,
+                     w, j, 0, dither, tv);
+    }
+}
+
+typedef void (*yuv2rgb_kernel_t)(const yuv2rgb_t *ctx, uint16_t *dst,
+                                 const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                 int y_stride, int uv_stride, int w, int h);
+
+static void yuv2rgb_kernel_tv(const yuv2rgb_t *ctx, uint16_t *dst,
+                              const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                              int y_stride, int uv_stride, int w, int h) {
+    yuv2rgb_picture(ctx, dst, y, u, v, y_stride, uv_stride, w, h, 0, 1);
+}
+
+static void yuv2rgb_kernel_pc(const yuv2rgb_t *ctx, uint16_t *dst,
+                              const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                              int y_stride, int uv_stride, int w, int h) {
+    yuv2rgb_picture(ctx, dst, y, u, v, y_stride, uv_stride, w, h, 0, 0);
+}
+
+static void yuv2rgb_kernel_tv_dither(const yuv2rgb_t *ctx, uint16_t *dst,
+                                     const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                     int y_stride, int uv_stride, int w, int h) {
+    yuv2rgb_picture(ctx, dst, y, u, v, y_stride, uv_stride, w, h, 1, 1);
+}
+
+static void yuv2rgb_kernel_pc_dither(const yuv2rgb_t *ctx, uint16_t *dst,
+                                     const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                     int y_stride, int uv_stride, int w, int h) {
+    yuv2rgb_picture(ctx, dst, y, u, v, y_stride, uv_stride, w, h, 1, 0);
+}
+
+/* [dither][range] */
+static const yuv2rgb_kernel_t yuv2rgb_kernels[2][2] = {
+    { yuv2rgb_kernel_tv,        yuv2rgb_kernel_pc        },
+    { yuv2rgb_kernel_tv_dither, yuv2rgb_kernel_pc_dither }
+};
+
+/* Clear everything outside the picture rectangle */
+static void yuv2rgb_clear_bars(uint16_t *fb, int x, int y, int w, int h) {
+    if (y > 0) {
+        memset(fb, 0, y * YUV2RGB_SCREEN_WIDTH * sizeof(uint16_t));
+    }
+    if (y + h < YUV2RGB_SCREEN_HEIGHT) {
+        memset(fb + (y + h) * YUV2RGB_SCREEN_WIDTH, 0,
+               (YUV2RGB_SCREEN_HEIGHT - y - h) * YUV2RGB_SCREEN_WIDTH * sizeof(uint16_t));
+    }
+    if (w < YUV2RGB_SCREEN_WIDTH) {
+        int right = YUV2RGB_SCREEN_WIDTH - x - w;
+        for (int j = y; j < y + h; j++) {
+            uint16_t *row = fb + j * YUV2RGB_SCREEN_WIDTH;
+            if (x > 0) memset(row, 0, x * sizeof(uint16_t));
+            if (right > 0) memset(row + x + w, 0, right * sizeof(uint16_t));
+        }
+    }
+}
+
+void yuv2rgb_blit(const yuv2rgb_t *ctx, uint16_t *fb,
+                  const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                  int y_stride, int uv_stride, int width, int height) {
+    if (!ctx || !ctx->ready || !fb || !y || !u || !v) return;
+    if (width <= 0 || height <= 0) return;
+
+    /* Center video on screen, clip if larger */
+    int off_x = (YUV2RGB_SCREEN_WIDTH - width) / 2;
+    int off_y = (YUV2RGB_SCREEN_HEIGHT - height) / 2;
+    if (off_x < 0) off_x = 0;
+    if (off_y < 0) off_y = 0;
+    int w = width;
+    int h = height;
+    if (w > YUV2RGB_SCREEN_WIDTH - off_x) w = YUV2RGB_SCREEN_WIDTH - off_x;
+    if (h > YUV2RGB_SCREEN_HEIGHT - off_y) h = YUV2RGB_SCREEN_HEIGHT - off_y;
+
+    yuv2rgb_clear_bars(fb, off_x, off_y, w, h);
+
+    yuv2rgb_kernels[ctx->dither][ctx->range](ctx, fb + off_y * YUV2RGB_SCREEN_WIDTH + off_x,
+                                             y, u, v, y_stride, uv_stride, w, h);
+}
+
+void yuv2rgb_output(yuv2rgb_t *ctx, uint16_t *fb,
+                    const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                    int y_stride, int uv_stride, int width, int height) {
+    if (!ctx) return;
+
+    ctx->src_y = y;
+    ctx->src_u = u;
+    ctx->src_v = v;
+    ctx->src_y_stride = y_stride;
+    ctx->src_uv_stride = uv_stride;
+    ctx->src_width = width;
+    ctx->src_height = height;
+
+    if (fb) {
+        yuv2rgb_blit(ctx, fb, y, u, v, y_stride, uv_stride, width, height);
+    }
+}
+
+int yuv2rgb_redraw(const yuv2rgb_t *ctx, uint16_t *fb) {
+    if (!fb) return 0;
+    if (!ctx || !ctx->ready || !ctx->src_y) {
+        memset(fb, 0, YUV2RGB_SCREEN_WIDTH * YUV2RGB_SCREEN_HEIGHT * sizeof(uint16_t));
+        return 0;
+    }
+    yuv2rgb_blit(ctx, fb, ctx->src_y, ctx->src_u, ctx->src_v,
+                 ctx->src_y_stride, ctx->src_uv_stride, ctx->src_width, ctx->src_height);
+    return 1;
+}
+
+void yuv2rgb_forget(yuv2rgb_t *ctx) {
+    if (!ctx) return;
+    ctx->src_y = NULL;
+    ctx->src_u = NULL;
+    ctx->src_v = NULL;
+}
@@ -0,0 +1,80 @@
+/*
+ * yuv2rgb.h - YUV420 to RGB565 converter engine for FrogUI
+ *
+ * Converts 2x2 luma quads that share one chroma pair, so U/V are read and
+ * the chroma terms computed once per four pixels. Color mode gamma/lift and
+ * the final 0-255 clamp are folded into one lookup table per channel that
+ * already holds the shifted RGB565 component, so a pixel costs three table
+ * loads and two ORs.
+ *
+ * Inner loops are specialized at compile time for every dither/black-level
+ * combination; everything else that differs between color modes is table data.
+ */
+
+#ifndef YUV2RGB_H
+#define YUV2RGB_H
+
+#include <stdint.h>
+
+/* Target screen */
+#define YUV2RGB_SCREEN_WIDTH  320
+#define YUV2RGB_SCREEN_HEIGHT 240
+
+/* Clamp table covers Y (0-255) + chroma (-227..+225) + dither (-8..+7) */
+#define YUV2RGB_LUT_BIAS 256
+#define YUV2RGB_LUT_SIZE 768
+
+/* Black level of the decoded picture */
+#define YUV2RGB_RANGE_TV 0   /* expand 16-235 to 0-255 */
+#define YUV2RGB_RANGE_PC 1   /* use 0-255 as-is */
+
+typedef struct {
+    /* Clamp + gamma tables, already shifted into RGB565 position */
+    uint16_t lut_r[YUV2RGB_LUT_SIZE];
+    uint16_t lut_g[YUV2RGB_LUT_SIZE];
+    uint16_t lut_b[YUV2RGB_LUT_SIZE];
+    /* Luma range expansion (TV range only) */
+    uint8_t lut_y[256];
+    int dither;
+    int range;
+    int ready;
+    /* Last picture passed to yuv2rgb_output(), kept for redraws.
+     * Points into the decoder's reference image - valid until the next decode. */
+    const uint8_t *src_y;
+    const uint8_t *src_u;
+    const uint8_t *src_v;
+    int src_y_stride;
+    int src_uv_stride;
+    int src_width;
+    int src_height;
+} yuv2rgb_t;
+
+/* Build the tables for one color mode.
+ * gamma_r5/gamma_b5 have 32 entries, gamma_g6 has 64; pass NULL for identity.
+ * dither: apply 4x4 Bayer dithering before quantizing to RGB565
+ * range: YUV2RGB_RANGE_TV or YUV2RGB_RANGE_PC */
+void yuv2rgb_setup(yuv2rgb_t *ctx, const uint8_t *gamma_r5, const uint8_t *gamma_g6,
+                   const uint8_t *gamma_b5, int dither, int range);
+
+/* Convert a YUV420 picture into a 320x240 RGB565 framebuffer.
+ * The picture is centered (and clipped if larger than the screen);
+ * only the letterbox/pillarbox bars around it are cleared. */
+void yuv2rgb_blit(const yuv2rgb_t *ctx, uint16_t *fb,
+                  const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                  int y_stride, int uv_stride, int width, int height);
+
+/* Decoder output stage (XVID_CSP_FROGUI): remember the picture and,
+ * if fb is not NULL, convert it straight into fb */
+void yuv2rgb_output(yuv2rgb_t *ctx, uint16_t *fb,
+                    const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                    int y_stride, int uv_stride, int width, int height);
+
+/* Convert the last remembered picture again (e.g. with new tables or to
+ * redraw under an overlay). Clears fb to black if there is no picture.
+ * Returns 1 if a picture was drawn. */
+int yuv2rgb_redraw(const yuv2rgb_t *ctx, uint16_t *fb);
+
+/* Drop the remembered picture (call when the decoder is destroyed) */
+void yuv2rgb_forget(yuv2rgb_t *ctx);
+
+#endif /* YUV2RGB_H */